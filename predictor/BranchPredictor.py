@@ -89,8 +89,70 @@ class NeuroBP(BranchPredictor):
     cxx_class = 'NeuroBP'
     cxx_header = "cpu/pred/neurobranch.hh"
 
-    globalPredictorSize = Param.Unsigned(8192, "Size of global predictor")
+    historyLength = Param.Unsigned(64,
+        "Global history bits (and weights) per perceptron, at most 1024")
+    numPerceptrons = Param.Unsigned(20, "Number of perceptrons")
     globalCtrBits = Param.Unsigned(2, "Bits per counter")    
+    weightBits = Param.Unsigned(8,
+        "Bits per perceptron weight (stored as int8 up to 8, int16 above)")
+    # 192 is the numROBEntries default of O3CPU; it is not a proxy of
+    # the CPU param as the simple CPUs predict.py runs have no ROB, so
+    # set it to the ROB depth of other configurations (the
+    # historyRecords stat gives the most records ever needed)
+    historyPoolSize = Param.Unsigned(192,
+        "History records preallocated per thread, at least the branches "
+        "in flight (ROB/fetch queue depth, 192 as O3CPU's default "
+        "numROBEntries); the pool grows if exceeded")
+    detailedStats = Param.Bool(False,
+        "Also collect host ns per lookup/update/squash and the weight "
+        "saturation rate, at the cost of clock reads on every call")
+    weightsFile = Param.String("",
+        "Weight dump (e.g. the .weights file of a checkpoint) to start "
+        "from instead of zeroed weights")
+    sharedWeights = Param.Bool(True,
+        "Train one weight table shared by every SMT thread rather than "
+        "a private table per thread")
+    specializedKernels = Param.Bool(True,
+        "Use the kernels compiled for a fixed history length when "
+        "historyLength is 32, 64, 128 or 256, the generic ones otherwise")
+    earlyExit = Param.Bool(False,
+        "Sum the perceptron 64 weights at a time and stop once the weights "
+        "left cannot flip the prediction nor bring abs(y_out) within theta "
+        "(NeuroBP only, HashedNeuroBP outputs are not rows)")
+    updateDelay = Param.Unsigned(0,
+        "Commits the training is held back for in a buffer of row deltas "
+        "before the weights are written, 0 to train straight away "
+        "(NeuroBP only, HashedNeuroBP trains straight away)")
+    updateBufferRows = Param.Unsigned(16,
+        "Rows the deferred training buffer holds; a training of another "
+        "row writes the oldest buffered row back early")
+    associativity = Param.Unsigned(0,
+        "Perceptron rows per set, each tagged for the branch owning it, "
+        "branches missing their set sharing one fallback row; 0 to pick "
+        "rows by PC modulo numPerceptrons (NeuroBP only, no updateDelay)")
+    tagBits = Param.Unsigned(8,
+        "Bits of the partial PC tags of the perceptron rows (1 to 16)")
+    replacement = Param.String("lru",
+        "Row a mispredicted branch missing its set takes over: lru, or "
+        "useful for a row whose last prediction was wrong")
+    profileSize = Param.Unsigned(0,
+        "Slots of the per-PC branch profile (a power of 2, 3/4 of them "
+        "used), 0 for no profile")
+    profileFile = Param.String("",
+        "File of the output directory the branch profile is written to "
+        "at exit, as JSON if it ends in .json (default <name>.profile.csv)")
+
+
+class HashedNeuroBP(NeuroBP):
+    type = 'HashedNeuroBP'
+    cxx_class = 'HashedNeuroBP'
+    cxx_header = "cpu/pred/hashed_neurobranch.hh"
+
+    numTables = Param.Unsigned(8,
+        "Weight tables: a PC-indexed bias table plus one per equal segment "
+        "of the historyLength global history bits, which has to be at "
+        "least numTables - 1")
+    logTableSize = Param.Unsigned(10, "Log2 of the weights per table")
 
     
 class NeuroPathBP(BranchPredictor):
@@ -98,5 +160,79 @@ class NeuroPathBP(BranchPredictor):
     cxx_class = 'NeuroPathBP'
     cxx_header = "cpu/pred/neuropath.hh"
 
-    globalPredictorSize = Param.Unsigned(8192, "Size of global predictor")
+    historyLength = Param.Unsigned(64,
+        "Previous path branches (and weights) per perceptron, at most 1023")
+    numPerceptrons = Param.Unsigned(10, "Number of perceptrons")
     globalCtrBits = Param.Unsigned(2, "Bits per counter")    
+    weightBits = Param.Unsigned(8,
+        "Bits per perceptron weight (stored as int8 up to 8, int16 above)")
+    # 192 is the numROBEntries default of O3CPU; it is not a proxy of
+    # the CPU param as the simple CPUs predict.py runs have no ROB, so
+    # set it to the ROB depth of other configurations (the
+    # historyRecords stat gives the most records ever needed)
+    historyPoolSize = Param.Unsigned(192,
+        "History records preallocated per thread, at least the branches "
+        "in flight (ROB/fetch queue depth, 192 as O3CPU's default "
+        "numROBEntries); the pool grows if exceeded")
+    detailedStats = Param.Bool(False,
+        "Also collect host ns per lookup/update/squash and the weight "
+        "saturation rate, at the cost of clock reads on every call")
+    weightsFile = Param.String("",
+        "Weight dump (e.g. the .weights file of a checkpoint) to start "
+        "from instead of zeroed weights")
+    sharedWeights = Param.Bool(True,
+        "Train one weight table shared by every SMT thread rather than "
+        "a private table per thread")
+    specializedKernels = Param.Bool(True,
+        "Use the kernels compiled for a fixed history length when "
+        "historyLength is 32, 64, 128 or 256, the generic ones otherwise")
+    updateDelay = Param.Unsigned(0,
+        "Commits the training is held back for in a buffer of row deltas "
+        "before the weights are written, 0 to train straight away")
+    updateBufferRows = Param.Unsigned(16,
+        "Rows the deferred training buffer holds; a training of another "
+        "row writes the oldest buffered row back early")
+    aheadPipelined = Param.Bool(True,
+        "Advance the running sums after the prediction is made, leaving "
+        "only SR[h] + bias on the lookup path")
+    lookupLatency = Param.Unsigned(1,
+        "Cycles to read a perceptron row and add its bias, i.e. the whole "
+        "prediction latency when ahead-pipelined")
+    adderLevelsPerCycle = Param.Unsigned(2,
+        "Adder tree levels summed per cycle when not ahead-pipelined")
+    indirectPathLength = Param.Unsigned(16,
+        "Latest path branches whose perceptron rows are hashed into the "
+        "GHR the indirect predictor is indexed with (set indirectHashGHR), "
+        "0 to give it the global history")
+    profileSize = Param.Unsigned(0,
+        "Slots of the per-PC branch profile (a power of 2, 3/4 of them "
+        "used), 0 for no profile")
+    profileFile = Param.String("",
+        "File of the output directory the branch profile is written to "
+        "at exit, as JSON if it ends in .json (default <name>.profile.csv)")
+
+
+class HybridNeuroBP(BranchPredictor):
+    type = 'HybridNeuroBP'
+    cxx_class = 'HybridNeuroBP'
+    cxx_header = "cpu/pred/hybrid_neurobranch.hh"
+
+    perceptron = Param.BranchPredictor(NeuroBP(),
+        "Neural predictor (NeuroBP, HashedNeuroBP or NeuroPathBP) only "
+        "predicting and training the branches the chooser takes away from "
+        "the bimodal path; every branch goes into its history")
+    bimodalSize = Param.Unsigned(4096,
+        "Bimodal counters of the fast path (a power of 2)")
+    bimodalCtrBits = Param.Unsigned(2, "Bits per bimodal counter")
+    chooserSize = Param.Unsigned(4096,
+        "Per-PC counters choosing between the bimodal counters and the "
+        "perceptron (a power of 2)")
+    chooserCtrBits = Param.Unsigned(2, "Bits per chooser counter")
+    # 192 is the numROBEntries default of O3CPU; it is not a proxy of
+    # the CPU param as the simple CPUs predict.py runs have no ROB, so
+    # set it to the ROB depth of other configurations (the
+    # historyRecords stat gives the most records ever needed)
+    historyPoolSize = Param.Unsigned(192,
+        "History records preallocated per thread, at least the branches "
+        "in flight (ROB/fetch queue depth, 192 as O3CPU's default "
+        "numROBEntries); the pool grows if exceeded")
@@ -8,45 +8,61 @@ highlights the latency/time in prediction
 """
 
 import settings as s
+import results as r
 
+import argparse
+import collections
+import csv
+import multiprocessing
 import os
+import re
+import shlex
+import subprocess
+import sys
+import time
 import numpy as np
 from plotly.graph_objs import Bar, Figure, Layout
 from plotly.offline import plot
 
-def visualize_bps(isa, executable):
+def visualize_bps(store, isa, executable):
     """
-    Given int corresponding to the executable, takes all the outputs saved
-    in the output directory (specified in settings) and plots/saves
-    parallel bar graphs of the outputs
+    Given int corresponding to the executable, takes the latest result of
+    every branch predictor on it from the results store and plots/saves
+    parallel bar graphs of the outputs, the results of sampled simulations
+    as series of their own
+    @param store The results store (results.open_store)
     @param executable The integer corresponding to which executable to run
-    @return void
+    @return path of the figure
     """
-    files = os.listdir("{}/{}".format(s.OUTPUT_DIR, isa))
     exec_name = s.EXEC_NAMES[executable]
-    to_visualize = [f for f in files if exec_name in f]
-    
-    data = []
-    for f in to_visualize:
-        props = open("{}/{}/{}".format(s.OUTPUT_DIR, isa, f), "r").readlines()
-        prop_values = [float(prop.split(":")[1].strip()) for prop in props]
-        prop_labels = ["Conditional", "Indirect", "Latency"]
-        data.append(Bar(x=prop_labels, y=prop_values, name=f.split("_")[0]))
+    prop_labels = ["Conditional", "Indirect", "Latency"]
+    data = [Bar(x=prop_labels, y=[run[value] for value in r.VALUES],
+                name=run["predictor"] + (" (sampled)" if sampled else ""))
+            for sampled in (False, True)
+            for run in r.latest_runs(store, isa, executable=exec_name,
+                                     sampled=sampled)]
         
     layout = Layout(
         barmode='group'
     )
 
+    figure_dir = s.FIGURE_DIR.format(isa)
+    if not os.path.isdir(figure_dir):
+        os.makedirs(figure_dir)
+    path = "{}/{}.html".format(figure_dir, exec_name)
     fig = Figure(data=data, layout=layout)
-    plot(fig, filename="{}/{}.html".format(
-        s.FIGURE_DIR.format(isa), exec_name), auto_open=False)
+    plot(fig, filename=path, auto_open=False)
+    return path
 
-def create_table(isa, pred):
+def create_table(store, isa, pred, sampled=False):
     """
     Given int corresponding to the branch predictor (from settings), creates
-    the HTML formatted code to update the website page
+    the HTML formatted code to update the website page from the latest
+    result of the predictor on every executable
+    @param store The results store (results.open_store)
     @param pred The integer corresponding to which BP to analyze
-    @return void
+    @param sampled Whether the table is of sampled simulations
+    @return the rows of the table
     """
     template = """
                     <tr>
@@ -56,62 +72,352 @@ def create_table(isa, pred):
                       <td>{}</td>
                     </tr>"""
     
-    files   = os.listdir(s.OUTPUT_DIR)
-    bp_name = s.BP_NAMES[pred]
-    to_tabulate = [f for f in files if bp_name in f]
-
     full_table = []
-    for f in to_tabulate:
-        props = open("{}/{}/{}".format(s.OUTPUT_DIR, isa, f), "r").readlines()
-        print(props)
-        full_table.append(template.format(
-            f.split("_")[1],
-            props[0].split(":")[1].strip(),
-            props[1].split(":")[1].strip(),
-            props[2].split(":")[1].strip()))
+    for run in r.latest_runs(store, isa, predictor=s.BP_NAMES[pred],
+                             sampled=sampled):
+        full_table.append(template.format(run["executable"],
+            *[run[value] for value in r.VALUES]))
     return "\n".join(full_table)
+
+def refresh_outputs(store, isa):
+    """
+    Redraws the figure of every executable and the table of every branch
+    predictor of an ISA that runs recorded since they were drawn have
+    changed, leaving the others as they are; sampled results go in tables
+    of their own, name_sampled_table.txt
+    @param store The results store (results.open_store)
+    @return number of outputs redrawn
+    """
+    redrawn = 0
+    for executable, exec_name in enumerate(s.EXEC_NAMES):
+        run = r.last_run(store, isa, executable=exec_name)
+        path = "{}/{}.html".format(s.FIGURE_DIR.format(isa), exec_name)
+        if run and r.is_stale(store, path, run):
+            r.mark_drawn(store, visualize_bps(store, isa, executable), run)
+            redrawn += 1
+
+    table_dir = s.TABLE_DIR.format(isa)
+    for pred, bp_name in enumerate(s.BP_NAMES):
+        for sampled in (False, True):
+            run = r.last_run(store, isa, predictor=bp_name, sampled=sampled)
+            path = "{}/{}{}_table.txt".format(table_dir, bp_name,
+                "_sampled" if sampled else "")
+            if run and r.is_stale(store, path, run):
+                if not os.path.isdir(table_dir):
+                    os.makedirs(table_dir)
+                with open(path, "w") as f:
+                    f.write(create_table(store, isa, pred, sampled))
+                r.mark_drawn(store, path, run)
+                redrawn += 1
+    return redrawn
     
-def analyze_executable(isa, executable):
+ATTRIBUTES = [("conditional" , "condIncorrect"),
+              ("indirect"    , "branchPredindirectMispredicted"),
+              ("latency"     , "host_seconds")]
+
+# sampled jobs run with the settings.SAMPLING sampled simulation
+Job = collections.namedtuple("Job",
+    ["isa", "executable", "predictor", "sampled"])
+
+def job_name(job):
+    """
+    Name of the run directory and outputs of a job, sampled jobs apart
+    from full ones so neither overwrites the stats and profile of the other
+    """
+    return "{}_{}{}".format(s.BP_NAMES[job.predictor],
+        s.EXEC_NAMES[job.executable], "_sampled" if job.sampled else "")
+
+def run_params(job):
+    """
+    Parameters of the simulation of a job besides its ISA, executable and
+    predictor, part of the key of its result in the store, so sampled and
+    full results are kept apart
+    """
+    params = {"profile": s.PROFILE_SIZE}
+    if job.sampled:
+        params["sampling"] = s.SAMPLING
+    return params
+
+def parse_stats(stats_file):
+    """
+    Extracts the values of ATTRIBUTES from a gem5 stats dump
+    @param stats_file The stats.txt written by the run
+    @return list of the values as strings, in the order of ATTRIBUTES
+    """
+    dump = open(stats_file, "r").readlines()
+    return [[l.strip() for l in dump if attribute in l][0].split()[1]
+        for _, attribute in ATTRIBUTES]
+
+def pending_jobs(store, commit, isas, executables, predictors,
+                 sampled=False):
+    """
+    Lists the jobs of the (isa x executable x predictor) matrix that have
+    no result in the store for the commit yet, which is what makes a sweep
+    resumable
+    @param sampled Whether the jobs run sampled simulations
+    """
+    jobs = [Job(isa, executable, predictor, sampled)
+        for isa in isas
+        for executable in executables
+        for predictor in predictors]
+    return [job for job in jobs if not r.has_run(store, job.isa,
+        s.BP_NAMES[job.predictor], s.EXEC_NAMES[job.executable],
+        run_params(job), commit)]
+
+def start_job(job):
+    """
+    Launches the simulation of a job in its own gem5 output directory,
+    logging its console output there
+    @return (job, process, log file) of the running simulation
+    """
+    outdir = s.RUN_DIR.format(job.isa, job_name(job))
+    if not os.path.isdir(outdir):
+        os.makedirs(outdir)
+    log = open("{}/console.log".format(outdir), "w")
+    command = s.GEM5_COMMAND.format(isa=job.isa, outdir=outdir,
+        executable=job.executable, predictor=job.predictor,
+        profile=s.PROFILE_SIZE)
+    if job.sampled:
+        command += s.GEM5_SAMPLING.format(**s.SAMPLING)
+    process = subprocess.Popen(shlex.split(command), stdout=log,
+        stderr=subprocess.STDOUT)
+    return job, process, log
+
+def finish_job(store, commit, job, process, log):
+    """
+    Appends the stats of a finished simulation to the results store
+    @return whether the job produced a result
+    """
+    log.close()
+    outdir = s.RUN_DIR.format(job.isa, job_name(job))
+    stats_file = "{}/{}".format(outdir,
+        s.SAMPLES_FILE if job.sampled else s.INPUT_FILE)
+    if process.returncode != 0 or not os.path.exists(stats_file):
+        print("FAILED {} on {} (exit {}), see {}/console.log".format(
+            job_name(job), job.isa, process.returncode, outdir))
+        return False
+    try:
+        values = parse_stats(stats_file)
+    except IndexError:
+        print("FAILED {} on {}: incomplete {}".format(
+            job_name(job), job.isa, stats_file))
+        return False
+    r.append_run(store, job.isa, s.BP_NAMES[job.predictor],
+        s.EXEC_NAMES[job.executable], run_params(job), commit, values)
+    print("Completed {} on {}".format(job_name(job), job.isa))
+    return True
+
+def run_jobs(store, commit, jobs, workers=None):
+    """
+    Runs the simulations of the given jobs, up to workers of them at once
+    (one per core by default), storing each result as soon as its run
+    finishes
+    @param store The results store (results.open_store)
+    @param commit Commit the results are recorded for
+    @param jobs List of Job to run
+    @param workers Maximum number of concurrent simulations
+    @return number of jobs that failed
+    """
+    workers = workers or multiprocessing.cpu_count()
+    for isa in set(job.isa for job in jobs):
+        if not os.path.isdir("{}/{}".format(s.OUTPUT_DIR, isa)):
+            os.makedirs("{}/{}".format(s.OUTPUT_DIR, isa))
+
+    queue   = list(jobs)
+    running = []
+    failed  = 0
+    try:
+        while queue or running:
+            while queue and len(running) < workers:
+                running.append(start_job(queue.pop(0)))
+            time.sleep(0.5)
+            for run in [run for run in running if run[1].poll() is not None]:
+                running.remove(run)
+                failed += not finish_job(store, commit, *run)
+    except KeyboardInterrupt:
+        # the runs in flight have no result yet and are redone on resume
+        for job, process, log in running:
+            process.terminate()
+            process.wait()
+            log.close()
+        raise
+    return failed
+
+def load_profile(path):
+    """
+    Reads a branch profile written by the neural predictors (profileFile),
+    most mispredicted branch first
+    @param path The CSV profile of a run
+    @return list of dicts of the columns, counts as ints
+    """
+    rows = []
+    with open(path, "r") as f:
+        for row in csv.DictReader(f):
+            for column in ("executions", "mispredicts", "trainings",
+                           "aliases"):
+                row[column] = int(row[column])
+            row["pc"] = int(row["pc"], 16)
+            row["mispredict_rate"] = float(row["mispredict_rate"])
+            rows.append(row)
+    return rows
+
+def source_lines(isa, binary, pcs):
+    """
+    Maps branch addresses back to the function and source line they were
+    compiled from, through the addr2line of the ISA and the debug info of
+    the binary
+    @param pcs List of addresses to look up
+    @return list of (function, source file, line), ("??", "??", 0) for
+    the addresses the debug info does not cover
+    """
+    command = [s.ADDR2LINE[isa], "-f", "-C", "-e", binary] + \
+        ["{:#x}".format(pc) for pc in pcs]
+    output = subprocess.check_output(command).decode().splitlines()
+
+    # two lines per address: the function, then file:line
+    locations = []
+    for function, location in zip(output[0::2], output[1::2]):
+        match = re.match(r"(.*):(\d+)", location)
+        if match:
+            locations.append((function, match.group(1),
+                int(match.group(2))))
+        else:
+            locations.append((function, "??", 0))
+    return locations
+
+def source_text(source, line):
+    """
+    The text of a line of a Stanford source, found by its file name in
+    STANFORD_DIR whatever directory the binary was built in
+    @return the stripped line, empty if the source is not there
+    """
+    path = "{}/{}".format(s.STANFORD_DIR, os.path.basename(source))
+    if line <= 0 or not os.path.exists(path):
+        return ""
+    lines = open(path, "r").readlines()
+    return lines[line - 1].strip() if line <= len(lines) else ""
+
+def hot_branches(isa, executable, predictor, top=20, sampled=False):
+    """
+    Given ints corresponding to the executable and branch predictor, reads
+    the branch profile of their cached run and maps its most mispredicted
+    branches back to the Stanford sources, printing them as a table and
+    plotting their mispredictions with the source line as label
+    @param top Number of branches to report
+    @param sampled Whether the run is the sampled simulation
+    @return list of the reported profile rows, with their function,
+    location and source text added
+    """
+    job = Job(isa, executable, predictor, sampled)
+    path = "{}/{}".format(s.RUN_DIR.format(isa, job_name(job)),
+        s.PROFILE_FILE)
+    if not os.path.exists(path):
+        print("No branch profile for {} on {} ({})".format(
+            job_name(job), isa, path))
+        return []
+
+    rows = load_profile(path)[:top]
+    binary = "{}/{}".format(s.STANFORD_DIR, s.EXEC_NAMES[executable])
+    if os.path.exists(binary) and rows:
+        locations = source_lines(isa, binary, [row["pc"] for row in rows])
+    else:
+        locations = [("??", "??", 0)] * len(rows)
+
+    print("{} on {}: {} most mispredicted branches".format(
+        job_name(job), isa, len(rows)))
+    print("{:>10} {:>10} {:>10} {:>6} {:>8} {:>7}  {}".format("pc",
+        "executed", "mispredict", "rate", "trained", "aliases", "source"))
+    for row, (function, source, line) in zip(rows, locations):
+        row["function"] = function
+        row["location"] = "{}:{}".format(os.path.basename(source), line)
+        row["source"] = source_text(source, line)
+        print("{:>#10x} {:>10} {:>10} {:>6.3f} {:>8} {:>7}  {} {} {}".format(
+            row["pc"], row["executions"], row["mispredicts"],
+            row["mispredict_rate"], row["trainings"], row["aliases"],
+            row["location"], function, row["source"]))
+
+    data = [Bar(x=["{} {:#x}".format(row["location"], row["pc"])
+                   for row in rows],
+                y=[row["mispredicts"] for row in rows],
+                text=[row["source"] for row in rows],
+                name=job_name(job))]
+    layout = Layout(title="{} on {}: hot branches".format(
+        job_name(job), isa))
+    figure_dir = s.FIGURE_DIR.format(isa)
+    if not os.path.isdir(figure_dir):
+        os.makedirs(figure_dir)
+    plot(Figure(data=data, layout=layout), filename="{}/{}_hot.html".format(
+        figure_dir, job_name(job)), auto_open=False)
+    return rows
+
+def analyze_executable(isa, executable, workers=None):
     """
     Given int corresponding to the executable to test on, runs the
-    simulations for all the branch predictors, outputting results to 
-    the gem5/m5cached directory, as both a figure and text output
+    simulations for all the branch predictors not stored yet, outputting
+    results to the gem5/m5cached directory, as both a figure and text output
     @param executable The integer corresponding to which executable to run
     @return void
     """
-    command = "build/{}/gem5.opt configs/branch/predict.py --exec {} --pred {}"
-    
-    cond_incorrects    = {}
-    indirect_incorrect = {}
-    for i in range(6):
-        os.system(command.format(isa, executable, i))
-        name = s.BP_NAMES[i]
-        dump = open(s.INPUT_FILE, "r").readlines()
-
-        attributes = {"conditional" : "condIncorrect",
-                      "indirect"    : "branchPredindirectMispredicted",
-                      "latency"     : "host_seconds"}
-        attribute_values = [[l.strip() for l in dump
-            if attribute in l][0].split()[1] for attribute in attributes.values()]
-
-        print("===============================================")
-        print("Completed {}".format(name))
-        print("===============================================")        
-        with open("{}/{}/{}_{}.txt".format(s.OUTPUT_DIR, isa,
-            name, s.EXEC_NAMES[executable]), "w") as f:
-            for attribute, value in zip(attributes, attribute_values):
-                f.write("{} : {}\n".format(attribute, value))
-                
+    store  = r.open_store()
+    commit = r.current_commit()
+    run_jobs(store, commit, pending_jobs(store, commit, [isa], [executable],
+        range(len(s.BP_NAMES))), workers)
+    refresh_outputs(store, isa)
+
 if __name__ == "__main__":
-    for executable in range(len(s.EXEC_NAMES)): # range(, 13):
-        # analyze_executable("X86", executable)
-        analyze_executable("ARM", executable)
-        # visualize_bps("ARM", executable)
+    parser = argparse.ArgumentParser(
+        description="Runs the branch predictor sweep, resuming from the "
+                    "results already stored in {}".format(s.RESULTS_DB))
+    parser.add_argument("--isa", nargs="+", default=["ARM"],
+        choices=s.ISAS, help="ISAs to simulate (default ARM)")
+    parser.add_argument("--exec", nargs="+", type=int, dest="executables",
+        default=list(range(len(s.EXEC_NAMES))),
+        help="executables to run, as indices of EXEC_NAMES (default all)")
+    parser.add_argument("--pred", nargs="+", type=int, dest="predictors",
+        default=list(range(len(s.BP_NAMES))),
+        help="predictors to run, as indices of BP_NAMES (default all)")
+    parser.add_argument("-j", "--jobs", type=int, default=None,
+        help="concurrent simulations (default one per core)")
+    parser.add_argument("--hot", type=int, metavar="N", default=0,
+        help="instead of running the sweep, report the N most "
+             "mispredicted branches of the cached runs, mapped back to "
+             "the Stanford sources")
+    parser.add_argument("--refresh", action="store_true",
+        help="instead of running the sweep, only redraw the figures and "
+             "tables that results stored since they were drawn change")
+    parser.add_argument("--sampled", action="store_true",
+        help="run sampled simulations (settings.SAMPLING): fast-forwarded "
+             "on the atomic CPU, which trains the predictor, with detailed "
+             "samples whose counters are summed (with --hot: report the "
+             "branches of the sampled runs)")
+    parser.add_argument("--import-text", action="store_true",
+        help="first add the name_exec.txt results of older sweeps in "
+             "{}/<isa> to the store".format(s.OUTPUT_DIR))
+    args = parser.parse_args()
 
-    """
-    for bp in range(len(s.BP_NAMES)):
-        name = s.BP_NAMES[bp]
-        table = create_table(bp)
-        with open("{}/{}_table.txt".format(s.TABLE_DIR, name) as f):
-            f.write(table)
-    """
+    if args.hot:
+        for isa in args.isa:
+            for executable in args.executables:
+                for predictor in args.predictors:
+                    hot_branches(isa, executable, predictor, args.hot,
+                        args.sampled)
+        sys.exit(0)
+
+    store  = r.open_store()
+    commit = r.current_commit()
+    if args.import_text:
+        for isa in args.isa:
+            print("Imported {} results of {}".format(
+                r.import_text_results(store, isa), isa))
+
+    failed = 0
+    if not args.refresh:
+        jobs = pending_jobs(store, commit, args.isa, args.executables,
+            args.predictors, args.sampled)
+        print("{} simulations to run".format(len(jobs)))
+        failed = run_jobs(store, commit, jobs, args.jobs)
+
+    for isa in args.isa:
+        print("Redrew {} figures and tables of {}".format(
+            refresh_outputs(store, isa), isa))
+    sys.exit(1 if failed else 0)
@@ -0,0 +1,162 @@
+/*****************************************************************
+ * File: branch_profile.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Per-PC profile of the conditional branches a
+ * predictor commits, in an open-addressing table of bounded size.
+ ****************************************************************/
+
+#include "cpu/pred/branch_profile.hh"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "base/intmath.hh"
+#include "base/misc.hh"
+
+BranchProfile::BranchProfile()
+  : used(0), limit(0), shift(0), untrackedExecutions(0),
+	untrackedMispredicts(0)
+{
+}
+
+void
+BranchProfile::init(unsigned capacity, unsigned num_rows)
+{
+  if (capacity < 2 || !isPowerOf2(capacity))
+	fatal("Invalid profile size, must be a power of 2 above 1!\n");
+
+  slots.assign(capacity, Entry());
+  for (Entry &entry : slots) {
+	entry.pc = 0;
+	entry.executions = 0;
+	entry.mispredicts = 0;
+	entry.trainings = 0;
+	entry.row = noRow;
+	entry.aliases = 0;
+  }
+  rowOwners.assign(num_rows, Addr(noOwner));
+
+  // probes stay short, and always end, with a quarter of the slots free
+  used = 0;
+  limit = capacity - capacity / 4;
+  shift = 64 - floorLog2(capacity);
+  untrackedExecutions = 0;
+  untrackedMispredicts = 0;
+}
+
+const BranchProfile::Entry *
+BranchProfile::find(Addr pc) const
+{
+  if (slots.empty())
+	return NULL;
+  unsigned mask = slots.size() - 1;
+  for (unsigned i = home(pc); slots[i].executions; i = (i + 1) & mask) {
+	if (slots[i].pc == pc)
+	  return &slots[i];
+  }
+  return NULL;
+}
+
+void
+BranchProfile::merge(const BranchProfile &other)
+{
+  for (const Entry &theirs : other.slots) {
+	if (!theirs.executions)
+	  continue;
+	Entry *entry = slot(theirs.pc);
+	if (!entry) {
+	  untrackedExecutions += theirs.executions;
+	  untrackedMispredicts += theirs.mispredicts;
+	  continue;
+	}
+	entry->executions += theirs.executions;
+	entry->mispredicts += theirs.mispredicts;
+	entry->trainings += theirs.trainings;
+	entry->aliases += theirs.aliases;
+	if (theirs.row != noRow)
+	  entry->row = theirs.row;
+  }
+  untrackedExecutions += other.untrackedExecutions;
+  untrackedMispredicts += other.untrackedMispredicts;
+}
+
+std::vector<BranchProfile::Entry>
+BranchProfile::sorted() const
+{
+  std::vector<Entry> entries;
+  entries.reserve(used);
+  for (const Entry &entry : slots) {
+	if (entry.executions)
+	  entries.push_back(entry);
+  }
+
+  std::sort(entries.begin(), entries.end(),
+			[](const Entry &a, const Entry &b) {
+			  if (a.mispredicts != b.mispredicts)
+				return a.mispredicts > b.mispredicts;
+			  if (a.executions != b.executions)
+				return a.executions > b.executions;
+			  return a.pc < b.pc;
+			});
+  return entries;
+}
+
+size_t
+BranchProfile::footprint() const
+{
+  return slots.size() * sizeof(Entry) + rowOwners.size() * sizeof(Addr);
+}
+
+void
+BranchProfile::dump(const std::string &path) const
+{
+  FILE *file = fopen(path.c_str(), "w");
+  if (!file)
+	fatal("Can't open branch profile %s for writing!\n", path.c_str());
+
+  bool json = path.size() >= 5 &&
+	path.compare(path.size() - 5, 5, ".json") == 0;
+  std::vector<Entry> entries = sorted();
+
+  if (json) {
+	fprintf(file, "{\n  \"maxTracked\": %u,\n  \"tracked\": %u,\n"
+			"  \"untrackedExecutions\": %" PRIu64 ",\n"
+			"  \"untrackedMispredicts\": %" PRIu64 ",\n"
+			"  \"branches\": [",
+			limit, used, untrackedExecutions, untrackedMispredicts);
+  } else {
+	fprintf(file, "pc,executions,mispredicts,mispredict_rate,trainings,"
+			"row,aliases\n");
+  }
+
+  for (size_t i = 0; i < entries.size(); i++) {
+	const Entry &entry = entries[i];
+	double rate = (double)entry.mispredicts / entry.executions;
+	// branches recorded without a row leave it empty
+	std::string row = entry.row == noRow ? (json ? "null" : "") :
+	  std::to_string(entry.row);
+	if (json) {
+	  fprintf(file, "%s\n    {\"pc\": \"%#" PRIx64 "\", "
+			  "\"executions\": %" PRIu64 ", \"mispredicts\": %" PRIu64 ", "
+			  "\"mispredictRate\": %.6f, \"trainings\": %" PRIu64 ", "
+			  "\"row\": %s, \"aliases\": %u}",
+			  i ? "," : "", (uint64_t)entry.pc, entry.executions,
+			  entry.mispredicts, rate, entry.trainings, row.c_str(),
+			  entry.aliases);
+	} else {
+	  fprintf(file, "%#" PRIx64 ",%" PRIu64 ",%" PRIu64 ",%.6f,%" PRIu64
+			  ",%s,%u\n",
+			  (uint64_t)entry.pc, entry.executions, entry.mispredicts, rate,
+			  entry.trainings, row.c_str(), entry.aliases);
+	}
+  }
+
+  if (json)
+	fprintf(file, "\n  ]\n}\n");
+
+  bool ok = !ferror(file);
+  if (fclose(file) != 0 || !ok)
+	fatal("Error writing branch profile %s!\n", path.c_str());
+}
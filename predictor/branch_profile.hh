@@ -0,0 +1,170 @@
+/*****************************************************************
+ * File: branch_profile.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Per-PC profile of the conditional branches a
+ * predictor commits: executions, mispredictions, training events,
+ * the perceptron row of the branch and how often another branch
+ * had used that row last, in an open-addressing table of bounded
+ * size, dumped sorted as CSV or JSON: header file.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_BRANCH_PROFILE_HH__
+#define __CPU_PRED_BRANCH_PROFILE_HH__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+class BranchProfile
+{
+public:
+  /** Row of the branches recorded without one (e.g. by the replay). */
+  static const uint32_t noRow = ~0u;
+
+  /** Counts of the branch at one PC. */
+  struct Entry
+  {
+	Addr pc;
+	/** Commits of the branch, 0 for a free slot */
+	uint64_t executions;
+	uint64_t mispredicts;
+	/** Commits that trained the weights of the branch */
+	uint64_t trainings;
+	/** Perceptron row the branch last used, or noRow */
+	uint32_t row;
+	/** Commits finding the row last used by another branch */
+	uint32_t aliases;
+  };
+
+  BranchProfile();
+
+  /**
+   * Empties the profile and sizes it; nothing is recorded until then.
+   * @param capacity Slots of the table, a power of 2; at most 3/4 of
+   * them are filled, the branches of the PCs past that are only
+   * counted as untracked.
+   * @param num_rows Perceptron rows of the predictor, whose last user
+   * is kept to count aliases, 0 when branches have no row.
+   */
+  void init(unsigned capacity, unsigned num_rows = 0);
+
+  /** Whether the profile was sized by init(). */
+  bool enabled() const { return !slots.empty(); }
+
+  /**
+   * Counts a committed conditional branch.
+   * @param pc Address of the branch.
+   * @param mispredicted Whether its prediction was wrong.
+   * @param trained Whether it trained the weights.
+   * @param row Perceptron row it used (below num_rows), or noRow.
+   */
+  inline void
+  record(Addr pc, bool mispredicted, bool trained, uint32_t row = noRow)
+  {
+	Entry *entry = slot(pc);
+	if (!entry) {
+	  untrackedExecutions++;
+	  untrackedMispredicts += mispredicted;
+	  return;
+	}
+
+	entry->executions++;
+	entry->mispredicts += mispredicted;
+	entry->trainings += trained;
+	if (row != noRow) {
+	  entry->row = row;
+	  if (rowOwners[row] != pc && rowOwners[row] != noOwner)
+		entry->aliases++;
+	  rowOwners[row] = pc;
+	}
+  }
+
+  /** The counts of a PC, NULL if it was not recorded. */
+  const Entry *find(Addr pc) const;
+
+  /**
+   * Adds the counts of another profile, e.g. of another shard of the
+   * same trace; the rows of the other profile win.
+   */
+  void merge(const BranchProfile &other);
+
+  /** The recorded branches, most mispredicted first, then most
+   *  executed, then by PC. */
+  std::vector<Entry> sorted() const;
+
+  /** Number of PCs recorded, and that can be. */
+  unsigned size() const { return used; }
+  unsigned maxSize() const { return limit; }
+
+  /** Commits of the PCs that found the table full. */
+  uint64_t untracked() const { return untrackedExecutions; }
+
+  /** Bytes held by the table and the row owners. */
+  size_t footprint() const;
+
+  /**
+   * Writes the branches sorted as by sorted(), as JSON if path ends
+   * in .json (with the untracked counts), as CSV otherwise.
+   * @param path File to write, replaced if it exists.
+   */
+  void dump(const std::string &path) const;
+
+private:
+  /** Owner of a row no branch has used yet */
+  static const Addr noOwner = ~Addr(0);
+
+  /** Index of the first slot probed for a PC (Fibonacci hashing). */
+  inline unsigned
+  home(Addr pc) const
+  {
+	return (uint64_t(pc) * 0x9e3779b97f4a7c15ull) >> shift;
+  }
+
+  /**
+   * The slot of a PC, taking a free one (linear probing) if the PC
+   * has none and the table is not full.
+   * @return The slot, or NULL when the PC cannot be recorded.
+   */
+  inline Entry *
+  slot(Addr pc)
+  {
+	if (slots.empty())
+	  return NULL;
+	unsigned mask = slots.size() - 1;
+	for (unsigned i = home(pc); ; i = (i + 1) & mask) {
+	  Entry &entry = slots[i];
+	  if (entry.executions && entry.pc == pc)
+		return &entry;
+	  if (!entry.executions) {
+		if (used == limit)
+		  return NULL;
+		used++;
+		entry.pc = pc;
+		return &entry;
+	  }
+	}
+  }
+
+  /** Open-addressing table, a free slot between the runs of every
+   *  probe as it is never filled past limit */
+  std::vector<Entry> slots;
+
+  /** Slots in use and most that may be */
+  unsigned used;
+  unsigned limit;
+
+  /** Right shift leaving log2(capacity) bits of the hash */
+  unsigned shift;
+
+  /** Branch that last used each perceptron row */
+  std::vector<Addr> rowOwners;
+
+  /** Commits, and mispredicted ones, of the PCs left out */
+  uint64_t untrackedExecutions;
+  uint64_t untrackedMispredicts;
+};
+
+#endif // __CPU_PRED_BRANCH_PROFILE_HH__
@@ -0,0 +1,70 @@
+/*****************************************************************
+ * File: cache_line.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Cache-line aligned allocation for the per-thread
+ * state of the neural branch predictors. Every block is aligned
+ * to and padded up to whole cache lines, so the state of two SMT
+ * threads never shares a line and updates of one thread do not
+ * invalidate the lines of another (false sharing).
+ ****************************************************************/
+
+#ifndef __CPU_PRED_CACHE_LINE_HH__
+#define __CPU_PRED_CACHE_LINE_HH__
+
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+
+/** Size in bytes of the cache lines per-thread state is kept apart by. */
+static const size_t cacheLineSize = 64;
+
+/**
+ * Standard allocator handing out whole, aligned cache lines, for the
+ * containers holding per-thread state.
+ */
+template <class T>
+class CacheLineAllocator
+{
+public:
+  typedef T value_type;
+
+  CacheLineAllocator() { }
+
+  template <class U>
+  CacheLineAllocator(const CacheLineAllocator<U> &) { }
+
+  T *
+  allocate(size_t n)
+  {
+	// rounding up to whole lines keeps the tail line to this block
+	size_t bytes = (n * sizeof(T) + cacheLineSize - 1) /
+	  cacheLineSize * cacheLineSize;
+	void *block = NULL;
+	if (posix_memalign(&block, cacheLineSize, bytes ? bytes :
+					   cacheLineSize) != 0)
+	  throw std::bad_alloc();
+	return static_cast<T *>(block);
+  }
+
+  void deallocate(T *block, size_t) { free(block); }
+
+  template <class U>
+  struct rebind { typedef CacheLineAllocator<U> other; };
+};
+
+template <class T, class U>
+inline bool
+operator==(const CacheLineAllocator<T> &, const CacheLineAllocator<U> &)
+{
+  return true;
+}
+
+template <class T, class U>
+inline bool
+operator!=(const CacheLineAllocator<T> &, const CacheLineAllocator<U> &)
+{
+  return false;
+}
+
+#endif // __CPU_PRED_CACHE_LINE_HH__
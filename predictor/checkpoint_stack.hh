@@ -0,0 +1,183 @@
+/*****************************************************************
+ * File: checkpoint_stack.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Per-thread stack of the speculative steps of the
+ * branches in flight, oldest first, each with a snapshot of the
+ * state it stepped from. A branch checkpoints by the sequence
+ * number of its step, so squashing back to any branch drops the
+ * younger steps in O(1) and restores the snapshot of the branch
+ * directly, whatever the number of branches still in flight.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_CHECKPOINT_STACK_HH__
+#define __CPU_PRED_CHECKPOINT_STACK_HH__
+
+#include <algorithm>
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+#include "cpu/pred/cache_line.hh"
+
+template <class Step>
+class CheckpointStack
+{
+public:
+  CheckpointStack() : mask(0), oldest(0), next(0), snapshotSize(0) { }
+
+  /**
+   * Allocates room for the steps of the branches in flight; the stack
+   * doubles if more are ever in flight at once.
+   * @param capacity Steps preallocated, rounded up to a power of two.
+   * @param snapshot_size Words of the snapshot kept with every step.
+   */
+  void
+  init(unsigned capacity, unsigned snapshot_size = 0)
+  {
+	unsigned size = 1;
+	while (size < capacity)
+	  size <<= 1;
+	steps.assign(size, Step());
+	snapshotSize = snapshot_size;
+	snapshots.assign(size * snapshotSize, 0);
+	mask = size - 1;
+	clear();
+  }
+
+  /** Drops every step, as when no branch is in flight. */
+  void clear() { oldest = next = 0; }
+
+  /**
+   * Pushes the step of a newly predicted branch.
+   * @param step How the branch advanced the speculative state.
+   * @return The checkpoint of the branch, passed back to restore(),
+   * squash() and commit().
+   */
+  inline uint64_t
+  push(const Step &step)
+  {
+	if (next - oldest == steps.size())
+	  grow();
+	steps[next & mask] = step;
+	return next++;
+  }
+
+  /**
+   * Squashes a branch and every younger one.
+   * @param checkpoint Checkpoint of the oldest squashed branch.
+   */
+  inline void
+  squash(uint64_t checkpoint)
+  {
+	if (checkpoint >= oldest && checkpoint < next)
+	  next = checkpoint;
+  }
+
+  /**
+   * Squashes every branch younger than a mispredicted one and
+   * corrects the step of the branch itself.
+   * @param checkpoint Checkpoint of the mispredicted branch.
+   * @param step The step the branch should have taken.
+   */
+  inline void
+  restore(uint64_t checkpoint, const Step &step)
+  {
+	assert(checkpoint >= oldest && checkpoint < next);
+	next = checkpoint + 1;
+	steps[checkpoint & mask] = step;
+  }
+
+  /**
+   * Drops the step of a committing branch, the oldest in flight.
+   * @param checkpoint Checkpoint of the branch.
+   */
+  inline void
+  commit(uint64_t checkpoint)
+  {
+	assert(checkpoint == oldest && oldest < next);
+	oldest++;
+  }
+
+  /** Whether the branch of a checkpoint is still in flight. */
+  inline bool
+  inFlight(uint64_t checkpoint) const
+  {
+	return checkpoint >= oldest && checkpoint < next;
+  }
+
+  /** Step of the branch of a checkpoint in flight. */
+  inline Step &
+  at(uint64_t checkpoint)
+  {
+	assert(inFlight(checkpoint));
+	return steps[checkpoint & mask];
+  }
+
+  /**
+   * Snapshot kept with the step of a checkpoint, written once the step
+   * is pushed; it stays readable after a squash or commit of the step
+   * until the next push.
+   */
+  inline int32_t *
+  snapshot(uint64_t checkpoint)
+  {
+	return &snapshots[(checkpoint & mask) * snapshotSize];
+  }
+
+  inline const int32_t *
+  snapshot(uint64_t checkpoint) const
+  {
+	return &snapshots[(checkpoint & mask) * snapshotSize];
+  }
+
+  /** Number of branches in flight. */
+  inline unsigned size() const { return next - oldest; }
+
+  /** Step of the i-th oldest branch in flight. */
+  inline Step &operator[](unsigned i) { return steps[(oldest + i) & mask]; }
+
+  inline const Step &
+  operator[](unsigned i) const
+  {
+	return steps[(oldest + i) & mask];
+  }
+
+private:
+  void
+  grow()
+  {
+	std::vector<Step, CacheLineAllocator<Step>> wider(steps.size() * 2);
+	std::vector<int32_t, CacheLineAllocator<int32_t>> wider_snapshots(
+	  wider.size() * snapshotSize);
+	for (uint64_t i = oldest; i < next; i++) {
+	  uint64_t slot = i & (wider.size() - 1);
+	  wider[slot] = steps[i & mask];
+	  std::copy(snapshot(i), snapshot(i) + snapshotSize,
+				&wider_snapshots[slot * snapshotSize]);
+	}
+	steps.swap(wider);
+	snapshots.swap(wider_snapshots);
+	mask = steps.size() - 1;
+  }
+
+  /** Storage size minus one, storage being a power of two */
+  uint64_t mask;
+
+  /** Sequence number of the oldest step in flight */
+  uint64_t oldest;
+
+  /** Sequence number the next push gets */
+  uint64_t next;
+
+  /** Words of the snapshot of every step */
+  unsigned snapshotSize;
+
+  /** Steps, sequence number n stored at n & mask */
+  std::vector<Step, CacheLineAllocator<Step>> steps;
+
+  /** Snapshots, that of step n at (n & mask) * snapshotSize */
+  std::vector<int32_t, CacheLineAllocator<int32_t>> snapshots;
+};
+
+#endif // __CPU_PRED_CHECKPOINT_STACK_HH__
@@ -0,0 +1,137 @@
+/*****************************************************************
+ * File: hashed_neurobranch.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Hashed perceptron branch predictor, indexing
+ * several small weight tables by the PC hashed with segments of
+ * the global history.
+ ****************************************************************/
+
+#include "cpu/pred/hashed_neurobranch.hh"
+
+#include <algorithm>
+
+#include "base/misc.hh"
+
+namespace
+{
+  /**
+   * Reads length (at most 64) consecutive history bits starting at
+   * bit first, bit first landing in bit 0 of the result.
+   */
+  inline uint64_t
+  historyBits(const uint64_t *words, unsigned first, unsigned length)
+  {
+	unsigned word = first / 64, offset = first % 64;
+	uint64_t value = words[word] >> offset;
+	if (offset + length > 64)
+	  value |= words[word + 1] << (64 - offset);
+	return length < 64 ? value & ((uint64_t(1) << length) - 1) : value;
+  }
+}
+
+HashedNeuroBP::HashedNeuroBP(const HashedNeuroBPParams *params)
+  : NeuroBP(params),
+	numTables(params->numTables),
+	logTableSize(params->logTableSize),
+	tableMask((1 << params->logTableSize) - 1),
+	segmentStart(params->numTables),
+	segmentLength(params->numTables)
+{
+  if (numTables < 2) {
+	fatal("Invalid number of tables, need the bias table and at least "
+		  "one history table!\n");
+  }
+
+  if (logTableSize == 0 || logTableSize > 20) {
+	fatal("Invalid table size, log2 must be 1 to 20!\n");
+  }
+
+  // a table with no history bits to hash would only be a second bias
+  if (numTables - 1 > historyLength) {
+	fatal("Invalid number of tables, %u history tables need at least as "
+		  "many history bits, not %u!\n", numTables - 1, historyLength);
+  }
+
+  // the history is split into segments differing by one bit at most,
+  // none of them empty; table 0 hashes no history at all
+  for (unsigned t = 1; t < numTables; t++) {
+	segmentStart[t] = (t - 1) * historyLength / (numTables - 1);
+	segmentLength[t] = t * historyLength / (numTables - 1) - segmentStart[t];
+  }
+
+  // one row of 2^logTableSize weights per table, their bias weights
+  // unused; this replaces the numPerceptrons rows set up by NeuroBP
+  for (auto &table : weightTables)
+	table.init(numTables, 1 << logTableSize, params->weightBits);
+
+  // threshold of the hashed perceptron, which sums one weight per
+  // table instead of one per history bit
+  theta = 1.93 * numTables + 14;
+  weightsPerOutput = numTables;
+
+  // an output is numTables weights, which are not rows to cut short,
+  // training steps one weight of each table, not worth buffering
+  // whole tables for, and the hashed rows are shared by design, with
+  // no tags to tell branches apart
+  earlyExit = false;
+  for (ThreadState &thread : threads) {
+	thread.updates = NULL;
+	thread.tags = NULL;
+  }
+  updateBuffers.clear();
+  tagTables.clear();
+
+  // the rows of the profile are the bias weights
+  if (params->profileSize)
+	profile.init(params->profileSize, 1 << logTableSize);
+}
+
+inline unsigned
+HashedNeuroBP::index(unsigned table, Addr branch_addr,
+					 const GlobalHistory &history) const
+{
+  uint64_t hash = pcIndex(branch_addr);
+
+  // fold the segment down to the width of a table index
+  const uint64_t *words = history.words();
+  unsigned first = segmentStart[table];
+  unsigned end = first + segmentLength[table];
+  for (unsigned i = first; i < end; i += logTableSize)
+	hash ^= historyBits(words, i, std::min(logTableSize, end - i));
+
+  return hash & tableMask;
+}
+
+int
+HashedNeuroBP::output(ThreadID tid, Addr branch_addr,
+					  const GlobalHistory &history) const
+{
+  const WeightTable &table = weights(tid);
+  int y_out = 0;
+  for (unsigned t = 0; t < numTables; t++)
+	y_out += table.weight(t, index(t, branch_addr, history));
+  return y_out;
+}
+
+void
+HashedNeuroBP::train(ThreadID tid, Addr branch_addr,
+					 const GlobalHistory &history, bool taken)
+{
+  WeightTable &table = weights(tid);
+  for (unsigned t = 0; t < numTables; t++) {
+	unsigned i = index(t, branch_addr, history);
+	table.adjust(t, i, taken);
+	if (stats.isDetailed())
+	  stats.saturatedWeights += table.saturated(t, i, 1);
+  }
+
+  if (stats.isDetailed())
+	stats.trainedWeights += numTables;
+}
+
+HashedNeuroBP*
+HashedNeuroBPParams::create()
+{
+  return new HashedNeuroBP(this);
+}
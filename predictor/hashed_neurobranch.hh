@@ -0,0 +1,96 @@
+/*****************************************************************
+ * File: hashed_neurobranch.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Hashed perceptron branch predictor: header file.
+ * The global history is split into equal segments and each one
+ * is hashed with the PC into its own small power-of-two table of
+ * weights; the prediction sums one weight per table rather than
+ * one weight per history bit.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_HASHED_NEUROBRANCH_PRED_HH__
+#define __CPU_PRED_HASHED_NEUROBRANCH_PRED_HH__
+
+#include <vector>
+
+#include "cpu/pred/neurobranch.hh"
+#include "params/HashedNeuroBP.hh"
+
+class HashedNeuroBP : public NeuroBP
+{
+public:
+  /**
+   * Default branch predictor constructor.
+   */
+  HashedNeuroBP(const HashedNeuroBPParams *params);
+
+protected:
+  /**
+   * Sums the weight selected in every table by the PC and the history
+   * segment the table covers.
+   * @param tid Thread whose weight tables are used.
+   * @param branch_addr The address of the branch to predict.
+   * @param history Global history the output is computed over.
+   * @return The signed weighted sum, taken when non-negative.
+   */
+  int output(ThreadID tid, Addr branch_addr,
+			 const GlobalHistory &history) const;
+
+  /**
+   * Trains the weight selected in every table towards the outcome.
+   * @param tid Thread whose weight tables are trained.
+   * @param branch_addr The address of the branch being trained.
+   * @param history Global history the output was computed over.
+   * @param taken The resolved direction of the branch.
+   */
+  void train(ThreadID tid, Addr branch_addr, const GlobalHistory &history,
+			 bool taken);
+
+  /** The bias weight of a branch, its only weight not shared with
+   *  other histories, stands for its row in the branch profile. */
+  unsigned
+  profileRow(ThreadID tid, Addr branch_addr) const
+  {
+	return pcIndex(branch_addr);
+  }
+
+private:
+  /** Index of a branch in table 0, the PC folded to logTableSize
+   *  bits, which the other tables hash their segment into. */
+  inline unsigned
+  pcIndex(Addr branch_addr) const
+  {
+	uint64_t pc = branch_addr >> instShiftAmt;
+	return (pc ^ (pc >> logTableSize)) & tableMask;
+  }
+
+  /**
+   * Index of the weight a branch selects in a table: table 0 is
+   * indexed by the PC alone and acts as the bias, every other table
+   * by the PC xor its history segment folded to logTableSize bits.
+   * @param table Table to index.
+   * @param branch_addr The address of the branch.
+   * @param history Global history the segment is taken from.
+   * @return The weight index within the table.
+   */
+  inline unsigned index(unsigned table, Addr branch_addr,
+						const GlobalHistory &history) const;
+
+  /** Number of weight tables, the bias table included */
+  unsigned numTables;
+
+  /** Log2 of the number of weights per table */
+  unsigned logTableSize;
+
+  /** Mask selecting a weight index within a table */
+  unsigned tableMask;
+
+  /** First history bit of the segment hashed into each table */
+  std::vector<unsigned> segmentStart;
+
+  /** Number of history bits hashed into each table */
+  std::vector<unsigned> segmentLength;
+};
+
+#endif // __CPU_PRED_HASHED_NEUROBRANCH_PRED_HH__
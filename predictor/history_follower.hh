@@ -0,0 +1,35 @@
+/*****************************************************************
+ * File: history_follower.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Interface of the neural predictors a tournament
+ * predictor puts behind a fast path: the branches the fast path
+ * predicts still move their history and path forward, without a
+ * perceptron output computed or trained for them.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_HISTORY_FOLLOWER_HH__
+#define __CPU_PRED_HISTORY_FOLLOWER_HH__
+
+#include "base/types.hh"
+
+class HistoryFollower
+{
+public:
+  virtual ~HistoryFollower() { }
+
+  /**
+   * Records a conditional branch another predictor predicted: the
+   * direction it gave is shifted into the speculative history and
+   * path as a prediction of this one would be, and the record goes
+   * through update(), squash() and btbUpdate() as usual, except that
+   * no output is computed for it and it is never trained on.
+   * @param branch_addr The address of the branch.
+   * @param taken The direction the branch was predicted.
+   * @param bp_history Pointer that will be set to the BPHistory object.
+   */
+  virtual void recordBranch(ThreadID tid, Addr branch_addr, bool taken,
+							void * &bp_history) = 0;
+};
+
+#endif // __CPU_PRED_HISTORY_FOLLOWER_HH__
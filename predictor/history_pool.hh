@@ -0,0 +1,95 @@
+/*****************************************************************
+ * File: history_pool.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Slab pool for the per-branch history records of the
+ * neural branch predictors. Records are carved out of slabs sized
+ * to the number of branches in flight and recycled on commit and
+ * on squash, so the fetch path never goes through the allocator.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_HISTORY_POOL_HH__
+#define __CPU_PRED_HISTORY_POOL_HH__
+
+#include <vector>
+
+#include "cpu/pred/cache_line.hh"
+
+template <class Record>
+class HistoryPool
+{
+public:
+  HistoryPool() : slabSize(0), used(0), highWater(0) { }
+
+  /**
+   * Preallocates the first slab. The pool grows by another slab of the
+   * same size if more records are ever in flight at once.
+   * @param slab_size Records per slab, ideally the number of branches
+   * the CPU can have in flight (ROB or fetch queue depth).
+   */
+  void
+  init(unsigned slab_size)
+  {
+	slabSize = slab_size ? slab_size : 1;
+	grow();
+  }
+
+  /** Hands out a record; its contents are whatever it last held. */
+  inline Record *
+  acquire()
+  {
+	if (freeList.empty())
+	  grow();
+	Record *record = freeList.back();
+	freeList.pop_back();
+	if (++used > highWater)
+	  highWater = used;
+	return record;
+  }
+
+  /** Returns a record to the pool once its branch is done with it. */
+  inline void
+  release(Record *record)
+  {
+	freeList.push_back(record);
+	used--;
+  }
+
+  /** Records currently handed out. */
+  unsigned inUse() const { return used; }
+
+  /** Largest number of records ever handed out at once. */
+  unsigned highWaterMark() const { return highWater; }
+
+  /** Records allocated so far, free or in use. */
+  unsigned capacity() const { return slabs.size() * slabSize; }
+
+private:
+  void
+  grow()
+  {
+	slabs.emplace_back(slabSize);
+	freeList.reserve(capacity());
+	// push in reverse so records are handed out in address order
+	for (unsigned i = slabSize; i > 0; i--)
+	  freeList.push_back(&slabs.back()[i - 1]);
+  }
+
+  /** Records added by every slab */
+  unsigned slabSize;
+
+  /** Records currently handed out */
+  unsigned used;
+
+  /** High-water mark of used */
+  unsigned highWater;
+
+  /** Backing storage in whole cache lines, never moved once
+   *  allocated (a slab vector keeps its buffer when moved) */
+  std::vector<std::vector<Record, CacheLineAllocator<Record>>> slabs;
+
+  /** Records available for reuse, most recently released last */
+  std::vector<Record *, CacheLineAllocator<Record *>> freeList;
+};
+
+#endif // __CPU_PRED_HISTORY_POOL_HH__
@@ -0,0 +1,118 @@
+/*****************************************************************
+ * File: history_register.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Multi-word global history shift register used by
+ * the neural branch predictors. Storage is fixed by the template
+ * capacity while shifts only touch the words covering the
+ * configured history length, so long registers are only paid
+ * for when they are actually used.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_HISTORY_REGISTER_HH__
+#define __CPU_PRED_HISTORY_REGISTER_HH__
+
+#include <array>
+#include <stdint.h>
+
+template <unsigned MaxBits>
+class HistoryRegister
+{
+public:
+  /** Number of 64-bit words backing the register. */
+  static const unsigned numWords = (MaxBits + 63) / 64;
+
+  HistoryRegister() { setLength(MaxBits); }
+
+  /**
+   * Sets how many bits of history are kept. Bits past the length are
+   * always zero.
+   * @param length History length in bits, at most MaxBits.
+   */
+  void
+  setLength(unsigned length)
+  {
+	activeWords = (length + 63) / 64;
+	topMask = (length % 64) ? ((uint64_t(1) << (length % 64)) - 1) :
+	  ~uint64_t(0);
+	clear();
+  }
+
+  /** Resets every history bit to not taken. */
+  void clear() { word.fill(0); }
+
+  /**
+   * Shifts a new outcome into bit 0; the oldest bit falls off the end.
+   * @param taken Outcome being recorded.
+   */
+  inline void
+  shiftIn(bool taken)
+  {
+	for (unsigned w = activeWords - 1; w > 0; w--)
+	  word[w] = (word[w] << 1) | (word[w - 1] >> 63);
+	word[0] = (word[0] << 1) | taken;
+	word[activeWords - 1] &= topMask;
+  }
+
+  /** Overwrites the most recent outcome (bit 0). */
+  inline void
+  setNewest(bool taken)
+  {
+	word[0] = (word[0] & ~uint64_t(1)) | taken;
+  }
+
+  /** Outcome recorded i branches ago (0 is the most recent). */
+  inline bool bit(unsigned i) const { return (word[i >> 6] >> (i & 63)) & 1; }
+
+  /** Bit array laid out as consumed by the perceptron kernels. */
+  inline const uint64_t *words() const { return word.data(); }
+
+  /** The 32 most recent outcomes, for interfaces taking a plain GHR. */
+  inline unsigned low() const { return (unsigned)word[0]; }
+
+  /** Number of words of words() covering the configured length. */
+  inline unsigned wordCount() const { return activeWords; }
+
+  /** Bytes of the words covering the configured length. */
+  inline unsigned byteCount() const { return activeWords * 8; }
+
+  /**
+   * Copies a register of the same length, only the wordCount() words
+   * covering it rather than every word of the capacity; snapshots of
+   * a short history then cost a word or two.
+   * @param other Register to copy.
+   */
+  inline void
+  copyFrom(const HistoryRegister &other)
+  {
+	activeWords = other.activeWords;
+	topMask = other.topMask;
+	for (unsigned w = 0; w < activeWords; w++)
+	  word[w] = other.word[w];
+  }
+
+  /**
+   * Overwrites the history with the wordCount() words of a saved
+   * register of the same length, e.g. from a checkpoint.
+   * @param saved Bit array laid out as returned by words().
+   */
+  void
+  setWords(const uint64_t *saved)
+  {
+	for (unsigned w = 0; w < activeWords; w++)
+	  word[w] = saved[w];
+	word[activeWords - 1] &= topMask;
+  }
+
+private:
+  /** Number of words covering the configured length */
+  unsigned activeWords;
+
+  /** Mask keeping the unused top bits of the last active word clear */
+  uint64_t topMask;
+
+  /** History bits, bit i of the array recorded i branches ago */
+  std::array<uint64_t, numWords> word;
+};
+
+#endif // __CPU_PRED_HISTORY_REGISTER_HH__
@@ -0,0 +1,238 @@
+/*****************************************************************
+ * File: hybrid_neurobranch.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Tournament predictor putting a bimodal fast path in
+ * front of a neural predictor: a per-PC chooser only hands the
+ * branches the bimodal counters keep mispredicting to the
+ * perceptron, which is neither read nor trained for the rest but
+ * keeps them in its history.
+ ****************************************************************/
+
+#include "cpu/pred/hybrid_neurobranch.hh"
+
+#include "base/intmath.hh"
+#include "base/misc.hh"
+
+HybridNeuroBP::HybridNeuroBP(const HybridNeuroBPParams *params)
+  : BPredUnit(params),
+	perceptron(params->perceptron),
+	follower(dynamic_cast<HistoryFollower *>(params->perceptron)),
+	bimodalCtrs(params->bimodalSize, SatCounter(params->bimodalCtrBits)),
+	bimodalMask(params->bimodalSize - 1),
+	bimodalCtrBits(params->bimodalCtrBits),
+	chooserCtrs(params->chooserSize, SatCounter(params->chooserCtrBits)),
+	chooserMask(params->chooserSize - 1),
+	chooserCtrBits(params->chooserCtrBits),
+	threads(params->numThreads)
+{
+  if (!perceptron) {
+	fatal("%s needs a perceptron predictor!\n", name().c_str());
+  }
+
+  if (!follower) {
+	fatal("%s needs a neural perceptron predictor (NeuroBP, HashedNeuroBP "
+		  "or NeuroPathBP)!\n", name().c_str());
+  }
+
+  if (!isPowerOf2(params->bimodalSize)) {
+	fatal("Invalid bimodal predictor size!\n");
+  }
+
+  if (!isPowerOf2(params->chooserSize)) {
+	fatal("Invalid chooser size!\n");
+  }
+
+  if (bimodalCtrBits == 0 || bimodalCtrBits > 8 ||
+	  chooserCtrBits == 0 || chooserCtrBits > 8) {
+	fatal("Invalid counter width, must be 1 to 8 bits!\n");
+  }
+
+  // taken/perceptron from the upper half of the counter range
+  bimodalThreshold = 1 << (bimodalCtrBits - 1);
+  chooserThreshold = 1 << (chooserCtrBits - 1);
+
+  for (ThreadState &thread : threads)
+	thread.historyPool.init(params->historyPoolSize);
+}
+
+bool
+HybridNeuroBP::lookup(ThreadID tid, Addr branch_addr, void * &bp_history)
+{
+  BPHistory *history         = threads[tid].historyPool.acquire();
+  history->bimodalTaken      =
+	bimodalCtrs[bimodalIndex(branch_addr)].read() >= bimodalThreshold;
+  history->perceptronHistory = NULL;
+  history->perceptronUsed    = false;
+  history->perceptronTaken   = false;
+  history->uncond            = false;
+  bp_history = static_cast<void *>(history);
+
+  // the perceptron only computes and trains outputs for the branches
+  // the chooser hands to it, but its history and path take in every
+  // branch, as the branches it predicts are correlated with them
+  if (chooserCtrs[chooserIndex(branch_addr)].read() < chooserThreshold) {
+	follower->recordBranch(tid, branch_addr, history->bimodalTaken,
+						   history->perceptronHistory);
+	++fastPathPredictions;
+	return history->bimodalTaken;
+  }
+
+  history->perceptronUsed  = true;
+  history->perceptronTaken =
+	perceptron->lookup(tid, branch_addr, history->perceptronHistory);
+  ++perceptronPredictions;
+  return history->perceptronTaken;
+}
+
+void
+HybridNeuroBP::uncondBranch(ThreadID tid, Addr pc, void * &bp_history)
+{
+  BPHistory *history         = threads[tid].historyPool.acquire();
+  history->perceptronHistory = NULL;
+  history->bimodalTaken      = true;
+  history->perceptronUsed    = false;
+  history->perceptronTaken   = false;
+  history->uncond            = true;
+  bp_history = static_cast<void *>(history);
+  follower->recordBranch(tid, pc, true, history->perceptronHistory);
+}
+
+void
+HybridNeuroBP::btbUpdate(ThreadID tid, Addr branch_addr, void * &bp_history)
+{
+  BPHistory *history = static_cast<BPHistory *>(bp_history);
+  perceptron->btbUpdate(tid, branch_addr, history->perceptronHistory);
+}
+
+void
+HybridNeuroBP::update(ThreadID tid, Addr branch_addr, bool taken,
+					  void *bp_history, bool squashed)
+{
+  assert(bp_history);
+  BPHistory *history = static_cast<BPHistory *>(bp_history);
+
+  // the perceptron follows the usual protocol for every branch,
+  // releasing its record at commit
+  perceptron->update(tid, branch_addr, taken, history->perceptronHistory,
+					 squashed);
+
+  // a squashed branch is updated again when it commits, the counters
+  // are only trained then
+  if (squashed)
+	return;
+
+  if (!history->uncond) {
+	// move towards the perceptron when the bimodal counter alone was
+	// wrong, back to the fast path when only the perceptron was; a
+	// skipped perceptron gets the benefit of the doubt, so branches
+	// the counters miss now and then still reach it
+	bool bimodal_correct = history->bimodalTaken == taken;
+	bool perceptron_correct = !history->perceptronUsed ||
+	  history->perceptronTaken == taken;
+	SatCounter &chooser = chooserCtrs[chooserIndex(branch_addr)];
+	if (bimodal_correct && !perceptron_correct)
+	  chooser.decrement();
+	else if (!bimodal_correct && perceptron_correct)
+	  chooser.increment();
+
+	SatCounter &bimodal = bimodalCtrs[bimodalIndex(branch_addr)];
+	if (taken)
+	  bimodal.increment();
+	else
+	  bimodal.decrement();
+  }
+
+  threads[tid].historyPool.release(history);
+}
+
+void
+HybridNeuroBP::squash(ThreadID tid, void *bp_history)
+{
+  BPHistory *history = static_cast<BPHistory *>(bp_history);
+  perceptron->squash(tid, history->perceptronHistory);
+  threads[tid].historyPool.release(history);
+}
+
+unsigned
+HybridNeuroBP::getGHR(ThreadID tid, void *bp_history) const
+{
+  BPHistory *history = static_cast<BPHistory *>(bp_history);
+  return perceptron->getGHR(tid, history->perceptronHistory);
+}
+
+void
+HybridNeuroBP::regStats()
+{
+  BPredUnit::regStats();
+
+  fastPathPredictions
+	.name(name() + ".fastPathPredictions")
+	.desc("Number of conditional branches predicted by the bimodal "
+		  "counters")
+	;
+
+  perceptronPredictions
+	.name(name() + ".perceptronPredictions")
+	.desc("Number of conditional branches predicted by the perceptron")
+	;
+
+  perceptronRate
+	.name(name() + ".perceptronRate")
+	.desc("Fraction of the conditional branches the perceptron predicted")
+	.precision(6)
+	;
+  perceptronRate = perceptronPredictions /
+	(fastPathPredictions + perceptronPredictions);
+}
+
+void
+HybridNeuroBP::saveCounters(CheckpointOut &cp, const std::string &name,
+							const std::vector<SatCounter> &counters)
+{
+  std::vector<unsigned> values;
+  values.reserve(counters.size());
+  for (const SatCounter &counter : counters)
+	values.push_back(counter.read());
+  arrayParamOut(cp, name, values);
+}
+
+void
+HybridNeuroBP::loadCounters(CheckpointIn &cp, const std::string &name,
+							std::vector<SatCounter> &counters, unsigned bits)
+{
+  std::vector<unsigned> values;
+  arrayParamIn(cp, name, values);
+  if (values.size() != counters.size()) {
+	fatal("Checkpoint has %u %s, %s is configured with %u!\n",
+		  (unsigned)values.size(), name.c_str(), this->name().c_str(),
+		  (unsigned)counters.size());
+  }
+
+  // SatCounter can only be stepped, so count up from zero
+  for (size_t i = 0; i < counters.size(); i++) {
+	counters[i] = SatCounter(bits);
+	for (unsigned v = 0; v < values[i]; v++)
+	  counters[i].increment();
+  }
+}
+
+void
+HybridNeuroBP::serialize(CheckpointOut &cp) const
+{
+  saveCounters(cp, "bimodalCtrs", bimodalCtrs);
+  saveCounters(cp, "chooserCtrs", chooserCtrs);
+}
+
+void
+HybridNeuroBP::unserialize(CheckpointIn &cp)
+{
+  loadCounters(cp, "bimodalCtrs", bimodalCtrs, bimodalCtrBits);
+  loadCounters(cp, "chooserCtrs", chooserCtrs, chooserCtrBits);
+}
+
+HybridNeuroBP*
+HybridNeuroBPParams::create()
+{
+  return new HybridNeuroBP(this);
+}
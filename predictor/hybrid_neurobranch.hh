@@ -0,0 +1,186 @@
+/*****************************************************************
+ * File: hybrid_neurobranch.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Tournament predictor putting a bimodal fast path in
+ * front of a neural predictor: a per-PC chooser only hands the
+ * branches the bimodal counters keep mispredicting to the
+ * perceptron, which is neither read nor trained for the rest but
+ * keeps them in its history: header file.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_HYBRID_NEUROBRANCH_PRED_HH__
+#define __CPU_PRED_HYBRID_NEUROBRANCH_PRED_HH__
+
+#include <string>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/cache_line.hh"
+#include "cpu/pred/history_follower.hh"
+#include "cpu/pred/history_pool.hh"
+#include "cpu/pred/sat_counter.hh"
+#include "params/HybridNeuroBP.hh"
+#include "sim/serialize.hh"
+
+class HybridNeuroBP : public BPredUnit
+{
+public:
+  /**
+   * Default branch predictor constructor.
+   */
+  HybridNeuroBP(const HybridNeuroBPParams *params);
+
+  /**
+   * Predicts a branch with the bimodal counter, or with the perceptron
+   * when the chooser of the branch selects it; either way the
+   * perceptron history and path take in the prediction.
+   * @param branch_addr The address of the branch to look up.
+   * @param bp_history Pointer that will be set to the BPHistory object.
+   * @return Whether or not the branch is taken.
+   */
+  bool lookup(ThreadID tid, Addr branch_addr, void * &bp_history);
+
+  /**
+   * Records an unconditional branch; it is always predicted right, so
+   * the perceptron only takes it into its history and path.
+   * @param bp_history Pointer that will be set to the BPHistory object.
+   */
+  void uncondBranch(ThreadID tid, Addr pc, void * &bp_history);
+
+  /**
+   * Forwards a BTB miss to the perceptron, whose history holds the
+   * branch either way.
+   * @param branch_addr The address of the branch to look up.
+   * @param bp_history Pointer to any bp history state.
+   */
+  void btbUpdate(ThreadID tid, Addr branch_addr, void * &bp_history);
+
+  /**
+   * Updates the perceptron, which only trains on the branches it
+   * predicted; the bimodal counter and the chooser are trained once,
+   * when the branch commits.
+   * @param branch_addr The address of the branch to update.
+   * @param taken Whether or not the branch was taken.
+   * @param bp_history Pointer to the BPHistory object that was created
+   * when the branch was predicted.
+   * @param squashed is set when this function is called during a squash
+   * operation.
+   */
+  void update(ThreadID tid, Addr branch_addr, bool taken, void *bp_history,
+			  bool squashed);
+
+  /**
+   * Squashes the branch in the perceptron.
+   * @param bp_history Pointer to the BPHistory object of the branch.
+   */
+  void squash(ThreadID tid, void *bp_history);
+
+  /**
+   * The getGHR() of the perceptron for the branch, its global history
+   * or path hash, whichever path predicted the branch.
+   * @param bp_history Pointer to the BPHistory object of the branch.
+   */
+  unsigned getGHR(ThreadID tid, void *bp_history) const;
+
+  /**
+   * Registers the predictor stats.
+   */
+  void regStats();
+
+  /**
+   * Saves the bimodal and chooser counters; the perceptron is a
+   * SimObject of its own and checkpointed under its own section.
+   * @param cp Checkpoint section of the predictor.
+   */
+  void serialize(CheckpointOut &cp) const;
+
+  /**
+   * Restores the counters saved by serialize(), into tables of the
+   * same sizes.
+   * @param cp Checkpoint section of the predictor.
+   */
+  void unserialize(CheckpointIn &cp);
+
+private:
+  /**
+   * The branch history information that is created upon predicting
+   * a branch, holding the record of the perceptron.
+   */
+  struct BPHistory {
+	/** History record of the perceptron, which predicted the branch
+	 *  or only recorded it */
+	void *perceptronHistory;
+	/** Prediction of the bimodal counter */
+	bool bimodalTaken;
+	/** Set when the perceptron predicted the branch */
+	bool perceptronUsed;
+	/** Prediction of the perceptron, when it was used */
+	bool perceptronTaken;
+	/** Set for unconditional branches, which train nothing */
+	bool uncond;
+  };
+
+  /** History records of one thread, padded to whole cache lines. */
+  struct alignas(cacheLineSize) ThreadState {
+	HistoryPool<BPHistory> historyPool;
+  };
+
+  /** Bimodal counter predicting a branch. */
+  inline unsigned
+  bimodalIndex(Addr branch_addr) const
+  {
+	return (branch_addr >> instShiftAmt) & bimodalMask;
+  }
+
+  /** Chooser counter of a branch. */
+  inline unsigned
+  chooserIndex(Addr branch_addr) const
+  {
+	return (branch_addr >> instShiftAmt) & chooserMask;
+  }
+
+  /** Writes the values of a counter table into the checkpoint. */
+  static void saveCounters(CheckpointOut &cp, const std::string &name,
+						   const std::vector<SatCounter> &counters);
+
+  /** Reads a counter table written by saveCounters() into counters
+   *  of the given width. */
+  void loadCounters(CheckpointIn &cp, const std::string &name,
+					std::vector<SatCounter> &counters, unsigned bits);
+
+  /** Neural predictor the chooser hands the hard branches to */
+  BPredUnit *perceptron;
+
+  /** The perceptron, recording the branches it does not predict */
+  HistoryFollower *follower;
+
+  /** Bimodal counters of the fast path, indexed by PC */
+  std::vector<SatCounter> bimodalCtrs;
+  unsigned bimodalMask;
+  unsigned bimodalCtrBits;
+  uint8_t bimodalThreshold;
+
+  /** Per-PC counters choosing the perceptron at or above the
+   *  threshold, the bimodal counter below it */
+  std::vector<SatCounter> chooserCtrs;
+  unsigned chooserMask;
+  unsigned chooserCtrBits;
+  uint8_t chooserThreshold;
+
+  /** Per-thread history records */
+  std::vector<ThreadState, CacheLineAllocator<ThreadState>> threads;
+
+  /** Conditional branches predicted by the bimodal fast path */
+  Stats::Scalar fastPathPredictions;
+
+  /** Conditional branches predicted by the perceptron */
+  Stats::Scalar perceptronPredictions;
+
+  /** Fraction of the conditional branches the perceptron predicted */
+  Stats::Formula perceptronRate;
+};
+
+#endif // __CPU_PRED_HYBRID_NEUROBRANCH_PRED_HH__
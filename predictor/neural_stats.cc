@@ -0,0 +1,128 @@
+/*****************************************************************
+ * File: neural_stats.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Registration of the stats shared by the neural
+ * branch predictors.
+ ****************************************************************/
+
+#include "cpu/pred/neural_stats.hh"
+
+void
+NeuralStats::regStats(const std::string &name, bool detailed_stats)
+{
+  detailed = detailed_stats;
+
+  lookupNs
+	.init(16)
+	.name(name + ".lookupNs")
+	.desc("Host ns spent per lookup (detailedStats)")
+	;
+
+  updateNs
+	.init(16)
+	.name(name + ".updateNs")
+	.desc("Host ns spent per update (detailedStats)")
+	;
+
+  squashNs
+	.init(16)
+	.name(name + ".squashNs")
+	.desc("Host ns spent per squash (detailedStats)")
+	;
+
+  predictions
+	.name(name + ".predictions")
+	.desc("Number of conditional branches predicted")
+	;
+
+  weightsRead
+	.name(name + ".weightsRead")
+	.desc("Number of weights read by lookups and updates")
+	;
+
+  weightsWritten
+	.name(name + ".weightsWritten")
+	.desc("Number of weights written by training")
+	;
+
+  weightsPerPrediction
+	.name(name + ".weightsPerPrediction")
+	.desc("Weights read or written per prediction")
+	.precision(2)
+	;
+  weightsPerPrediction = (weightsRead + weightsWritten) / predictions;
+
+  trainings
+	.name(name + ".trainings")
+	.desc("Number of updates training the weights")
+	;
+
+  thresholdTrainings
+	.name(name + ".thresholdTrainings")
+	.desc("Number of correct predictions trained as abs(y_out) <= theta")
+	;
+
+  earlyExits
+	.name(name + ".earlyExits")
+	.desc("Number of outputs summed only until their outcome was settled")
+	;
+
+  deferredBatches
+	.name(name + ".deferredBatches")
+	.desc("Number of write backs of the deferred training (updateDelay)")
+	;
+
+  deferredEvictions
+	.name(name + ".deferredEvictions")
+	.desc("Number of deferred rows written back early to make room")
+	;
+
+  tagHits
+	.name(name + ".tagHits")
+	.desc("Number of lookups finding a row tagged for the branch")
+	;
+
+  tagMisses
+	.name(name + ".tagMisses")
+	.desc("Number of lookups predicting with the fallback row")
+	;
+
+  tagReplacements
+	.name(name + ".tagReplacements")
+	.desc("Number of tagged rows taken over from another branch")
+	;
+
+  squashes
+	.name(name + ".squashes")
+	.desc("Number of squashes recovered from")
+	;
+
+  recoveryBytes
+	.name(name + ".recoveryBytes")
+	.desc("Bytes of history/partial sums restored after squashes")
+	;
+
+  historyRecords
+	.name(name + ".historyRecords")
+	.desc("Most history records in flight at once in a thread "
+		  "(historyPoolSize high-water mark)")
+	;
+
+  trainedWeights
+	.name(name + ".trainedWeights")
+	.desc("Number of weights trained (detailedStats)")
+	;
+
+  saturatedWeights
+	.name(name + ".saturatedWeights")
+	.desc("Number of trained weights left saturated (detailedStats)")
+	;
+
+  saturationRate
+	.name(name + ".saturationRate")
+	.desc("Fraction of trained weights left saturated")
+	.precision(6)
+	;
+  saturationRate = saturatedWeights / trainedWeights;
+}
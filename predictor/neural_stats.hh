@@ -0,0 +1,140 @@
+/*****************************************************************
+ * File: neural_stats.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stats shared by the neural branch predictors: host
+ * time spent in lookup, update and squash, weights touched per
+ * prediction, training events, squash recovery cost and weight
+ * saturation, dumped into stats.txt under the predictor name.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_NEURAL_STATS_HH__
+#define __CPU_PRED_NEURAL_STATS_HH__
+
+#include <chrono>
+#include <stdint.h>
+#include <string>
+
+#include "base/statistics.hh"
+
+class NeuralStats
+{
+public:
+  NeuralStats() : detailed(false) { }
+
+  /**
+   * Names the stats after the predictor.
+   * @param name Name of the predictor SimObject.
+   * @param detailed_stats Whether host time and saturation, which
+   * cost a clock read per call and a row scan per training, are
+   * collected.
+   */
+  void regStats(const std::string &name, bool detailed_stats);
+
+  /** Whether host time and saturation are being collected. */
+  bool isDetailed() const { return detailed; }
+
+  /** Host time in ns to measure a call from, 0 unless detailed. */
+  inline uint64_t
+  startTime() const
+  {
+	return detailed ? hostNs() : 0;
+  }
+
+  /**
+   * Raises historyRecords to the high-water mark of a history pool,
+   * so it ends up at that of the busiest thread.
+   */
+  inline void
+  sampleHistoryRecords(unsigned high_water)
+  {
+	if (high_water > historyRecords.value())
+	  historyRecords += high_water - historyRecords.value();
+  }
+
+  /** Samples the host time elapsed since start into a histogram. */
+  inline void
+  sampleTime(Stats::Histogram &hist, uint64_t start)
+  {
+	if (detailed)
+	  hist.sample(hostNs() - start);
+  }
+
+  /** Host ns spent in each lookup */
+  Stats::Histogram lookupNs;
+
+  /** Host ns spent in each update */
+  Stats::Histogram updateNs;
+
+  /** Host ns spent in each squash */
+  Stats::Histogram squashNs;
+
+  /** Conditional branches predicted */
+  Stats::Scalar predictions;
+
+  /** Weights read to compute outputs or advance partial sums */
+  Stats::Scalar weightsRead;
+
+  /** Weights written by training */
+  Stats::Scalar weightsWritten;
+
+  /** Weights read or written per prediction */
+  Stats::Formula weightsPerPrediction;
+
+  /** Updates that trained the weights */
+  Stats::Scalar trainings;
+
+  /** Correct predictions trained because abs(y_out) <= theta */
+  Stats::Scalar thresholdTrainings;
+
+  /** Outputs whose sum stopped before the last weight (earlyExit) */
+  Stats::Scalar earlyExits;
+
+  /** Write backs of the whole deferred training buffer (updateDelay) */
+  Stats::Scalar deferredBatches;
+
+  /** Buffered rows written back early to make room for another */
+  Stats::Scalar deferredEvictions;
+
+  /** Lookups finding a row tagged for the branch (associativity) */
+  Stats::Scalar tagHits;
+
+  /** Lookups falling back on the shared row (associativity) */
+  Stats::Scalar tagMisses;
+
+  /** Tagged rows taken over from another branch (associativity) */
+  Stats::Scalar tagReplacements;
+
+  /** Squashes recovered from */
+  Stats::Scalar squashes;
+
+  /** Bytes of history and partial sums restored recovering from
+   *  squashes */
+  Stats::Scalar recoveryBytes;
+
+  /** Most history records a thread ever had in flight at once, what
+   *  historyPoolSize has to cover for the pool never to grow */
+  Stats::Scalar historyRecords;
+
+  /** Weights checked for saturation after training (detailed) */
+  Stats::Scalar trainedWeights;
+
+  /** Trained weights left at the limit of their range (detailed) */
+  Stats::Scalar saturatedWeights;
+
+  /** Fraction of trained weights saturated */
+  Stats::Formula saturationRate;
+
+private:
+  static inline uint64_t
+  hostNs()
+  {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	  std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  /** Set when host time and saturation are collected */
+  bool detailed;
+};
+
+#endif // __CPU_PRED_NEURAL_STATS_HH__
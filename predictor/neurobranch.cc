@@ -12,79 +12,262 @@
 #include<iostream>
 #include "base/bitfield.hh"
 #include "base/intmath.hh"
+#include "base/output.hh"
+#include "sim/core.hh"
 
 NeuroBP::NeuroBP(const NeuroBPParams *params)
   : BPredUnit(params),
-	globalPredictorSize(params->globalPredictorSize),
-	globalHistory(params->numThreads, 0),
-	globalHistoryBits(ceilLog2(params->globalPredictorSize))
+	historyLength(params->historyLength),
+	weightTables(params->sharedWeights ? 1 : params->numThreads),
+	updateBuffers(params->updateDelay ? weightTables.size() : 0),
+	tagTables(params->associativity ? weightTables.size() : 0),
+	threads(params->numThreads),
+	profileFile(params->profileFile),
+	profileCallback(this)
 {  
-  if (!isPowerOf2(globalPredictorSize)) {
-	fatal("Invalid global predictor size!\n");
+  if (historyLength == 0 || historyLength > maxHistoryLength) {
+	fatal("Invalid history length, must be 1 to %u bits!\n",
+		  maxHistoryLength);
+  }
+
+  if (params->numPerceptrons == 0) {
+	fatal("Invalid number of perceptrons!\n");
+  }
+
+  if (params->updateDelay && params->updateBufferRows == 0) {
+	fatal("Deferred training needs at least one buffered row!\n");
+  }
+
+  if (params->associativity) {
+	if (params->associativity > 256 ||
+		params->numPerceptrons % params->associativity != 0) {
+	  fatal("Invalid associativity, must be 1 to 256 and divide the "
+			"number of perceptrons!\n");
+	}
+	if (params->tagBits == 0 || params->tagBits > 16) {
+	  fatal("Invalid tag width, must be 1 to 16 bits!\n");
+	}
+	if (params->replacement != "lru" && params->replacement != "useful") {
+	  fatal("Invalid replacement policy %s, must be lru or useful!\n",
+			params->replacement.c_str());
+	}
+	// a row handed to another branch is cleared at once, which its
+	// buffered deltas would undo when written back
+	if (params->updateDelay) {
+	  fatal("Tagged perceptron rows cannot defer their training!\n");
+	}
+  }
+
+  for (ThreadID tid = 0; tid < threads.size(); tid++) {
+	ThreadState &thread = threads[tid];
+
+	// only the configured number of bits is kept (and shifted)
+	thread.globalHistory.setLength(historyLength);
+
+	// threads train one table together unless given their own
+	thread.weights = &weightTables[params->sharedWeights ? 0 : tid];
+	thread.updates = updateBuffers.empty() ? NULL :
+	  &updateBuffers[params->sharedWeights ? 0 : tid];
+	thread.tags = tagTables.empty() ? NULL :
+	  &tagTables[params->sharedWeights ? 0 : tid];
+
+	// history records are recycled rather than allocated per branch
+	thread.historyPool.init(params->historyPoolSize);
   }
-	
-  // Set up historyRegisterMask
-  historyRegisterMask = mask(globalHistoryBits);
 
   // number of hashed perceptrons, i.e. each
   // one act as a local predictor corresponding to local history
-  perceptronCount = 20;
+  perceptronCount = params->numPerceptrons;
 
   // Perceptron theta threshold parameter empirically determined in the
   // fast neural branch predictor paper to be 1.93 * history + 14
-  theta = 1.93 * globalPredictorSize + 14;
+  theta = 1.93 * historyLength + 14;
   
-  // weights per neuron (historyRegister per neuron)
-  weightsTable.assign(perceptronCount,
-					  std::vector<unsigned>(globalPredictorSize + 1, 0));
+  // weights per neuron (historyRegister per neuron), saturating at the
+  // range of the configured weight width; the common history lengths
+  // have kernels of their own with constant loop bounds; tagged rows
+  // are followed by the fallback row of the branches they miss
+  unsigned num_rows = perceptronCount + !tagTables.empty();
+  for (auto &table : weightTables) {
+	table.init(num_rows, historyLength, params->weightBits,
+			   params->specializedKernels, params->earlyExit);
+  }
+
+  // associativity rows a set, each owned by the branch whose partial
+  // tag it holds
+  for (auto &tags : tagTables) {
+	tags.init(perceptronCount, params->associativity, params->tagBits,
+			  params->replacement == "lru" ? TaggedRows::LRU :
+			  TaggedRows::Useful);
+  }
+
+  // trainings gather in a few rows of deltas, written back together
+  for (unsigned i = 0; i < updateBuffers.size(); i++) {
+	updateBuffers[i].init(weightTables[i], params->updateBufferRows,
+						  params->updateDelay);
+  }
+
+  // the bias and one weight per history bit
+  weightsPerOutput = historyLength + 1;
+  detailedStats = params->detailedStats;
+  earlyExit = params->earlyExit;
+  weightsFile = params->weightsFile;
+
+  // every perceptron row remembers the branch that used it last, to
+  // count the branches aliasing on it
+  if (params->profileSize)
+	profile.init(params->profileSize, num_rows);
+  if (profileFile.empty())
+	profileFile = name() + ".profile.csv";
+}
+
+void
+NeuroBP::init()
+{
+  BPredUnit::init();
+
+  // derived predictors shape the table in their own constructor, so
+  // the dump is only read once every constructor has run
+  // a private table per thread all start from the same dump
+  if (!weightsFile.empty()) {
+	for (auto &table : weightTables)
+	  table.load(weightsFile);
+  }
+
+  if (profile.enabled())
+	registerExitCallback(&profileCallback);
+}
+
+void
+NeuroBP::dumpProfile()
+{
+  profile.dump(simout.resolve(profileFile));
 }
 
 inline
 void
 NeuroBP::updateGlobalHistTaken(ThreadID tid)
 {
-  globalHistory[tid] = (globalHistory[tid] << 1) | 1;
-  globalHistory[tid] = globalHistory[tid] & historyRegisterMask;
+  threads[tid].globalHistory.shiftIn(true);
 }
 
 inline
 void
 NeuroBP::updateGlobalHistNotTaken(ThreadID tid)
 {
-  globalHistory[tid] = (globalHistory[tid] << 1);
-  globalHistory[tid] = globalHistory[tid] & historyRegisterMask;
+  threads[tid].globalHistory.shiftIn(false);
 }
 
 void
 NeuroBP::btbUpdate(ThreadID tid, Addr branch_addr, void * &bp_history)
 {
-    //Update Global History to Not Taken (clear LSB)
-    globalHistory[tid] &= (historyRegisterMask & ~ULL(1));
+	//Update Global History to Not Taken (clear LSB)
+	threads[tid].globalHistory.setNewest(false);
 }
 
-bool
-NeuroBP::lookup(ThreadID tid, Addr branch_addr, void * &bp_history)
+int
+NeuroBP::output(ThreadID tid, Addr branch_addr,
+				const GlobalHistory &history) const
 {
   // the current perceptron weights correspond to the ones
   // being hashed from the program counter and number of perceptrons
-  int curPerceptron = branch_addr % perceptronCount; 
-  unsigned thread_history = globalHistory[tid];
-  
+  int curPerceptron = perceptronRow(tid, branch_addr);
+
   // the prediction is an indicator of the signed weighted sum
-  int y_out = weightsTable[curPerceptron][0];
-  for (int i = 1; i <= globalPredictorSize; i++) {
-	if ((thread_history >> (i - 1)) & 1)
-	  y_out += weightsTable[curPerceptron][i];
-	else y_out -= weightsTable[curPerceptron][i];
+  const WeightTable &table = weights(tid);
+  return table.bias(curPerceptron) +
+	table.dotRow(curPerceptron, history.words());
+}
+
+int
+NeuroBP::boundedOutput(ThreadID tid, Addr branch_addr,
+					   const GlobalHistory &history)
+{
+  int curPerceptron = perceptronRow(tid, branch_addr);
+  const WeightTable &table = weights(tid);
+
+  // a prediction only needs the sign of the sum, and only a sum
+  // within theta gets trained on a correct prediction
+  unsigned weights_read;
+  int y_out = table.boundedDotRow(curPerceptron, history.words(),
+								  table.bias(curPerceptron), theta,
+								  weights_read);
+  stats.weightsRead += weights_read + 1;
+  if (weights_read < historyLength)
+	++stats.earlyExits;
+  return y_out;
+}
+
+void
+NeuroBP::regStats()
+{
+  BPredUnit::regStats();
+  stats.regStats(name(), detailedStats);
+}
+
+void
+NeuroBP::train(ThreadID tid, Addr branch_addr, const GlobalHistory &history,
+			   bool taken)
+{
+  int curPerceptron = perceptronRow(tid, branch_addr);
+  WeightTable &table = weights(tid);
+
+  // deferred, the training only reaches the table once its row is
+  // written back
+  if (UpdateBuffer *updates = threads[tid].updates) {
+	stats.deferredEvictions +=
+	  updates->adjustBias(curPerceptron, taken) +
+	  updates->trainRow(curPerceptron, history.words(), taken);
+	return;
   }
+
+  table.adjustBias(curPerceptron, taken);
+
+  // Have to update the corresponding weights to negatively reinforce
+  // the outcome of having predicted incorrectly
+  table.trainRow(curPerceptron, history.words(), taken);
+
+  if (stats.isDetailed()) {
+	stats.trainedWeights += historyLength + 1;
+	stats.saturatedWeights += table.biasSaturated(curPerceptron) +
+	  table.saturated(curPerceptron, 0, historyLength);
+  }
+}
+
+bool
+NeuroBP::lookup(ThreadID tid, Addr branch_addr, void * &bp_history)
+{
+  uint64_t start = stats.startTime();
+  int y_out = predictorOutput(tid, branch_addr, threads[tid].globalHistory);
   
   bool prediction = (y_out >= 0);
   
   // Create BPHistory and pass it back to be recorded.
-  BPHistory *history       = new BPHistory;
-  history->globalHistory   = globalHistory[tid];
+  BPHistory *history       = acquireHistory(tid);
+  history->globalHistory.copyFrom(threads[tid].globalHistory);
+  history->yOut            = y_out;
   history->globalPredTaken = prediction;
+  history->globalUsed      = false;
+  history->resolved        = false;
+  history->tagHit          = false;
+  history->recorded        = false;
   bp_history = (void *)history;
+
+  // the history is speculative: the younger branches predict with
+  // this prediction in it, and a squash puts the snapshot back
+  threads[tid].globalHistory.shiftIn(prediction);
+
+  if (const TaggedRows *tags = threads[tid].tags) {
+	history->tagHit = tags->find(branch_addr >> instShiftAmt) !=
+	  tags->fallbackRow();
+	if (history->tagHit)
+	  ++stats.tagHits;
+	else
+	  ++stats.tagMisses;
+  }
+
+  ++stats.predictions;
+  stats.sampleTime(stats.lookupNs, start);
   
   return prediction;
 }
@@ -93,68 +276,219 @@ void
 NeuroBP::uncondBranch(ThreadID tid, Addr pc, void * &bp_history)
 {  
   // Create BPHistory and pass it back to be recorded.
-  BPHistory *history       = new BPHistory;
-  history->globalHistory   = globalHistory[tid];
+  BPHistory *history       = acquireHistory(tid);
+  history->globalHistory.copyFrom(threads[tid].globalHistory);
+  history->yOut            = 0;
   history->globalPredTaken = true;
   history->globalUsed      = true;
+  history->resolved        = false;
+  history->tagHit          = false;
+  history->recorded        = false;
   bp_history = static_cast<void *>(history);
   updateGlobalHistTaken(tid);
 }
 
+void
+NeuroBP::recordBranch(ThreadID tid, Addr branch_addr, bool taken,
+					  void * &bp_history)
+{
+  BPHistory *history       = acquireHistory(tid);
+  history->globalHistory.copyFrom(threads[tid].globalHistory);
+  history->yOut            = 0;
+  history->globalPredTaken = taken;
+  history->globalUsed      = false;
+  history->resolved        = false;
+  history->tagHit          = false;
+  history->recorded        = true;
+  bp_history = static_cast<void *>(history);
+  threads[tid].globalHistory.shiftIn(taken);
+}
+
 void
 NeuroBP::update(ThreadID tid, Addr branch_addr, bool taken,
 				void *bp_history, bool squashed)
 {
   assert(bp_history);
   
-  int curPerceptron = branch_addr % perceptronCount; 
-  unsigned thread_history = globalHistory[tid];
-  
-  // the prediction is an indicator of the signed weighted sum
-  int y_out = weightsTable[curPerceptron][0];
-  for (int i = 1; i <= globalPredictorSize; i++) {
-	if ((thread_history >> (i - 1)) & 1)
-	  y_out += weightsTable[curPerceptron][i];
-	else y_out -= weightsTable[curPerceptron][i];
+  uint64_t start = stats.startTime();
+  BPHistory *history = static_cast<BPHistory *>(bp_history);
+
+  // a branch predicted elsewhere only ever corrects its history
+  if (history->recorded) {
+	if (squashed) {
+	  threads[tid].globalHistory.copyFrom(history->globalHistory);
+	  threads[tid].globalHistory.shiftIn(taken);
+	  stats.recoveryBytes += history->globalHistory.byteCount();
+	} else {
+	  threads[tid].historyPool.release(history);
+	}
+	stats.sampleTime(stats.updateNs, start);
+	return;
   }
+
+  // training works from the sum and history the prediction was made
+  // with, however many branches were predicted since; unconditional
+  // branches never computed a sum
+  int y_out = history->yOut;
+  if (history->globalUsed)
+	y_out = predictorOutput(tid, branch_addr, history->globalHistory);
   
-  // If this is a misprediction, restore the speculatively
-  // updated state (global history register and local history)
-  // and update again.
-  if (squashed || (abs(y_out) <= theta)) {	
-	if (taken) weightsTable[curPerceptron][0] += 1;
-	else       weightsTable[curPerceptron][0] -= 1;
-	
-	// Have to update the corresponding weights to negatively reinforce
-	// the outcome of having predicted incorrectly
-	for (int i = 1; i < globalPredictorSize; i++) {
-	  if (((thread_history >> (i - 1)) & 1) == taken)
-		weightsTable[curPerceptron][i]    += 1;
-	  else weightsTable[curPerceptron][i] -= 1;
+  // A mispredicted branch no row is tagged for takes one of its set
+  // over, starting from the weights of the fallback row it predicted
+  // with rather than those of the branch it replaces, and trains it
+  // from then on.
+  TaggedRows *tags = threads[tid].tags;
+  bool mispredicted = history->globalPredTaken != taken;
+  if (tags && !history->resolved && !history->globalUsed &&
+	  mispredicted && !history->tagHit) {
+	Addr pc = branch_addr >> instShiftAmt;
+	if (tags->find(pc) == tags->fallbackRow()) {
+	  bool evicted;
+	  unsigned row = tags->allocate(pc, evicted);
+	  if (row != tags->fallbackRow())
+		weights(tid).copyRow(tags->fallbackRow(), row);
+	  if (evicted)
+		++stats.tagReplacements;
 	}
   }
+
+  // If this is a misprediction, train on it straight away; the update
+  // the branch gets again at commit is then left with nothing to do.
+  bool trained = history->resolved;
+  if (!history->resolved && (squashed || (abs(y_out) <= theta))) {
+	trained = true;
+	train(tid, branch_addr, history->globalHistory, taken);
+	++stats.trainings;
+	if (!squashed)
+	  ++stats.thresholdTrainings;
+	stats.weightsWritten += weightsPerOutput;
+  }
   
-  // Global history restore and update
-  globalHistory[tid] = (globalHistory[tid] << 1) | taken;
-  globalHistory[tid] &= historyRegisterMask;
+  // The history the branch was predicted with, followed by its
+  // outcome; the younger branches are squashed already, so only the
+  // outcomes of the older ones in flight come before it. A correct
+  // prediction shifted the outcome in at lookup.
+  if (squashed) {
+	threads[tid].globalHistory.copyFrom(history->globalHistory);
+	threads[tid].globalHistory.shiftIn(taken);
+	stats.recoveryBytes += history->globalHistory.byteCount();
+  }
+  history->resolved = squashed;
+
+  // A squashed branch is updated again when it commits, only then is
+  // its history record done with, and does the commit count towards
+  // writing the deferred training back.
+  if (!squashed) {
+	if (profile.enabled() && !history->globalUsed) {
+	  profile.record(branch_addr, mispredicted, trained,
+					 profileRow(tid, branch_addr));
+	}
+	// a row that predicted its own branch right is kept over the rows
+	// of its set that did not
+	if (tags && history->tagHit) {
+	  unsigned row = tags->find(branch_addr >> instShiftAmt);
+	  if (row != tags->fallbackRow())
+		tags->used(row, !mispredicted);
+	}
+	threads[tid].historyPool.release(history);
+	UpdateBuffer *updates = threads[tid].updates;
+	if (updates && updates->commit())
+	  ++stats.deferredBatches;
+  }
+
+  stats.sampleTime(stats.updateNs, start);
 }
 
 void
 NeuroBP::squash(ThreadID tid, void *bp_history)
 {
+  uint64_t start = stats.startTime();
   BPHistory *history = static_cast<BPHistory *>(bp_history);
 
   // Restore global history to state prior to this branch.
-  globalHistory[tid] = history->globalHistory;
+  threads[tid].globalHistory.copyFrom(history->globalHistory);
+  ++stats.squashes;
+  stats.recoveryBytes += history->globalHistory.byteCount();
+
+  // Recycle this BPHistory now that we're done with it.
+  threads[tid].historyPool.release(history);
+  stats.sampleTime(stats.squashNs, start);
+}
+
+void
+NeuroBP::serialize(CheckpointOut &cp) const
+{
+  SERIALIZE_SCALAR(historyLength);
+
+  // the weights go to compact dumps of their own, which can also be
+  // given to the weightsFile param or to the replay driver, with every
+  // training so far
+  for (UpdateBuffer &updates : updateBuffers)
+	updates.flush();
+  unsigned num_tables = weightTables.size();
+  SERIALIZE_SCALAR(num_tables);
+  for (unsigned i = 0; i < num_tables; i++) {
+	std::string suffix = num_tables > 1 ? std::to_string(i) : "";
+	std::string weights_file = name() + suffix + ".weights";
+	weightTables[i].save(CheckpointIn::dir() + "/" + weights_file);
+	paramOut(cp, "weightsFile" + suffix, weights_file);
+	if (!tagTables.empty())
+	  arrayParamOut(cp, "tags" + suffix, tagTables[i].save());
+  }
 
-  // Delete this BPHistory now that we're done with it.
-  delete history;
+  for (ThreadID tid = 0; tid < threads.size(); tid++) {
+	arrayParamOut(cp, "globalHistory" + std::to_string(tid),
+				  threads[tid].globalHistory.words(),
+				  threads[tid].globalHistory.wordCount());
+  }
+}
+
+void
+NeuroBP::unserialize(CheckpointIn &cp)
+{
+  unsigned history_length;
+  paramIn(cp, "historyLength", history_length);
+  if (history_length != historyLength) {
+	fatal("Checkpoint has %u history bits, %s is configured with %u!\n",
+		  history_length, name().c_str(), historyLength);
+  }
+
+  unsigned num_tables;
+  UNSERIALIZE_SCALAR(num_tables);
+  if (num_tables != weightTables.size()) {
+	fatal("Checkpoint has %u weight tables, %s is configured with %u!\n",
+		  num_tables, name().c_str(), (unsigned)weightTables.size());
+  }
+  for (unsigned i = 0; i < num_tables; i++) {
+	std::string weights_file;
+	std::string suffix = num_tables > 1 ? std::to_string(i) : "";
+	paramIn(cp, "weightsFile" + suffix, weights_file);
+	weightTables[i].load(cp.cptDir + "/" + weights_file);
+	if (!tagTables.empty()) {
+	  std::vector<uint32_t> words;
+	  arrayParamIn(cp, "tags" + suffix, words);
+	  if (!tagTables[i].load(words))
+		fatal("Malformed perceptron tags in checkpoint of %s!\n",
+			  name().c_str());
+	}
+  }
+  for (UpdateBuffer &updates : updateBuffers)
+	updates.clear();
+
+  for (ThreadID tid = 0; tid < threads.size(); tid++) {
+	std::vector<uint64_t> words;
+	arrayParamIn(cp, "globalHistory" + std::to_string(tid), words);
+	if (words.size() != threads[tid].globalHistory.wordCount())
+	  fatal("Malformed global history in checkpoint of %s!\n",
+			name().c_str());
+	threads[tid].globalHistory.setWords(words.data());
+  }
 }
 
 unsigned
 NeuroBP::getGHR(ThreadID tid, void *bp_history) const
 {
-  return static_cast<BPHistory *>(bp_history)->globalHistory;
+  return static_cast<BPHistory *>(bp_history)->globalHistory.low();
 }
 
 NeuroBP*
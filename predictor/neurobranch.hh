@@ -10,17 +10,32 @@
 #ifndef __CPU_PRED_NEUROBRANCH_PRED_HH__
 #define __CPU_PRED_NEUROBRANCH_PRED_HH__
 
+#include <string>
 #include <vector>
 #include <stdlib.h>
 
+#include "base/callback.hh"
 #include "base/types.hh"
 #include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/branch_profile.hh"
+#include "cpu/pred/cache_line.hh"
+#include "cpu/pred/history_follower.hh"
+#include "cpu/pred/history_pool.hh"
+#include "cpu/pred/history_register.hh"
+#include "cpu/pred/neural_stats.hh"
 #include "cpu/pred/sat_counter.hh"
+#include "cpu/pred/tagged_rows.hh"
+#include "cpu/pred/update_buffer.hh"
+#include "cpu/pred/weight_table.hh"
 #include "params/NeuroBP.hh"
+#include "sim/serialize.hh"
 
-class NeuroBP : public BPredUnit
+class NeuroBP : public BPredUnit, public HistoryFollower
 {
 public:
+  /** Longest global history a perceptron can be configured with. */
+  static const unsigned maxHistoryLength = 1024;
+
   /**
    * Default branch predictor constructor.
    */
@@ -43,6 +58,16 @@ public:
    * @param bp_history Pointer that will be set to the BPHistory object.
    */
   void uncondBranch(ThreadID tid, Addr pc, void * &bp_history);
+
+  /**
+   * Records a branch a tournament predictor predicted on its fast
+   * path, shifting the direction it gave into the global history.
+   * @param branch_addr The address of the branch.
+   * @param taken The direction the branch was predicted.
+   * @param bp_history Pointer that will be set to the BPHistory object.
+   */
+  void recordBranch(ThreadID tid, Addr branch_addr, bool taken,
+					void * &bp_history);
   
   /**
    * Updates the branch predictor to Not Taken if a BTB entry is
@@ -66,7 +91,8 @@ public:
 			  bool squashed);
 
   /**
-   * Restores the global branch history on a squash.
+   * Restores the global history the branch was predicted with on a
+   * squash; lookup() shifts a prediction in speculatively.
    * @param bp_history Pointer to the BPHistory object that has the
    * previous global branch history in it.
    */
@@ -74,7 +100,121 @@ public:
 
   unsigned getGHR(ThreadID tid, void *bp_history) const;
 
-private:
+  /**
+   * Loads the weights of the weightsFile param, if set, once the
+   * predictor and its weight table are built, and has the branch
+   * profile written at exit if there is one.
+   */
+  void init();
+
+  /**
+   * Writes the branch profile (profileSize) into profileFile in the
+   * output directory, sorted by mispredictions.
+   */
+  void dumpProfile();
+
+  /**
+   * Registers the predictor stats.
+   */
+  void regStats();
+
+  /**
+   * Saves the global histories into the checkpoint and the weights
+   * into a standalone dump next to it, named after the predictor.
+   * @param cp Checkpoint section of the predictor.
+   */
+  void serialize(CheckpointOut &cp) const;
+
+  /**
+   * Restores the state saved by serialize(); the predictor must have
+   * been configured with the same history length and weight table.
+   * @param cp Checkpoint section of the predictor.
+   */
+  void unserialize(CheckpointIn &cp);
+
+protected:
+  /** Global history register type of every thread and BPHistory. */
+  typedef HistoryRegister<maxHistoryLength> GlobalHistory;
+
+  /**
+   * Computes the output of the perceptron predicting a branch; derived
+   * predictors override this and train() to organise the weights
+   * differently.
+   * @param tid Thread whose weight table is used.
+   * @param branch_addr The address of the branch to predict.
+   * @param history Global history the output is computed over.
+   * @return The signed weighted sum, taken when non-negative.
+   */
+  virtual int output(ThreadID tid, Addr branch_addr,
+					 const GlobalHistory &history) const;
+
+  /**
+   * Trains the weights behind a branch towards its outcome.
+   * @param tid Thread whose weight table is trained.
+   * @param branch_addr The address of the branch being trained.
+   * @param history Global history the output was computed over.
+   * @param taken The resolved direction of the branch.
+   */
+  virtual void train(ThreadID tid, Addr branch_addr,
+					 const GlobalHistory &history, bool taken);
+
+  /**
+   * Perceptron row a branch predicts with and trains: its PC modulo the
+   * number of perceptrons, or with associativity set the row of its
+   * set tagged for it, the fallback row if none is.
+   */
+  inline unsigned
+  perceptronRow(ThreadID tid, Addr branch_addr) const
+  {
+	const TaggedRows *tags = threads[tid].tags;
+	if (!tags)
+	  return branch_addr % perceptronCount;
+	return tags->find(branch_addr >> instShiftAmt);
+  }
+
+  /** Perceptron row the branch profile charges a branch to. */
+  virtual unsigned
+  profileRow(ThreadID tid, Addr branch_addr) const
+  {
+	return perceptronRow(tid, branch_addr);
+  }
+
+  /**
+   * Computes the output of the perceptron like output(), stopping
+   * early once the weights left can no longer change the sign of the
+   * sum nor bring it within theta (earlyExit); the decisions taken on
+   * the sum are then those of the full one.
+   * @param tid Thread whose weight table is used.
+   * @param branch_addr The address of the branch to predict.
+   * @param history Global history the output is computed over.
+   * @return The signed weighted sum, possibly partial past theta.
+   */
+  int boundedOutput(ThreadID tid, Addr branch_addr,
+					const GlobalHistory &history);
+
+  /**
+   * The output of the perceptron predicting a branch, accounting for
+   * the weights read.
+   */
+  inline int
+  predictorOutput(ThreadID tid, Addr branch_addr,
+				  const GlobalHistory &history)
+  {
+	if (earlyExit)
+	  return boundedOutput(tid, branch_addr, history);
+	stats.weightsRead += weightsPerOutput;
+	return output(tid, branch_addr, history);
+  }
+
+  /** Weight table a thread predicts with and trains. */
+  inline WeightTable &weights(ThreadID tid) { return *threads[tid].weights; }
+
+  inline const WeightTable &
+  weights(ThreadID tid) const
+  {
+	return *threads[tid].weights;
+  }
+
   /** Updates global history as taken. */
   inline void updateGlobalHistTaken(ThreadID tid);
 
@@ -88,31 +228,66 @@ private:
    * state properly.
    */
   struct BPHistory {
-	unsigned globalHistory;
+	/** Global history the prediction was made with, copied in and
+	 *  out with copyFrom() so only the words in use are moved */
+	GlobalHistory globalHistory;
+	/** Perceptron output computed by the lookup, reused by update */
+	int yOut;
 	bool globalPredTaken;
 	bool globalUsed;
+	/** Set once a squashing update has trained on the outcome and
+	 *  recorded it, so the update at commit does not do it again */
+	bool resolved;
+	/** Set when the prediction came from a row tagged for the branch
+	 *  rather than from the fallback row */
+	bool tagHit;
+	/** Set for a branch predicted by another predictor, only kept in
+	 *  the history (recordBranch()) */
+	bool recorded;
   };
 
-  /** Number of entries in the global predictor. */
-  unsigned globalPredictorSize;
+  /**
+   * State private to one thread, aligned and padded to whole cache
+   * lines (its containers allocating whole lines too) so SMT threads
+   * never write to a line another thread reads.
+   */
+  struct alignas(cacheLineSize) ThreadState {
+	/** Global history register - used for only the outcomes of 
+	 *  branches as they are executed. Contains as much history as
+	 *  specified by historyLength, one bit per perceptron weight. */
+	GlobalHistory globalHistory;
 
-  /** Global history register - used for only the outcomes of 
-   *  branches as they are executed. Contains as much history as specified by
-   *  globalHistoryBits. Actual number of bits used is determined by
-   *  globalHistoryMask and choiceHistoryMask. */
-  std::vector<unsigned> globalHistory;
-  
-  /** Number of bits for the global history. Determines maximum number of
-	  entries in global and choice predictor tables. */
-  unsigned globalHistoryBits;
+	/** Weight table of the thread, its own or the shared one */
+	WeightTable *weights;
+
+	/** Buffer deferring the training of the weight table, NULL when
+	 *  training writes the table straight away */
+	UpdateBuffer *updates;
 
-  /** Mask to apply to globalHistory to access global history table.
-   *  Based on globalPredictorSize.*/
-  unsigned globalHistoryMask;
+	/** Tags of the rows of the weight table, NULL when rows are
+	 *  picked by PC alone */
+	TaggedRows *tags;
 
-  /** Mask to control how much history is stored. All of it might not be
-   *  used. */
-  unsigned historyRegisterMask;
+	/** Pool the BPHistory records are drawn from, sized to the
+	 *  number of branches the CPU can have in flight; a record goes
+	 *  back to it when its branch commits or is squashed. */
+	HistoryPool<BPHistory> historyPool;
+  };
+
+  /** Draws the history record of a new branch of a thread, keeping
+   *  the historyRecords stat at the high-water mark of the pool. */
+  inline BPHistory *
+  acquireHistory(ThreadID tid)
+  {
+	HistoryPool<BPHistory> &pool = threads[tid].historyPool;
+	BPHistory *history = pool.acquire();
+	stats.sampleHistoryRecords(pool.highWaterMark());
+	return history;
+  }
+
+  /** Number of global history bits (and weights) per perceptron,
+   *  independent of the number of perceptrons. */
+  unsigned historyLength;
 
   /** Perceptron weights for neural branch predictor */
   unsigned perceptronCount;
@@ -121,8 +296,49 @@ private:
    fast neural branch predictor paper to be 1.93 * history + 14 */
   unsigned theta;
   
-  /** Perceptron weights for neural branch predictor */
-  std::vector<std::vector<unsigned>> weightsTable;
+  /** Weights read to compute one output, and written by one
+   *  training */
+  unsigned weightsPerOutput;
+
+  /** Whether the stats include host time and weight saturation */
+  bool detailedStats;
+
+  /** Whether outputs are summed block by block, stopping once the
+   *  outcome is settled; derived predictors with outputs of their
+   *  own turn it off */
+  bool earlyExit;
+
+  /** Weight dump to start from instead of zeroed weights */
+  std::string weightsFile;
+
+  /** Lookup/update/squash costs and training activity */
+  NeuralStats stats;
+
+  /** Perceptron weights for neural branch predictor, one flat
+   *  cache-aligned row of weightBits-wide weights per perceptron;
+   *  a single table shared by every thread, or one per thread */
+  std::vector<WeightTable> weightTables;
+
+  /** Deferred training of each weight table (updateDelay), written
+   *  back before a checkpoint and so mutable */
+  mutable std::vector<UpdateBuffer> updateBuffers;
+
+  /** Tags and replacement state of the rows of each weight table
+   *  (associativity) */
+  std::vector<TaggedRows> tagTables;
+
+  /** Per-thread histories, weights and history records */
+  std::vector<ThreadState, CacheLineAllocator<ThreadState>> threads;
+
+  /** Per-PC counts of the committed conditional branches, when
+   *  profileSize is set */
+  BranchProfile profile;
+
+  /** File of the output directory the profile is written to */
+  std::string profileFile;
+
+  /** Writes the profile when the simulation exits */
+  MakeCallback<NeuroBP, &NeuroBP::dumpProfile> profileCallback;
 };
 
 #endif
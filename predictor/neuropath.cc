@@ -11,128 +11,377 @@
 #include <iostream>
 #include "base/bitfield.hh"
 #include "base/intmath.hh"
+#include "base/output.hh"
+#include "sim/core.hh"
 
 NeuroPathBP::NeuroPathBP(const NeuroPathBPParams *params)
   : BPredUnit(params),
-	globalPredictorSize(params->globalPredictorSize),
-	G (params->numThreads, 0), // 0-initialize global history, entries <=> threads
-	SG(params->numThreads, 0), // 0-initialize speculative history
-	globalHistoryBits(ceilLog2(params->globalPredictorSize))
+	historyLength(params->historyLength),
+	aheadPipelined(params->aheadPipelined),
+	weightTables(params->sharedWeights ? 1 : params->numThreads),
+	updateBuffers(params->updateDelay ? weightTables.size() : 0),
+	threads(params->numThreads), // one 0-initialized state per thread
+	profileFile(params->profileFile),
+	profileCallback(this)
 {  
-  if (!isPowerOf2(globalPredictorSize)) {
-	fatal("Invalid global predictor size!\n");
+  if (historyLength == 0 || historyLength >= maxHistoryLength) {
+	fatal("Invalid history length, must be 1 to %u bits!\n",
+		  maxHistoryLength - 1);
   }
 
-  // Set up the global history mask
-  // this is equivalent to mask(log2(globalPredictorSize)
-  globalHistoryMask = globalPredictorSize - 1;
-	
-  // Set up historyRegisterMask
-  historyRegisterMask = mask(globalHistoryBits);
+  if (params->numPerceptrons == 0) {
+	fatal("Invalid number of perceptrons!\n");
+  }
+
+  if (params->updateDelay && params->updateBufferRows == 0) {
+	fatal("Deferred training needs at least one buffered row!\n");
+  }
 
-  // Check that predictors don't use more bits than they have available
-  if (globalHistoryMask > historyRegisterMask)
-	fatal("Global predictor too large for global history bits!\n");
+  // the registers hold one outcome per path entry, i.e. the current
+  // branch plus historyLength previous ones
+  for (ThreadID tid = 0; tid < threads.size(); tid++) {
+	ThreadState &thread = threads[tid];
+	thread.G.setLength(historyLength + 1);
+	thread.SG = 0;
+	thread.committedPath.init(historyLength + 1);
 
-  // speculative running total computing the perceptron output
-  // each entry j corresponds to partial sum of j steps forward
-  SR.assign(globalPredictorSize + 1, 0);
+	// speculative and non-speculative running totals computing the
+	// perceptron output, each entry j corresponds to partial sum of
+	// j steps forward; every step in flight keeps a copy of SR
+	thread.SR.init(historyLength);
+	thread.R.init(historyLength);
+	thread.steps.init(params->historyPoolSize, thread.SR.snapshotSize());
+	thread.restorePending = false;
+	thread.restorePoint = 0;
+	thread.pendingStep = PendingStep{false, 0, false};
+	thread.lastLatency = 0;
 
-  // running total computing the perceptron output
-  // each entry j corresponds to partial sum of j steps forward
-  R.assign(globalPredictorSize + 1, 0);
+	// threads train one table together unless given their own
+	thread.weights = &weightTables[params->sharedWeights ? 0 : tid];
+	thread.updates = updateBuffers.empty() ? NULL :
+	  &updateBuffers[params->sharedWeights ? 0 : tid];
+
+	// history records are recycled rather than allocated per branch
+	thread.historyPool.init(params->historyPoolSize);
+  }
 
   // number of hashed perceptrons, i.e. each
   // one act as a local predictor corresponding to local history
-  perceptronCount = 10;
+  perceptronCount = params->numPerceptrons;
 
   // Perceptron theta threshold parameter empirically determined in the
   // fast neural branch predictor paper to be 2.14 * history + 20.58
-  theta = 2.14 * (globalPredictorSize + 1) + 20.58;
-  
-  // weights per neuron (historyRegister per neuron)
-  weightsTable.assign(perceptronCount,
-					  std::vector<unsigned>(globalPredictorSize + 1, 0));
+  theta = 2.14 * (historyLength + 1) + 20.58;
+
+  if (params->lookupLatency == 0 || params->adderLevelsPerCycle == 0) {
+	fatal("Invalid latency model, latencies must be at least 1!\n");
+  }
+
+  // ahead-pipelined, the prediction is SR[h] + bias as soon as the row
+  // is read; otherwise the h + 1 weights go through an adder tree first
+  latency = params->lookupLatency;
+  if (!aheadPipelined)
+	latency += divCeil(ceilLog2(historyLength + 1),
+					   params->adderLevelsPerCycle);
+
+  // a path longer than the historyLength + 1 branches kept hashes
+  // the whole path
+  indirectPathLength = params->indirectPathLength;
+  sgMask = historyLength + 1 >= 64 ? ~uint64_t(0) :
+	(uint64_t(1) << (historyLength + 1)) - 1;
   
-  // figure out max and min weights values
-  max_weight = (1 << (globalHistoryBits - 1)) - 1;
-  min_weight = -(max_weight + 1);
+  // weights per neuron (historyRegister per neuron), saturating at the
+  // range of the configured weight width
+  for (auto &table : weightTables) {
+	table.init(perceptronCount, historyLength, params->weightBits,
+			   params->specializedKernels);
+  }
+
+  // trainings gather in a few rows of deltas, written back together
+  for (unsigned i = 0; i < updateBuffers.size(); i++) {
+	updateBuffers[i].init(weightTables[i], params->updateBufferRows,
+						  params->updateDelay);
+  }
+
+  // the common history lengths train with a loop of constant length
+  switch (params->specializedKernels ? historyLength : 0) {
+	case 32: trainPathFn = &NeuroPathBP::trainPath<32>; break;
+	case 64: trainPathFn = &NeuroPathBP::trainPath<64>; break;
+	case 128: trainPathFn = &NeuroPathBP::trainPath<128>; break;
+	case 256: trainPathFn = &NeuroPathBP::trainPath<256>; break;
+	default: trainPathFn = &NeuroPathBP::trainPath<0>; break;
+  }
+
+  detailedStats = params->detailedStats;
+  weightsFile = params->weightsFile;
+
+  // every perceptron row remembers the branch that used it last, to
+  // count the branches aliasing on it
+  if (params->profileSize)
+	profile.init(params->profileSize, perceptronCount);
+  if (profileFile.empty())
+	profileFile = name() + ".profile.csv";
+}
+
+template <unsigned Length>
+void
+NeuroPathBP::trainPath(ThreadState &thread, bool taken)
+{
+  // once the path is full no index wraps, and a fixed length leaves
+  // nothing but constants in the loop
+  const PathHistory &path = thread.committedPath;
+  if (Length && path.size() == Length + 1) {
+	for (unsigned j = 1; j <= Length; j++)
+	  thread.weights->adjust(path[j], j - 1, thread.G.bit(j) == taken);
+	return;
+  }
+
+  for (unsigned j = 1; j <= historyLength; j++) {
+	// weight is chosen mod path.size in the edge case of short history
+	unsigned k = path[j % path.size()];
+	thread.weights->adjust(k, j - 1, thread.G.bit(j) == taken);
+  }
+}
+
+unsigned
+NeuroPathBP::deferPath(ThreadState &thread, unsigned row, bool taken)
+{
+  const PathHistory &path = thread.committedPath;
+  unsigned evictions = thread.updates->adjustBias(row, taken);
+  for (unsigned j = 1; j <= historyLength; j++) {
+	evictions += thread.updates->adjust(path[j % path.size()], j - 1,
+										thread.G.bit(j) == taken);
+  }
+  return evictions;
+}
+
+void
+NeuroPathBP::init()
+{
+  BPredUnit::init();
+
+  // a private table per thread all start from the same dump
+  if (!weightsFile.empty()) {
+	for (auto &table : weightTables)
+	  table.load(weightsFile);
+  }
+
+  if (profile.enabled())
+	registerExitCallback(&profileCallback);
+}
+
+void
+NeuroPathBP::dumpProfile()
+{
+  profile.dump(simout.resolve(profileFile));
+}
+
+void
+NeuroPathBP::regStats()
+{
+  BPredUnit::regStats();
+  stats.regStats(name(), detailedStats);
+
+  lookupCycles
+	.name(name() + ".lookupCycles")
+	.desc("Cycles spent predicting, from the prediction latency model")
+	;
+
+  recoveryStalls
+	.name(name() + ".recoveryStalls")
+	.desc("Predictions a cycle late waiting for SR after a misprediction")
+	;
 }
 
 void
 NeuroPathBP::btbUpdate(ThreadID tid, Addr branch_addr, void * &bp_history)
 {
-    //Update Global History to Not Taken (clear LSB)
-    G[tid] &= (historyRegisterMask & ~ULL(1));
+	//Update Global History to Not Taken (clear LSB)
+	ThreadState &thread = threads[tid];
+	BPHistory *history = static_cast<BPHistory *>(bp_history);
+	if (history && thread.steps.inFlight(history->checkpoint) &&
+		thread.steps.at(history->checkpoint).taken) {
+		// the branch just predicted goes the other way: SR steps again
+		// from the copy the branch kept
+		correctStep(tid, history->checkpoint, false);
+	}
 }
 
+inline
 void
+NeuroPathBP::settleSpeculativeState(ThreadID tid)
+{
+  ThreadState &thread = threads[tid];
+  PendingStep &step = thread.pendingStep;
+  if (thread.restorePending && !thread.steps.size()) {
+	// the branch squashed back to has committed since, and R is the
+	// same copy with the weights it trained
+	thread.SR = thread.R;
+	thread.restorePending = false;
+	step.valid = false;
+	stats.recoveryBytes += thread.SR.snapshotSize() * sizeof(int32_t);
+  } else if (thread.restorePending) {
+	// SR as it stood before the branch squashed back to, the branches
+	// older than it still stepped; one copy, however many branches
+	// were in flight
+	thread.SR.load(thread.steps.snapshot(thread.restorePoint));
+	thread.restorePending = false;
+	stats.recoveryBytes += thread.SR.snapshotSize() * sizeof(int32_t);
+  }
+  if (step.valid) {
+	thread.SR.advance(*thread.weights, step.row, step.taken);
+	stats.weightsRead += historyLength;
+  }
+  step.valid = false;
+}
+
+inline
+uint64_t
+NeuroPathBP::advanceSpeculativeState(ThreadID tid, unsigned row, bool taken)
+{
+  ThreadState &thread = threads[tid];
+
+  // a squash back to this branch restores the sums from this copy
+  uint64_t checkpoint = thread.steps.push(
+	SpeculativeStep{row, taken, thread.SG});
+  thread.SR.save(thread.steps.snapshot(checkpoint));
+
+  // every partial sum moves one step forward with the weights of this
+  // perceptron, in the predicted direction; ahead-pipelined this is
+  // left for after the prediction, it is only needed by the next one
+  if (aheadPipelined) {
+	thread.pendingStep = PendingStep{true, row, taken};
+  } else {
+	thread.SR.advance(*thread.weights, row, taken);
+	stats.weightsRead += historyLength;
+  }
+  thread.SG = ((thread.SG << 1) | taken) & sgMask;
+  return checkpoint;
+}
+
 inline
-NeuroPathBP::updatePath(Addr branch_addr)
+void
+NeuroPathBP::correctStep(ThreadID tid, uint64_t checkpoint, bool taken)
 {
-  path.insert(path.begin(), branch_addr);
-  // only maintains the last H (globalPredictorSize) addresses in history
-  if (path.size() > (globalPredictorSize + 1)) path.pop_back();
+  ThreadState &thread = threads[tid];
+  SpeculativeStep step = thread.steps.at(checkpoint);
+  step.taken = taken;
+  thread.steps.restore(checkpoint, step);
+
+  // SG is the history before the branch, shifted the right way; SR
+  // is copied back and stepped once it is next needed
+  thread.SG = ((step.history << 1) | taken) & sgMask;
+  thread.restorePending = true;
+  thread.restorePoint = checkpoint;
+  thread.pendingStep = PendingStep{true, step.row, taken};
 }
 
+inline
 unsigned
-NeuroPathBP::saturatedUpdate (unsigned weight, bool inc) {
-  if      ( inc && (weight < max_weight)) return weight + 1;
-  else if (!inc && (weight > min_weight)) return weight - 1;
-  return weight;
+NeuroPathBP::pathHash(ThreadID tid) const
+{
+  const ThreadState &thread = threads[tid];
+  const PathHistory &committed = thread.committedPath;
+  unsigned in_flight = thread.steps.size();
+  unsigned length = std::min(std::min(indirectPathLength, historyLength + 1),
+							 in_flight + committed.size());
+  uint32_t hash = 0;
+  for (unsigned j = 0; j < length; j++) {
+	unsigned row = j < in_flight ? thread.steps[in_flight - 1 - j].row :
+	  committed[j - in_flight];
+	hash = (hash ^ (row + 1)) * 0x9e3779b1u;
+  }
+  // the high bits of a product depend on every bit of the rows
+  return hash >> 16;
 }
 
 bool
 NeuroPathBP::lookup(ThreadID tid, Addr branch_addr, void * &bp_history)
 {
-  updatePath(branch_addr);
+  ThreadState &thread = threads[tid];
+  uint64_t start = stats.startTime();
+
+  // SR, SG and the path may have been squashed, or SR still be
+  // waiting for the step of the previous prediction; ahead-pipelined,
+  // the step over a corrected branch is only done now, the prediction
+  // waiting for it
+  bool recovering = aheadPipelined && thread.restorePending &&
+	thread.pendingStep.valid;
+  settleSpeculativeState(tid);
+  unsigned path_hash = indirectPathLength ? pathHash(tid) : 0;
 
-  unsigned k_j;
   // the current perceptron weights correspond to the ones
   // being hashed from the program counter and number of perceptrons
   int curPerceptron = branch_addr % perceptronCount; 
-  int y_out         = weightsTable[curPerceptron][0] +
-	SR[globalPredictorSize];
+  int y_out         = thread.weights->bias(curPerceptron) +
+	thread.SR.top();
   bool prediction   = (y_out >= 0);
 
   // Create BPHistory and pass it back to be recorded.
-  BPHistory *history = new BPHistory;
-  history->globalHistory   = SG[tid];
+  BPHistory *history = acquireHistory(tid);
+  history->globalHistory   = thread.SG;
+  history->pathHash        = path_hash;
+  history->yOut            = y_out;
   history->globalPredTaken = prediction;
+  history->globalUsed      = false;
+  history->recorded        = false;
+  history->checkpoint      = advanceSpeculativeState(tid, curPerceptron,
+													 prediction);
   bp_history = (void *)history;
+  thread.lastLatency = latency + recovering;
 
-  std::vector<unsigned> SR_prime;
-  SR_prime.assign(globalPredictorSize + 1, 0);
-  
-  for (int j = 1; j <= globalPredictorSize; j++) {
-	k_j = globalPredictorSize - j;
-	SR_prime[k_j + 1] = SR[k_j];
-	// case where the prediction is "taken"
-	if (prediction) SR_prime[k_j + 1] += weightsTable[curPerceptron][j];
-	else            SR_prime[k_j + 1] -= weightsTable[curPerceptron][j];
-  }
-
-  SR    = SR_prime;
-  SR[0] = 0;
-  
-  SG[tid] = ((SG[tid] << 1) | prediction);
-  SG[tid] = (SG[tid] & historyRegisterMask);
+  ++stats.predictions;
+  ++stats.weightsRead;
+  lookupCycles += thread.lastLatency;
+  if (recovering)
+	++recoveryStalls;
+  stats.sampleTime(stats.lookupNs, start);
   return prediction;
 }
 
 void
 NeuroPathBP::uncondBranch(ThreadID tid, Addr pc, void * &bp_history)
 {
+  ThreadState &thread = threads[tid];
+  settleSpeculativeState(tid);
+  unsigned path_hash = indirectPathLength ? pathHash(tid) : 0;
+
+  // unconditional branches step the sums like any other path branch,
+  // so SR keeps matching R once they commit
+  int curPerceptron = pc % perceptronCount;
+
   // Create BPHistory and pass it back to be recorded.
-  BPHistory *history = new BPHistory;
-  history->globalHistory = SG[tid];
+  BPHistory *history = acquireHistory(tid);
+  history->globalHistory = thread.SG;
+  history->pathHash = path_hash;
+  history->yOut = thread.weights->bias(curPerceptron) + thread.SR.top();
   history->globalPredTaken = true;
   history->globalUsed = true;
+  history->recorded = false;
+  history->checkpoint = advanceSpeculativeState(tid, curPerceptron, true);
   bp_history = static_cast<void *>(history);
+}
+
+void
+NeuroPathBP::recordBranch(ThreadID tid, Addr branch_addr, bool taken,
+						  void * &bp_history)
+{
+  ThreadState &thread = threads[tid];
+  settleSpeculativeState(tid);
+  unsigned path_hash = indirectPathLength ? pathHash(tid) : 0;
 
-  updatePath(pc);  
-  SG[tid] = ((SG[tid] << 1) | 1);
-  SG[tid] &= historyRegisterMask;
+  // the branch is on the path of the ones after it, whoever predicts
+  // it; only its own output is left out
+  int curPerceptron = branch_addr % perceptronCount;
+  BPHistory *history = acquireHistory(tid);
+  history->globalHistory = thread.SG;
+  history->pathHash = path_hash;
+  history->yOut = 0;
+  history->globalPredTaken = taken;
+  history->globalUsed = false;
+  history->recorded = true;
+  history->checkpoint = advanceSpeculativeState(tid, curPerceptron, taken);
+  bp_history = static_cast<void *>(history);
 }
 
 void
@@ -140,73 +389,219 @@ NeuroPathBP::update(ThreadID tid, Addr branch_addr, bool taken,
 				void *bp_history, bool squashed)
 {
   assert(bp_history);
-  unsigned k, k_j;
+  ThreadState &thread = threads[tid];
+  uint64_t start = stats.startTime();
+  BPHistory *history = static_cast<BPHistory *>(bp_history);
+
+  unsigned k;
   int curPerceptron = branch_addr % perceptronCount; 
-  int y_out         = weightsTable[curPerceptron][0] +
-	SR[globalPredictorSize];
-  
-  unsigned thread_history = SG[tid];
+  int y_out         = history->yOut;
 
-  // maintain R in case the history got squashed
-  std::vector<unsigned> R_prime;
-  R_prime.assign(globalPredictorSize + 1, 0);
-  
-  for (int j = 1; j <= globalPredictorSize; j++) {
-	k_j = globalPredictorSize - j;
-	R_prime[k_j + 1] = R[k_j];
-	// case where the prediction is "taken"
-	if (taken) R_prime[k_j + 1] += weightsTable[curPerceptron][j];
-	else       R_prime[k_j + 1] -= weightsTable[curPerceptron][j];
+  // If this is a misprediction, the younger branches are squashed
+  // already: the speculative state goes back to right after this
+  // branch, stepped the right way this time, keeping the steps of the
+  // older branches still in flight. It trains once it commits.
+  if (squashed) {
+	correctStep(tid, history->checkpoint, taken);
+	stats.sampleTime(stats.updateNs, start);
+	return;
   }
 
-  R    = R_prime;
-  R[0] = 0;
-
-  // Update non-speculative global history shift register
-  G[tid] = ((G[tid] << 1) | taken);
-  G[tid] &= historyRegisterMask;
+  // maintain R, G and the committed path in case the history gets
+  // squashed; they now stand as of this branch
+  thread.R.advance(*thread.weights, curPerceptron, taken);
+  thread.G.shiftIn(taken);
+  thread.committedPath.push(curPerceptron);
+  thread.steps.commit(history->checkpoint);
+  stats.weightsRead += historyLength + 1;
   
-  // If this is a misprediction, restore the speculatively
-  // updated state (global history register and local history)
-  // and update again.
-  if (squashed || (abs(y_out) <= theta)) {
-	if (squashed) {
-	  // Global history restore and update
-	  SG[tid] = G[tid];
-	  SR = R;
-	}
+  // Train on a misprediction, or on a prediction made with too little
+  // confidence, along the committed path
+  bool mispredicted = history->globalPredTaken != taken;
+  if (!history->recorded && (mispredicted || (abs(y_out) <= theta))) {
+	if (!mispredicted)
+	  ++stats.thresholdTrainings;
 	
-	weightsTable[curPerceptron][0] = saturatedUpdate(
-	    weightsTable[curPerceptron][0], taken);
-	for (int j = 1; j <= globalPredictorSize; j++) {
-	  // weight is chosen mod path.size in the edge case of short history
-	  k = (path[j % path.size()] % perceptronCount); 
-	  weightsTable[k][j] = saturatedUpdate(weightsTable[k][j],
-	      ((thread_history >> j) & 1) == taken);
+	if (thread.updates) {
+	  stats.deferredEvictions += deferPath(thread, curPerceptron, taken);
+	} else {
+	  thread.weights->adjustBias(curPerceptron, taken);
+	  (this->*trainPathFn)(thread, taken);
 	}
+
+	++stats.trainings;
+	stats.weightsWritten += historyLength + 1;
+	if (stats.isDetailed()) {
+	  for (unsigned j = 1; j <= historyLength; j++) {
+		k = thread.committedPath[j % thread.committedPath.size()];
+		stats.saturatedWeights += thread.weights->saturated(k, j - 1, 1);
+	  }
+	  stats.trainedWeights += historyLength + 1;
+	  stats.saturatedWeights += thread.weights->biasSaturated(curPerceptron);
+	}
+  }
+
+  if (profile.enabled() && !history->globalUsed && !history->recorded) {
+	profile.record(branch_addr, mispredicted,
+				   mispredicted || abs(y_out) <= theta, curPerceptron);
   }
+
+  // A squashed branch is updated again when it commits, only then is
+  // its history record done with.
+  thread.historyPool.release(history);
+  if (thread.updates && thread.updates->commit())
+	++stats.deferredBatches;
+
+  stats.sampleTime(stats.updateNs, start);
 }
 
 void
 NeuroPathBP::squash(ThreadID tid, void *bp_history)
 {
+  ThreadState &thread = threads[tid];
+  uint64_t start = stats.startTime();
   BPHistory *history = static_cast<BPHistory *>(bp_history);
 
-  // Restore global history to state prior to this branch.
-  SG[tid] = G[tid];
+  // Drop this branch and every younger one; the squashes come youngest
+  // first, so the last one leaves the steps of the branches older than
+  // the misprediction in place, and the state from before it.
+  if (thread.steps.inFlight(history->checkpoint)) {
+	thread.SG = thread.steps.at(history->checkpoint).history;
+	thread.steps.squash(history->checkpoint);
 
-  // Restore SR to a non-speculative version computed end if
-  // using only non-speculative information
-  SR = R;
+	// SR only gets the copy back before its next use, so a burst of
+	// squashes pays for one; the step a squashed branch left pending
+	// goes with it
+	thread.restorePending = true;
+	thread.restorePoint = history->checkpoint;
+	thread.pendingStep.valid = false;
+  }
+  ++stats.squashes;
   
-  // Delete this BPHistory now that we're done with it.
-  delete history;
+  // Recycle this BPHistory now that we're done with it.
+  thread.historyPool.release(history);
+  stats.sampleTime(stats.squashNs, start);
+}
+
+void
+NeuroPathBP::serialize(CheckpointOut &cp) const
+{
+  SERIALIZE_SCALAR(historyLength);
+
+  // the weights go to a compact dump of their own, which can also be
+  // given to the weightsFile param or to the replay driver, with every
+  // training so far
+  for (UpdateBuffer &updates : updateBuffers)
+	updates.flush();
+  unsigned num_tables = weightTables.size();
+  SERIALIZE_SCALAR(num_tables);
+  for (unsigned i = 0; i < num_tables; i++) {
+	std::string suffix = num_tables > 1 ? std::to_string(i) : "";
+	std::string weights_file = name() + suffix + ".weights";
+	weightTables[i].save(CheckpointIn::dir() + "/" + weights_file);
+	paramOut(cp, "weightsFile" + suffix, weights_file);
+  }
+
+  for (ThreadID tid = 0; tid < threads.size(); tid++) {
+	const ThreadState &thread = threads[tid];
+	std::string t = std::to_string(tid);
+	arrayParamOut(cp, "G" + t, thread.G.words(), thread.G.wordCount());
+	// drained, SG is G but for the bits past the 64 it keeps
+	std::vector<uint64_t> sg(thread.G.words(),
+							 thread.G.words() + thread.G.wordCount());
+	sg[0] = thread.SG;
+	arrayParamOut(cp, "SG" + t, sg);
+
+	// the sums in logical order; SR is saved as restored from the
+	// snapshot it is waiting for, a deferred step as it stands
+	std::vector<int32_t> r, sr;
+	RunningSums spec = thread.SR;
+	if (thread.restorePending)
+	  spec.load(thread.steps.snapshot(thread.restorePoint));
+	for (unsigned i = 0; i < thread.R.size(); i++) {
+	  r.push_back(thread.R[i]);
+	  sr.push_back(spec[i]);
+	}
+	arrayParamOut(cp, "R" + t, r);
+	arrayParamOut(cp, "SR" + t, sr);
+
+	const PendingStep &step = thread.pendingStep;
+	std::vector<unsigned> step_fields = { step.valid, step.row, step.taken };
+	arrayParamOut(cp, "pendingStep" + t, step_fields);
+
+	// newest branch first; the predictor is drained, so the path is
+	// the committed one
+	std::vector<unsigned> rows;
+	for (unsigned j = 0; j < thread.committedPath.size(); j++)
+	  rows.push_back(thread.committedPath[j]);
+	arrayParamOut(cp, "path" + t, rows);
+  }
+}
+
+void
+NeuroPathBP::unserialize(CheckpointIn &cp)
+{
+  unsigned history_length;
+  paramIn(cp, "historyLength", history_length);
+  if (history_length != historyLength) {
+	fatal("Checkpoint has %u path branches, %s is configured with %u!\n",
+		  history_length, name().c_str(), historyLength);
+  }
+
+  unsigned num_tables;
+  UNSERIALIZE_SCALAR(num_tables);
+  if (num_tables != weightTables.size()) {
+	fatal("Checkpoint has %u weight tables, %s is configured with %u!\n",
+		  num_tables, name().c_str(), (unsigned)weightTables.size());
+  }
+  for (unsigned i = 0; i < num_tables; i++) {
+	std::string weights_file;
+	std::string suffix = num_tables > 1 ? std::to_string(i) : "";
+	paramIn(cp, "weightsFile" + suffix, weights_file);
+	weightTables[i].load(cp.cptDir + "/" + weights_file);
+  }
+  for (UpdateBuffer &updates : updateBuffers)
+	updates.clear();
+
+  for (ThreadID tid = 0; tid < threads.size(); tid++) {
+	ThreadState &thread = threads[tid];
+	std::string t = std::to_string(tid);
+	std::vector<uint64_t> g, sg;
+	std::vector<int32_t> r, sr;
+	std::vector<unsigned> step_fields, rows;
+	arrayParamIn(cp, "G" + t, g);
+	arrayParamIn(cp, "SG" + t, sg);
+	arrayParamIn(cp, "R" + t, r);
+	arrayParamIn(cp, "SR" + t, sr);
+	arrayParamIn(cp, "pendingStep" + t, step_fields);
+	arrayParamIn(cp, "path" + t, rows);
+
+	if (g.size() != thread.G.wordCount() || sg.size() != g.size() ||
+		r.size() != thread.R.size() || sr.size() != r.size() ||
+		step_fields.size() != 3 || rows.size() > historyLength + 1)
+	  fatal("Malformed checkpoint of %s!\n", name().c_str());
+
+	thread.G.setWords(g.data());
+	thread.SG = sg[0] & sgMask;
+	thread.R.assign(r);
+	thread.SR.assign(sr);
+	thread.restorePending = false;
+	thread.steps.clear();
+	thread.pendingStep = PendingStep{step_fields[0] != 0, step_fields[1],
+								   step_fields[2] != 0};
+
+	// pushed oldest first so the newest ends up at the head again
+	thread.committedPath.clear();
+	for (unsigned j = rows.size(); j-- > 0; )
+	  thread.committedPath.push(rows[j]);
+  }
 }
 
 unsigned
 NeuroPathBP::getGHR(ThreadID tid, void *bp_history) const
 {
-  return static_cast<BPHistory *>(bp_history)->globalHistory;
+  const BPHistory *history = static_cast<BPHistory *>(bp_history);
+  return indirectPathLength ? history->pathHash : history->globalHistory;
 }
 
 NeuroPathBP*
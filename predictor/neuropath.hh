@@ -9,17 +9,35 @@
 #ifndef __CPU_PRED_NEUROPATH_PRED_HH__
 #define __CPU_PRED_NEUROPATH_PRED_HH__
 
+#include <string>
 #include <vector>
 #include <stdlib.h>
 
+#include "base/callback.hh"
 #include "base/types.hh"
 #include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/branch_profile.hh"
+#include "cpu/pred/cache_line.hh"
+#include "cpu/pred/checkpoint_stack.hh"
+#include "cpu/pred/history_follower.hh"
+#include "cpu/pred/history_pool.hh"
+#include "cpu/pred/history_register.hh"
+#include "cpu/pred/neural_stats.hh"
+#include "cpu/pred/path_history.hh"
+#include "cpu/pred/running_sums.hh"
 #include "cpu/pred/sat_counter.hh"
+#include "cpu/pred/update_buffer.hh"
+#include "cpu/pred/weight_table.hh"
 #include "params/NeuroPathBP.hh"
+#include "sim/serialize.hh"
 
-class NeuroPathBP : public BPredUnit
+class NeuroPathBP : public BPredUnit, public HistoryFollower
 {
 public:
+  /** Capacity of the history registers, i.e. one more than the longest
+   *  history a perceptron can be configured with. */
+  static const unsigned maxHistoryLength = 1024;
+
   /**
    * Default branch predictor constructor.
    */
@@ -42,6 +60,18 @@ public:
    * @param bp_history Pointer that will be set to the BPHistory object.
    */
   void uncondBranch(ThreadID tid, Addr pc, void * &bp_history);
+
+  /**
+   * Records a branch a tournament predictor predicted on its fast
+   * path: the sums, SG and the path step over it in the direction it
+   * was given, and R, G and the committed path once it commits, but
+   * no prediction is read from SR and the weights are not trained.
+   * @param branch_addr The address of the branch.
+   * @param taken The direction the branch was predicted.
+   * @param bp_history Pointer that will be set to the BPHistory object.
+   */
+  void recordBranch(ThreadID tid, Addr branch_addr, bool taken,
+					void * &bp_history);
   
   /**
    * Updates the branch predictor to Not Taken if a BTB entry is
@@ -71,23 +101,101 @@ public:
    */
   void squash(ThreadID tid, void *bp_history);
 
+  /**
+   * The history BPredUnit indexes the indirect predictor with for a
+   * branch: SG when indirectPathLength is 0, otherwise a hash of the
+   * perceptron rows of the last indirectPathLength branches of the
+   * path, which tell apart the ways a register jump is reached.
+   * @param bp_history Pointer to the BPHistory object of the branch.
+   */
   unsigned getGHR(ThreadID tid, void *bp_history) const;
 
+  /**
+   * Cycles from the fetch of the latest branch a thread predicted
+   * until its prediction was ready, which the replay driver stalls
+   * fetch on. Ahead-pipelined, this is the row read plus the final add
+   * of the bias to SR[h], and one cycle more for the step over the
+   * corrected branch right after a misprediction, as SR could not be
+   * computed ahead then; otherwise the whole adder tree over
+   * historyLength + 1 weights is on the path of every prediction.
+   * @param tid Thread the prediction is for.
+   * @return The prediction latency in cycles.
+   */
+  unsigned
+  predictionLatency(ThreadID tid) const
+  {
+	return threads[tid].lastLatency;
+  }
+
+  /**
+   * Loads the weights of the weightsFile param, if set, and has the
+   * branch profile written at exit if there is one.
+   */
+  void init();
+
+  /**
+   * Writes the branch profile (profileSize) into profileFile in the
+   * output directory, sorted by mispredictions.
+   */
+  void dumpProfile();
+
+  /**
+   * Registers the predictor stats.
+   */
+  void regStats();
+
+  /**
+   * Saves the histories, path and running sums into the checkpoint
+   * and the weights into a standalone dump next to it, named after
+   * the predictor.
+   * @param cp Checkpoint section of the predictor.
+   */
+  void serialize(CheckpointOut &cp) const;
+
+  /**
+   * Restores the state saved by serialize(); the predictor must have
+   * been configured with the same history length and weight table.
+   * @param cp Checkpoint section of the predictor.
+   */
+  void unserialize(CheckpointIn &cp);
+
 private:
   /**
-   * Updates the global path tracking instance variable to include
-   * newly encountered branch instruction
-   * @param branch_addr Address object containing memory location obj
+   * Brings SR up to date before it is used: copies back the snapshot a
+   * squash or a corrected step restores it to (R if the branch has
+   * committed since), then applies the step left pending by it or by
+   * an ahead-pipelined lookup.
    */
-  void inline updatePath(Addr branch_addr);
+  inline void settleSpeculativeState(ThreadID tid);
 
   /**
-   * Updates the corresponding weight parameter w/ saturation factor
-   * @param weight Current value of weight to be updated
-   * @param inc Whether the weight is to be incremented or decremented
+   * Moves the speculative state of a thread forward over a newly
+   * predicted branch and checkpoints it, with a snapshot of SR.
+   * @param row Perceptron row of the branch.
+   * @param taken Direction the branch was predicted.
+   * @return The checkpoint of the branch.
    */
-  unsigned saturatedUpdate (unsigned weight, bool inc);
-  
+  inline uint64_t advanceSpeculativeState(ThreadID tid, unsigned row,
+										  bool taken);
+
+  /**
+   * Redoes the step of a branch in flight in another direction,
+   * dropping the steps of the younger branches: SG is set right away,
+   * SR goes back to the snapshot of the branch and steps again before
+   * its next use.
+   * @param checkpoint Checkpoint of the branch.
+   * @param taken Direction the branch goes.
+   */
+  inline void correctStep(ThreadID tid, uint64_t checkpoint, bool taken);
+
+  /**
+   * Hash of the rows of the last indirectPathLength branches of the
+   * speculative path of a thread (the steps in flight, then the
+   * committed path), mixed so the low bits the indirect predictor
+   * keeps of it depend on every row.
+   */
+  inline unsigned pathHash(ThreadID tid) const;
+
   /**
    * The branch history information that is created upon predicting
    * a branch.  It will be passed back upon updating and squashing,
@@ -95,52 +203,161 @@ private:
    * state properly.
    */
   struct BPHistory {
+	/** The 32 most recent outcomes of SG at the prediction */
 	unsigned globalHistory;
+	/** pathHash() of the path before the branch, what getGHR() gives
+	 *  the indirect predictor with indirectPathLength set */
+	unsigned pathHash;
+	/** Perceptron output the prediction was made with */
+	int yOut;
+	/** Position of the step of the branch in the checkpoint stack */
+	uint64_t checkpoint;
 	bool globalPredTaken;
 	bool globalUsed;
+	/** Set for a branch predicted by another predictor, only kept in
+	 *  the path (recordBranch()) */
+	bool recorded;
   };
 
-  /** Number of entries in the global predictor. */
-  unsigned globalPredictorSize;
-  
-  /** Global history register, denoted G in this version to match the
-   *  notation from the paper. Contains as much history as specified by
-   *  globalHistoryBits. Actual number of bits used is determined by
-   *  globalHistoryMask and choiceHistoryMask. */
-  std::vector<unsigned> G;
-
-  /** Speculative global history register, denoted SG in this version 
-   *  to match notation from the paper. Contains prediction history for
-   *  the same size as that of the true history global register, i.e.
-   *  globalHistoryBits. Actual number of bits used is determined by
-   *  globalHistoryMask and choiceHistoryMask. */
-  std::vector<unsigned> SG;
-  
-  /** Running total computing the perceptron output steps
-	  in the future (in reality). */
-  std::vector<unsigned> R;
-  
-  /** Speculative running total computing the perceptron output steps
-	  in the future (in reality). */
-  std::vector<unsigned> SR;
-  
-  /** History of the path the CPU has travelled through the program trace,
-      i.e. the previous h branch instruction addresses. These are used for
-	  prediction, i.e. multiple inputs. */
-  std::vector<unsigned> path;
-  
-  /** Number of bits for the global history. Determines maximum number of
-	  entries in global and choice predictor tables. */
-  unsigned globalHistoryBits;
+  /** Step a branch advanced the speculative state with: its
+	  perceptron row and the direction it was predicted, and SG as it
+	  stood before; its snapshot in the stack holds SR before it. */
+  struct SpeculativeStep {
+	unsigned row;
+	bool taken;
+	uint64_t history;
+  };
+
+  /** Step deferred by an ahead-pipelined lookup: perceptron row and
+	  predicted direction to advance SR with. */
+  struct PendingStep {
+	bool valid;
+	unsigned row;
+	bool taken;
+  };
+
+  /**
+   * State private to one thread, aligned and padded to whole cache
+   * lines (its containers allocating whole lines too) so SMT threads
+   * never write to a line another thread reads.
+   */
+  struct alignas(cacheLineSize) ThreadState {
+	/** Global history register, denoted G in this version to match the
+	 *  notation from the paper. Contains as much history as specified
+	 *  by historyLength, plus the outcome of the current branch. */
+	HistoryRegister<maxHistoryLength> G;
+
+	/** Speculative global history register, denoted SG in this version
+	 *  to match notation from the paper: its 64 most recent bits, all
+	 *  it is read for (getGHR()), past which it is G anyway once the
+	 *  branches in flight are done with. */
+	uint64_t SG;
+
+	/** Running total computing the perceptron output steps
+		in the future (in reality), one pipeline per thread. */
+	RunningSums R;
+
+	/** Speculative running total computing the perceptron output steps
+		in the future (in reality), one pipeline per thread. */
+	RunningSums SR;
+
+	/** Path of the committed branches, i.e. the perceptron rows of the
+		previous h branch instructions, which G, R and the weight
+		training follow; the speculative path is this one after the
+		rows of the steps in flight. */
+	PathHistory committedPath;
+
+	/** Steps of the branches in flight, oldest first; SG, SR and the
+		path are the committed state advanced by these. */
+	CheckpointStack<SpeculativeStep> steps;
+
+	/** Step deferred by the last ahead-pipelined lookup, or to redo
+		after restoring SR */
+	PendingStep pendingStep;
+
+	/** Set when SR is to be restored from the snapshot of the step of
+		restorePoint before its next use; a burst of squashes only
+		copies the snapshot of the oldest squashed branch back. */
+	bool restorePending;
+	uint64_t restorePoint;
+
+	/** Latency of the latest prediction, predictionLatency() */
+	unsigned lastLatency;
+
+	/** Weight table of the thread, its own or the shared one */
+	WeightTable *weights;
+
+	/** Buffer deferring the training of the weight table, NULL when
+	 *  training writes the table straight away */
+	UpdateBuffer *updates;
+
+	/** Pool the BPHistory records are drawn from, sized to the
+	 *  number of branches the CPU can have in flight; a record goes
+	 *  back to it when its branch commits or is squashed. */
+	HistoryPool<BPHistory> historyPool;
+  };
+
+  /** Draws the history record of a new branch of a thread, keeping
+   *  the historyRecords stat at the high-water mark of the pool. */
+  inline BPHistory *
+  acquireHistory(ThreadID tid)
+  {
+	HistoryPool<BPHistory> &pool = threads[tid].historyPool;
+	BPHistory *history = pool.acquire();
+	stats.sampleHistoryRecords(pool.highWaterMark());
+	return history;
+  }
 
-  /** Mask to apply to globalHistory to access global history table.
-   *  Based on globalPredictorSize.*/
-  unsigned globalHistoryMask;
+  /**
+   * Trains the weights along the path of a thread towards the outcome
+   * of a branch: weight j - 1 of the row of the branch j back follows
+   * whether bit j of G agrees with the outcome, both the branch and
+   * its path being committed.
+   * @tparam Length History length the loop is compiled for, or 0 for
+   * the version reading historyLength.
+   * @param thread State of the thread the branch belongs to.
+   * @param taken The resolved direction of the branch.
+   */
+  template <unsigned Length>
+  void trainPath(ThreadState &thread, bool taken);
+
+  /**
+   * Trains the bias of a branch and the weights along its path like
+   * adjustBias() and trainPath(), into the deferred training buffer.
+   * @param thread State of the thread the branch belongs to.
+   * @param row Perceptron row of the branch.
+   * @param taken The resolved direction of the branch.
+   * @return The number of buffered rows written back to make room.
+   */
+  unsigned deferPath(ThreadState &thread, unsigned row, bool taken);
+
+  /** Number of previous branches (and weights) along the path used by
+   *  each perceptron, independent of the number of perceptrons. */
+  unsigned historyLength;
+
+  /** trainPath() instantiation for the configured history length */
+  void (NeuroPathBP::*trainPathFn)(ThreadState &thread, bool taken);
+
+  /** Set when SR has to be advanced off the critical path, i.e. after
+	  the lookup has returned its prediction */
+  bool aheadPipelined;
+
+  /** Prediction latency in cycles, from the latency model params,
+   *  when SR is ready at the lookup */
+  unsigned latency;
+
+  /** Branches of the path hashed into getGHR(), 0 to give SG */
+  unsigned indirectPathLength;
 
-  /** Mask to control how much history is stored. All of it might not be
-   *  used. */
-  unsigned historyRegisterMask;
+  /** Mask of the historyLength + 1 bits of SG, at most 64 */
+  uint64_t sgMask;
 
+  /** Prediction latency accumulated over every lookup, as a stat */
+  Stats::Scalar lookupCycles;
+
+  /** Lookups that waited for SR to be restored and stepped */
+  Stats::Scalar recoveryStalls;
+  
   /** Perceptron weights for neural branch predictor */
   unsigned perceptronCount;
 
@@ -148,14 +365,37 @@ private:
    fast neural branch predictor paper to be 1.93 * history + 14 */
   unsigned theta;
 
-  /** Saturated value of the maximum weight on a branch */
-  unsigned max_weight;
+  /** Perceptron weights for neural branch predictor, one flat
+   *  cache-aligned row of weightBits-wide weights per perceptron;
+   *  weights saturate at the range of the weight width. A single
+   *  table shared by every thread, or one per thread. */
+  std::vector<WeightTable> weightTables;
 
-  /** Saturated value of the minimum weight on a branch */
-  unsigned min_weight;
+  /** Deferred training of each weight table (updateDelay), written
+   *  back before a checkpoint and so mutable */
+  mutable std::vector<UpdateBuffer> updateBuffers;
 
-  /** Perceptron weights for neural branch predictor */
-  std::vector<std::vector<unsigned>> weightsTable;
+  /** Per-thread histories, sums, path, weights and history records */
+  std::vector<ThreadState, CacheLineAllocator<ThreadState>> threads;
+
+  /** Whether the stats include host time and weight saturation */
+  bool detailedStats;
+
+  /** Weight dump to start from instead of zeroed weights */
+  std::string weightsFile;
+
+  /** Lookup/update/squash costs and training activity */
+  NeuralStats stats;
+
+  /** Per-PC counts of the committed conditional branches, when
+   *  profileSize is set */
+  BranchProfile profile;
+
+  /** File of the output directory the profile is written to */
+  std::string profileFile;
+
+  /** Writes the profile when the simulation exits */
+  MakeCallback<NeuroPathBP, &NeuroPathBP::dumpProfile> profileCallback;
 };
 
 #endif
@@ -0,0 +1,88 @@
+/*****************************************************************
+ * File: path_history.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Fixed-capacity circular buffer holding the path
+ * of the neural path branch predictor. Entries are the perceptron
+ * rows the previous branches hashed to, so recording a branch is
+ * a single store and reading the path back needs no rehashing.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_PATH_HISTORY_HH__
+#define __CPU_PRED_PATH_HISTORY_HH__
+
+#include <algorithm>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "cpu/pred/cache_line.hh"
+
+class PathHistory
+{
+public:
+  PathHistory() : mask(0), head(0), depth(0), count(0) { }
+
+  /**
+   * Allocates an empty path of the given depth; the storage is
+   * rounded up to a power of two so positions wrap with a mask.
+   * @param path_depth Number of most recent branches kept.
+   */
+  void
+  init(unsigned path_depth)
+  {
+	depth = path_depth;
+	entries.assign(1 << ceilLog2(depth), 0);
+	mask = entries.size() - 1;
+	clear();
+  }
+
+  /** Forgets every recorded branch. */
+  void
+  clear()
+  {
+	head = count = 0;
+	std::fill(entries.begin(), entries.end(), 0);
+  }
+
+  /**
+   * Records a new branch as the most recent entry; once depth
+   * branches are held the oldest one is dropped.
+   * @param row Perceptron row the branch hashed to.
+   */
+  inline void
+  push(unsigned row)
+  {
+	head = (head - 1) & mask;
+	entries[head] = row;
+	if (count < depth)
+	  count++;
+  }
+
+  /** Row of the branch recorded j branches ago (0 is the newest). */
+  inline unsigned
+  operator[](unsigned j) const
+  {
+	return entries[(head + j) & mask];
+  }
+
+  /** Number of branches recorded, at most the depth. */
+  inline unsigned size() const { return count; }
+
+private:
+  /** Storage size minus one, storage being a power of two */
+  unsigned mask;
+
+  /** Position of the most recent entry */
+  unsigned head;
+
+  /** Number of branches kept */
+  unsigned depth;
+
+  /** Number of branches recorded so far, saturating at depth */
+  unsigned count;
+
+  /** Perceptron rows, newest at head and older ones following it */
+  std::vector<unsigned, CacheLineAllocator<unsigned>> entries;
+};
+
+#endif // __CPU_PRED_PATH_HISTORY_HH__
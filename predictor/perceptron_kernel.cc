@@ -0,0 +1,781 @@
+/*****************************************************************
+ * File: perceptron_kernel.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Branch-free signed dot product and training kernels
+ * shared by the neural branch predictors (SSE2/AVX2/AVX-512 on x86,
+ * NEON on ARM, scalar everywhere else).
+ ****************************************************************/
+
+#include "cpu/pred/perceptron_kernel.hh"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PERCEPTRON_KERNEL_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define PERCEPTRON_KERNEL_NEON 1
+#endif
+
+/** Forces the generic bodies into the fixed-length kernels, which only
+ *  pay off once the length is a constant inside the loops. */
+#define KERNEL_INLINE inline __attribute__((always_inline))
+
+namespace PerceptronKernel
+{
+
+/** Returns the history bit paired with weight i. */
+static inline unsigned
+historyBit(const uint64_t *history, unsigned i)
+{
+  return (history[i >> 6] >> (i & 63)) & 1;
+}
+
+/** Extracts count (<= 32) history bits starting at bit i. The vector
+ *  loops only ask for aligned groups, so these never straddle words. */
+static inline uint32_t
+historyBits(const uint64_t *history, unsigned i, unsigned count)
+{
+  return (history[i >> 6] >> (i & 63)) & ((uint64_t(1) << count) - 1);
+}
+
+/** Scalar body over [start, end), also used for the vector tails. */
+template <typename T>
+static inline int32_t
+dotRange(const T *weights, const uint64_t *history,
+		 unsigned start, unsigned end)
+{
+  int32_t sum = 0;
+  for (unsigned i = start; i < end; i++) {
+	// m is 0 for a taken history bit and -1 (all ones) otherwise, so
+	// (w ^ m) - m negates the weight without a data-dependent branch
+	int32_t m = (int32_t)historyBit(history, i) - 1;
+	sum += ((int32_t)weights[i] ^ m) - m;
+  }
+  return sum;
+}
+
+template <typename T>
+static inline void
+trainRange(T *weights, const uint64_t *history, unsigned start,
+		   unsigned end, bool taken, int32_t min_weight, int32_t max_weight)
+{
+  for (unsigned i = start; i < end; i++) {
+	// +1 when the history bit agrees with the outcome, -1 otherwise
+	int32_t agree = historyBit(history, i) == taken;
+	int32_t w = weights[i] + 2 * agree - 1;
+	weights[i] = w < min_weight ? min_weight :
+	  (w > max_weight ? max_weight : w);
+  }
+}
+
+template <typename T>
+static inline void
+accumulateRange(int32_t *sums, const T *weights, unsigned start,
+				unsigned end, bool taken)
+{
+  int32_t m = (int32_t)taken - 1;
+  for (unsigned i = start; i < end; i++)
+	sums[i] += ((int32_t)weights[i] ^ m) - m;
+}
+
+template <typename T>
+static KERNEL_INLINE int32_t
+dotReference(const T *weights, const uint64_t *history, unsigned length)
+{
+  return dotRange(weights, history, 0, length);
+}
+
+template <typename T>
+static KERNEL_INLINE void
+trainReference(T *weights, const uint64_t *history, unsigned length,
+			   bool taken, int32_t min_weight, int32_t max_weight)
+{
+  trainRange(weights, history, 0, length, taken, min_weight, max_weight);
+}
+
+template <typename T>
+static void
+accumulateReference(int32_t *sums, const T *weights, unsigned length,
+					bool taken)
+{
+  accumulateRange(sums, weights, 0, length, taken);
+}
+
+/** Row kernels of the Reference implementation for one fixed length. */
+template <unsigned Length, typename T>
+struct FixedReference
+{
+  static int32_t
+  dot(const T *weights, const uint64_t *history, unsigned)
+  {
+	return dotReference(weights, history, Length);
+  }
+
+  static void
+  train(T *weights, const uint64_t *history, unsigned, bool taken,
+		int32_t min_weight, int32_t max_weight)
+  {
+	trainReference(weights, history, Length, taken, min_weight, max_weight);
+  }
+};
+
+int32_t
+dotScalar(const int8_t *weights, const uint64_t *history, unsigned length)
+{
+  return dotReference(weights, history, length);
+}
+
+int32_t
+dotScalar(const int16_t *weights, const uint64_t *history, unsigned length)
+{
+  return dotReference(weights, history, length);
+}
+
+void
+trainScalar(int8_t *weights, const uint64_t *history, unsigned length,
+			bool taken, int32_t min_weight, int32_t max_weight)
+{
+  trainReference(weights, history, length, taken, min_weight, max_weight);
+}
+
+void
+trainScalar(int16_t *weights, const uint64_t *history, unsigned length,
+			bool taken, int32_t min_weight, int32_t max_weight)
+{
+  trainReference(weights, history, length, taken, min_weight, max_weight);
+}
+
+void
+accumulateScalar(int32_t *sums, const int8_t *weights, unsigned length,
+				 bool taken)
+{
+  accumulateReference(sums, weights, length, taken);
+}
+
+void
+accumulateScalar(int32_t *sums, const int16_t *weights, unsigned length,
+				 bool taken)
+{
+  accumulateReference(sums, weights, length, taken);
+}
+
+// All vector bodies widen the weights to 16 bits and multiply them by a
+// +1/-1 lane vector with a widening multiply-add, so the most negative
+// weight of either storage width never has to be negated in place.
+
+#if PERCEPTRON_KERNEL_X86
+
+#define SSE2_TARGET   __attribute__((target("sse2")))
+#define AVX2_TARGET   __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f,avx512bw")))
+
+SSE2_TARGET static inline __m128i
+load8x16(const int8_t *weights)
+{
+  __m128i b = _mm_loadl_epi64((const __m128i *)weights);
+  return _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8);
+}
+
+SSE2_TARGET static inline __m128i
+load8x16(const int16_t *weights)
+{
+  return _mm_loadu_si128((const __m128i *)weights);
+}
+
+SSE2_TARGET static inline void
+store8x16(int8_t *weights, __m128i w)
+{
+  _mm_storel_epi64((__m128i *)weights, _mm_packs_epi16(w, w));
+}
+
+SSE2_TARGET static inline void
+store8x16(int16_t *weights, __m128i w)
+{
+  _mm_storeu_si128((__m128i *)weights, w);
+}
+
+/** -1 in every 16-bit lane whose history bit is clear, 0 elsewhere. */
+SSE2_TARGET static inline __m128i
+clearMask8x16(const uint64_t *history, unsigned i)
+{
+  const __m128i lanes = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+  __m128i bits = _mm_set1_epi16((short)historyBits(history, i, 8));
+  return _mm_cmpeq_epi16(_mm_and_si128(bits, lanes), _mm_setzero_si128());
+}
+
+template <typename T>
+SSE2_TARGET static KERNEL_INLINE int32_t
+dotSSE2(const T *weights, const uint64_t *history, unsigned length)
+{
+  const __m128i one = _mm_set1_epi16(1);
+  __m128i acc = _mm_setzero_si128();
+
+  unsigned i = 0;
+  for (; i + 8 <= length; i += 8) {
+	__m128i sign = _mm_or_si128(clearMask8x16(history, i), one);
+	acc = _mm_add_epi32(acc, _mm_madd_epi16(load8x16(weights + i), sign));
+  }
+
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4e));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xb1));
+  return _mm_cvtsi128_si32(acc) + dotRange(weights, history, i, length);
+}
+
+template <typename T>
+SSE2_TARGET static KERNEL_INLINE void
+trainSSE2(T *weights, const uint64_t *history, unsigned length, bool taken,
+		  int32_t min_weight, int32_t max_weight)
+{
+  const __m128i one  = _mm_set1_epi16(1);
+  const __m128i dir  = _mm_set1_epi16(taken ? 0 : -1);
+  const __m128i vmin = _mm_set1_epi16((short)min_weight);
+  const __m128i vmax = _mm_set1_epi16((short)max_weight);
+
+  unsigned i = 0;
+  for (; i + 8 <= length; i += 8) {
+	// +1 where the history bit agrees with the outcome, -1 elsewhere
+	__m128i delta = _mm_or_si128(
+		_mm_xor_si128(clearMask8x16(history, i), dir), one);
+	__m128i w = _mm_adds_epi16(load8x16(weights + i), delta);
+	w = _mm_min_epi16(_mm_max_epi16(w, vmin), vmax);
+	store8x16(weights + i, w);
+  }
+  trainRange(weights, history, i, length, taken, min_weight, max_weight);
+}
+
+template <typename T>
+SSE2_TARGET static void
+accumulateSSE2(int32_t *sums, const T *weights, unsigned length, bool taken)
+{
+  // weights are widened before (w ^ m) - m negates them when the branch
+  // is not taken, so the most negative 16-bit weight cannot overflow
+  const __m128i m = _mm_set1_epi32(taken ? 0 : -1);
+
+  unsigned i = 0;
+  for (; i + 8 <= length; i += 8) {
+	__m128i w  = load8x16(weights + i);
+	__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16);
+	__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16);
+	__m128i *out = (__m128i *)(sums + i);
+	_mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out),
+		_mm_sub_epi32(_mm_xor_si128(lo, m), m)));
+	_mm_storeu_si128(out + 1, _mm_add_epi32(_mm_loadu_si128(out + 1),
+		_mm_sub_epi32(_mm_xor_si128(hi, m), m)));
+  }
+  accumulateRange(sums, weights, i, length, taken);
+}
+
+AVX2_TARGET static inline __m256i
+load16x16(const int8_t *weights)
+{
+  return _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)weights));
+}
+
+AVX2_TARGET static inline __m256i
+load16x16(const int16_t *weights)
+{
+  return _mm256_loadu_si256((const __m256i *)weights);
+}
+
+AVX2_TARGET static inline void
+store16x16(int8_t *weights, __m256i w)
+{
+  _mm_storeu_si128((__m128i *)weights,
+				   _mm_packs_epi16(_mm256_castsi256_si128(w),
+								   _mm256_extracti128_si256(w, 1)));
+}
+
+AVX2_TARGET static inline void
+store16x16(int16_t *weights, __m256i w)
+{
+  _mm256_storeu_si256((__m256i *)weights, w);
+}
+
+AVX2_TARGET static inline __m256i
+clearMask16x16(const uint64_t *history, unsigned i)
+{
+  const __m256i lanes = _mm256_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128,
+	  256, 512, 1024, 2048, 4096, 8192, 16384, (short)0x8000);
+  __m256i bits = _mm256_set1_epi16((short)historyBits(history, i, 16));
+  return _mm256_cmpeq_epi16(_mm256_and_si256(bits, lanes),
+							_mm256_setzero_si256());
+}
+
+template <typename T>
+AVX2_TARGET static KERNEL_INLINE int32_t
+dotAVX2(const T *weights, const uint64_t *history, unsigned length)
+{
+  const __m256i one = _mm256_set1_epi16(1);
+  __m256i acc = _mm256_setzero_si256();
+
+  unsigned i = 0;
+  for (; i + 16 <= length; i += 16) {
+	__m256i sign = _mm256_or_si256(clearMask16x16(history, i), one);
+	acc = _mm256_add_epi32(acc,
+						   _mm256_madd_epi16(load16x16(weights + i), sign));
+  }
+
+  __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc),
+							   _mm256_extracti128_si256(acc, 1));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+  half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+  return _mm_cvtsi128_si32(half) + dotRange(weights, history, i, length);
+}
+
+template <typename T>
+AVX2_TARGET static KERNEL_INLINE void
+trainAVX2(T *weights, const uint64_t *history, unsigned length, bool taken,
+		  int32_t min_weight, int32_t max_weight)
+{
+  const __m256i one  = _mm256_set1_epi16(1);
+  const __m256i dir  = _mm256_set1_epi16(taken ? 0 : -1);
+  const __m256i vmin = _mm256_set1_epi16((short)min_weight);
+  const __m256i vmax = _mm256_set1_epi16((short)max_weight);
+
+  unsigned i = 0;
+  for (; i + 16 <= length; i += 16) {
+	__m256i delta = _mm256_or_si256(
+		_mm256_xor_si256(clearMask16x16(history, i), dir), one);
+	__m256i w = _mm256_adds_epi16(load16x16(weights + i), delta);
+	w = _mm256_min_epi16(_mm256_max_epi16(w, vmin), vmax);
+	store16x16(weights + i, w);
+  }
+  trainRange(weights, history, i, length, taken, min_weight, max_weight);
+}
+
+template <typename T>
+AVX2_TARGET static void
+accumulateAVX2(int32_t *sums, const T *weights, unsigned length, bool taken)
+{
+  const __m256i m = _mm256_set1_epi32(taken ? 0 : -1);
+
+  unsigned i = 0;
+  for (; i + 16 <= length; i += 16) {
+	__m256i w  = load16x16(weights + i);
+	__m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(w));
+	__m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(w, 1));
+	__m256i *out = (__m256i *)(sums + i);
+	_mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out),
+		_mm256_sub_epi32(_mm256_xor_si256(lo, m), m)));
+	_mm256_storeu_si256(out + 1, _mm256_add_epi32(
+		_mm256_loadu_si256(out + 1),
+		_mm256_sub_epi32(_mm256_xor_si256(hi, m), m)));
+  }
+  accumulateRange(sums, weights, i, length, taken);
+}
+
+AVX512_TARGET static inline __m512i
+load32x16(const int8_t *weights)
+{
+  return _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)weights));
+}
+
+AVX512_TARGET static inline __m512i
+load32x16(const int16_t *weights)
+{
+  return _mm512_loadu_si512((const void *)weights);
+}
+
+AVX512_TARGET static inline void
+store32x16(int8_t *weights, __m512i w)
+{
+  _mm512_mask_cvtsepi16_storeu_epi8((void *)weights, ~(__mmask32)0, w);
+}
+
+AVX512_TARGET static inline void
+store32x16(int16_t *weights, __m512i w)
+{
+  _mm512_storeu_si512((void *)weights, w);
+}
+
+template <typename T>
+AVX512_TARGET static KERNEL_INLINE int32_t
+dotAVX512(const T *weights, const uint64_t *history, unsigned length)
+{
+  const __m512i one  = _mm512_set1_epi16(1);
+  const __m512i neg1 = _mm512_set1_epi16(-1);
+  __m512i acc = _mm512_setzero_si512();
+
+  unsigned i = 0;
+  for (; i + 32 <= length; i += 32) {
+	// the history bits are used directly as the lane mask
+	__mmask32 k  = historyBits(history, i, 32);
+	__m512i sign = _mm512_mask_blend_epi16(k, neg1, one);
+	acc = _mm512_add_epi32(acc,
+						   _mm512_madd_epi16(load32x16(weights + i), sign));
+  }
+
+  int32_t lane_sums[16];
+  _mm512_storeu_si512((void *)lane_sums, acc);
+  int32_t sum = 0;
+  for (unsigned lane = 0; lane < 16; lane++)
+	sum += lane_sums[lane];
+  return sum + dotRange(weights, history, i, length);
+}
+
+template <typename T>
+AVX512_TARGET static KERNEL_INLINE void
+trainAVX512(T *weights, const uint64_t *history, unsigned length,
+			bool taken, int32_t min_weight, int32_t max_weight)
+{
+  const __m512i one  = _mm512_set1_epi16(1);
+  const __m512i neg1 = _mm512_set1_epi16(-1);
+  const __m512i vmin = _mm512_set1_epi16((short)min_weight);
+  const __m512i vmax = _mm512_set1_epi16((short)max_weight);
+
+  unsigned i = 0;
+  for (; i + 32 <= length; i += 32) {
+	__mmask32 k     = historyBits(history, i, 32);
+	__mmask32 agree = taken ? k : ~k;
+	__m512i delta   = _mm512_mask_blend_epi16(agree, neg1, one);
+	__m512i w = _mm512_adds_epi16(load32x16(weights + i), delta);
+	w = _mm512_min_epi16(_mm512_max_epi16(w, vmin), vmax);
+	store32x16(weights + i, w);
+  }
+  trainRange(weights, history, i, length, taken, min_weight, max_weight);
+}
+
+/** Sign-extends 16 weights to 32 bits (maskz avoids undefined lanes). */
+AVX512_TARGET static inline __m512i
+load16x32(const int8_t *weights)
+{
+  return _mm512_maskz_cvtepi8_epi32(~(__mmask16)0,
+	  _mm_loadu_si128((const __m128i *)weights));
+}
+
+AVX512_TARGET static inline __m512i
+load16x32(const int16_t *weights)
+{
+  return _mm512_maskz_cvtepi16_epi32(~(__mmask16)0,
+	  _mm256_loadu_si256((const __m256i *)weights));
+}
+
+template <typename T>
+AVX512_TARGET static void
+accumulateAVX512(int32_t *sums, const T *weights, unsigned length,
+				 bool taken)
+{
+  const __m512i m = _mm512_set1_epi32(taken ? 0 : -1);
+
+  unsigned i = 0;
+  for (; i + 16 <= length; i += 16) {
+	__m512i w = _mm512_sub_epi32(_mm512_xor_si512(load16x32(weights + i), m),
+								 m);
+	_mm512_storeu_si512((void *)(sums + i), _mm512_add_epi32(
+		_mm512_loadu_si512((const void *)(sums + i)), w));
+  }
+  accumulateRange(sums, weights, i, length, taken);
+}
+
+/** Row kernels of the SSE2 implementation for one fixed length. */
+template <unsigned Length, typename T>
+struct FixedSSE2
+{
+  SSE2_TARGET static int32_t
+  dot(const T *weights, const uint64_t *history, unsigned)
+  {
+	return dotSSE2(weights, history, Length);
+  }
+
+  SSE2_TARGET static void
+  train(T *weights, const uint64_t *history, unsigned, bool taken,
+		int32_t min_weight, int32_t max_weight)
+  {
+	trainSSE2(weights, history, Length, taken, min_weight, max_weight);
+  }
+};
+
+/** Row kernels of the AVX2 implementation for one fixed length. */
+template <unsigned Length, typename T>
+struct FixedAVX2
+{
+  AVX2_TARGET static int32_t
+  dot(const T *weights, const uint64_t *history, unsigned)
+  {
+	return dotAVX2(weights, history, Length);
+  }
+
+  AVX2_TARGET static void
+  train(T *weights, const uint64_t *history, unsigned, bool taken,
+		int32_t min_weight, int32_t max_weight)
+  {
+	trainAVX2(weights, history, Length, taken, min_weight, max_weight);
+  }
+};
+
+/** Row kernels of the AVX512 implementation for one fixed length. */
+template <unsigned Length, typename T>
+struct FixedAVX512
+{
+  AVX512_TARGET static int32_t
+  dot(const T *weights, const uint64_t *history, unsigned)
+  {
+	return dotAVX512(weights, history, Length);
+  }
+
+  AVX512_TARGET static void
+  train(T *weights, const uint64_t *history, unsigned, bool taken,
+		int32_t min_weight, int32_t max_weight)
+  {
+	trainAVX512(weights, history, Length, taken, min_weight, max_weight);
+  }
+};
+
+#elif PERCEPTRON_KERNEL_NEON
+
+static inline int16x8_t
+load8x16(const int8_t *weights)
+{
+  return vmovl_s8(vld1_s8(weights));
+}
+
+static inline int16x8_t
+load8x16(const int16_t *weights)
+{
+  return vld1q_s16(weights);
+}
+
+static inline void
+store8x16(int8_t *weights, int16x8_t w)
+{
+  vst1_s8(weights, vqmovn_s16(w));
+}
+
+static inline void
+store8x16(int16_t *weights, int16x8_t w)
+{
+  vst1q_s16(weights, w);
+}
+
+/** -1 in every 16-bit lane whose history bit is clear, 0 elsewhere. */
+static inline int16x8_t
+clearMask8x16(const uint64_t *history, unsigned i)
+{
+  static const uint16_t lane_bits[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+  uint16x8_t bits = vdupq_n_u16(historyBits(history, i, 8));
+  return vreinterpretq_s16_u16(
+	  vceqq_u16(vandq_u16(bits, vld1q_u16(lane_bits)), vdupq_n_u16(0)));
+}
+
+template <typename T>
+static KERNEL_INLINE int32_t
+dotNEON(const T *weights, const uint64_t *history, unsigned length)
+{
+  const int16x8_t one = vdupq_n_s16(1);
+  int32x4_t acc = vdupq_n_s32(0);
+
+  unsigned i = 0;
+  for (; i + 8 <= length; i += 8) {
+	int16x8_t sign = vorrq_s16(clearMask8x16(history, i), one);
+	int16x8_t w    = load8x16(weights + i);
+	acc = vmlal_s16(acc, vget_low_s16(w), vget_low_s16(sign));
+	acc = vmlal_s16(acc, vget_high_s16(w), vget_high_s16(sign));
+  }
+  return vaddvq_s32(acc) + dotRange(weights, history, i, length);
+}
+
+template <typename T>
+static KERNEL_INLINE void
+trainNEON(T *weights, const uint64_t *history, unsigned length, bool taken,
+		  int32_t min_weight, int32_t max_weight)
+{
+  const int16x8_t one  = vdupq_n_s16(1);
+  const int16x8_t dir  = vdupq_n_s16(taken ? 0 : -1);
+  const int16x8_t vmin = vdupq_n_s16(min_weight);
+  const int16x8_t vmax = vdupq_n_s16(max_weight);
+
+  unsigned i = 0;
+  for (; i + 8 <= length; i += 8) {
+	int16x8_t delta = vorrq_s16(
+		veorq_s16(clearMask8x16(history, i), dir), one);
+	int16x8_t w = vqaddq_s16(load8x16(weights + i), delta);
+	w = vminq_s16(vmaxq_s16(w, vmin), vmax);
+	store8x16(weights + i, w);
+  }
+  trainRange(weights, history, i, length, taken, min_weight, max_weight);
+}
+
+template <typename T>
+static void
+accumulateNEON(int32_t *sums, const T *weights, unsigned length, bool taken)
+{
+  unsigned i = 0;
+  for (; i + 8 <= length; i += 8) {
+	int16x8_t w  = load8x16(weights + i);
+	int32x4_t lo = vmovl_s16(vget_low_s16(w));
+	int32x4_t hi = vmovl_s16(vget_high_s16(w));
+	if (!taken) {
+	  lo = vnegq_s32(lo);
+	  hi = vnegq_s32(hi);
+	}
+	vst1q_s32(sums + i, vaddq_s32(vld1q_s32(sums + i), lo));
+	vst1q_s32(sums + i + 4, vaddq_s32(vld1q_s32(sums + i + 4), hi));
+  }
+  accumulateRange(sums, weights, i, length, taken);
+}
+
+/** Row kernels of the NEON implementation for one fixed length. */
+template <unsigned Length, typename T>
+struct FixedNEON
+{
+  static int32_t
+  dot(const T *weights, const uint64_t *history, unsigned)
+  {
+	return dotNEON(weights, history, Length);
+  }
+
+  static void
+  train(T *weights, const uint64_t *history, unsigned, bool taken,
+		int32_t min_weight, int32_t max_weight)
+  {
+	trainNEON(weights, history, Length, taken, min_weight, max_weight);
+  }
+};
+
+#endif
+
+namespace
+{
+  /** Fills in the fixed-length row kernels of an implementation. */
+  template <template <unsigned, typename> class Fixed, typename T>
+  Implementation<T>
+  withFixedLengths(Implementation<T> implementation)
+  {
+	static_assert(numFixedRowLengths == 4,
+				  "one instantiation per fixed row length");
+	implementation.fixed[0] = { Fixed<32, T>::dot, Fixed<32, T>::train,
+								true };
+	implementation.fixed[1] = { Fixed<64, T>::dot, Fixed<64, T>::train,
+								true };
+	implementation.fixed[2] = { Fixed<128, T>::dot, Fixed<128, T>::train,
+								true };
+	implementation.fixed[3] = { Fixed<256, T>::dot, Fixed<256, T>::train,
+								true };
+	return implementation;
+  }
+
+  /** Picks the widest implementation supported by the host CPU. */
+  template <typename T>
+  Implementation<T>
+  selectImplementation()
+  {
+	return hostImplementations<T>().front();
+  }
+
+  const Implementation<int8_t> implementation8 =
+	selectImplementation<int8_t>();
+  const Implementation<int16_t> implementation16 =
+	selectImplementation<int16_t>();
+
+  template <typename T>
+  RowKernels<T>
+  selectRowKernels(const Implementation<T> &implementation,
+				   unsigned length, bool specialize)
+  {
+	for (unsigned i = 0; specialize && i < numFixedRowLengths; i++) {
+	  if (fixedRowLengths[i] == length)
+		return implementation.fixed[i];
+	}
+	return { implementation.dot, implementation.train, false };
+  }
+}
+
+template <typename T>
+std::vector<Implementation<T>>
+hostImplementations()
+{
+  std::vector<Implementation<T>> implementations;
+#if PERCEPTRON_KERNEL_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512bw"))
+	implementations.push_back(withFixedLengths<FixedAVX512>(
+		Implementation<T>{ "avx512", dotAVX512<T>, trainAVX512<T>,
+						   accumulateAVX512<T> }));
+  if (__builtin_cpu_supports("avx2"))
+	implementations.push_back(withFixedLengths<FixedAVX2>(
+		Implementation<T>{ "avx2", dotAVX2<T>, trainAVX2<T>,
+						   accumulateAVX2<T> }));
+  if (__builtin_cpu_supports("sse2"))
+	implementations.push_back(withFixedLengths<FixedSSE2>(
+		Implementation<T>{ "sse2", dotSSE2<T>, trainSSE2<T>,
+						   accumulateSSE2<T> }));
+#elif PERCEPTRON_KERNEL_NEON
+  implementations.push_back(withFixedLengths<FixedNEON>(
+	  Implementation<T>{ "neon", dotNEON<T>, trainNEON<T>,
+						 accumulateNEON<T> }));
+#endif
+  implementations.push_back(withFixedLengths<FixedReference>(
+	  Implementation<T>{ "scalar", dotReference<T>, trainReference<T>,
+						 accumulateReference<T> }));
+  return implementations;
+}
+
+template std::vector<Implementation<int8_t>>
+hostImplementations<int8_t>();
+template std::vector<Implementation<int16_t>>
+hostImplementations<int16_t>();
+
+template <>
+RowKernels<int8_t>
+rowKernels<int8_t>(unsigned length, bool specialize)
+{
+  return selectRowKernels(implementation8, length, specialize);
+}
+
+template <>
+RowKernels<int16_t>
+rowKernels<int16_t>(unsigned length, bool specialize)
+{
+  return selectRowKernels(implementation16, length, specialize);
+}
+
+int32_t
+dot(const int8_t *weights, const uint64_t *history, unsigned length)
+{
+  return implementation8.dot(weights, history, length);
+}
+
+int32_t
+dot(const int16_t *weights, const uint64_t *history, unsigned length)
+{
+  return implementation16.dot(weights, history, length);
+}
+
+void
+train(int8_t *weights, const uint64_t *history, unsigned length,
+	  bool taken, int32_t min_weight, int32_t max_weight)
+{
+  implementation8.train(weights, history, length, taken,
+						min_weight, max_weight);
+}
+
+void
+train(int16_t *weights, const uint64_t *history, unsigned length,
+	  bool taken, int32_t min_weight, int32_t max_weight)
+{
+  implementation16.train(weights, history, length, taken,
+						 min_weight, max_weight);
+}
+
+void
+accumulate(int32_t *sums, const int8_t *weights, unsigned length,
+		   bool taken)
+{
+  implementation8.accumulate(sums, weights, length, taken);
+}
+
+void
+accumulate(int32_t *sums, const int16_t *weights, unsigned length,
+		   bool taken)
+{
+  implementation16.accumulate(sums, weights, length, taken);
+}
+
+const char *
+isaName()
+{
+  return implementation16.name;
+}
+
+} // namespace PerceptronKernel
@@ -0,0 +1,146 @@
+/*****************************************************************
+ * File: perceptron_kernel.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Branch-free signed dot product and training kernels
+ * shared by the neural branch predictors. Each history bit is
+ * expanded into a +1/-1 mask and applied to one perceptron row;
+ * the vector implementation is chosen at runtime from the CPU
+ * features of the host, with the scalar loop kept as reference,
+ * and compiled again for the common row lengths.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_PERCEPTRON_KERNEL_HH__
+#define __CPU_PRED_PERCEPTRON_KERNEL_HH__
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace PerceptronKernel
+{
+  /**
+   * Computes sum_i (history bit i ? weights[i] : -weights[i]) over the
+   * first length weights of a perceptron row (bias excluded). The sum
+   * is accumulated in 32 bits whatever the storage width of the row.
+   * @param weights First non-bias weight of the perceptron row.
+   * @param history History register, bit i of the array is paired
+   * with weights[i]; must hold at least length bits.
+   * @param length Number of weights/history bits to accumulate.
+   * @return The signed weighted sum.
+   */
+  int32_t dot(const int8_t *weights, const uint64_t *history,
+			  unsigned length);
+  int32_t dot(const int16_t *weights, const uint64_t *history,
+			  unsigned length);
+
+  /**
+   * Trains a perceptron row towards the outcome: every weight whose
+   * history bit agrees with taken is incremented, the rest decremented,
+   * saturating at [min_weight, max_weight].
+   * @param weights First non-bias weight of the perceptron row.
+   * @param history History register paired with the row.
+   * @param length Number of weights/history bits to train.
+   * @param taken The resolved direction of the branch.
+   * @param min_weight Smallest representable weight.
+   * @param max_weight Largest representable weight.
+   */
+  void train(int8_t *weights, const uint64_t *history, unsigned length,
+			 bool taken, int32_t min_weight, int32_t max_weight);
+  void train(int16_t *weights, const uint64_t *history, unsigned length,
+			 bool taken, int32_t min_weight, int32_t max_weight);
+
+  /**
+   * Adds a perceptron row into a vector of running sums: sums[i] gets
+   * weights[i] when taken and -weights[i] otherwise.
+   * @param sums Running sums, one per weight.
+   * @param weights First weight to add.
+   * @param length Number of sums/weights.
+   * @param taken Direction deciding the sign of the weights.
+   */
+  void accumulate(int32_t *sums, const int8_t *weights, unsigned length,
+				  bool taken);
+  void accumulate(int32_t *sums, const int16_t *weights, unsigned length,
+				  bool taken);
+
+  /** Reference implementations, always available. */
+  int32_t dotScalar(const int8_t *weights, const uint64_t *history,
+					unsigned length);
+  int32_t dotScalar(const int16_t *weights, const uint64_t *history,
+					unsigned length);
+  void trainScalar(int8_t *weights, const uint64_t *history,
+				   unsigned length, bool taken,
+		   int32_t min_weight, int32_t max_weight);
+  void trainScalar(int16_t *weights, const uint64_t *history,
+				   unsigned length, bool taken,
+		   int32_t min_weight, int32_t max_weight);
+  void accumulateScalar(int32_t *sums, const int8_t *weights,
+						unsigned length, bool taken);
+  void accumulateScalar(int32_t *sums, const int16_t *weights,
+						unsigned length, bool taken);
+
+  /** Row lengths the fixed-length row kernels are compiled for. */
+  const unsigned fixedRowLengths[] = { 32, 64, 128, 256 };
+  const unsigned numFixedRowLengths = 4;
+
+  /**
+   * Dot product and training kernels for rows of one length, taking
+   * the same arguments as dot() and train(). For the fixedRowLengths
+   * the kernels are compiled with that length as a constant, so their
+   * loops are unrolled and the scalar tails dropped; they must then
+   * only be passed the length they were selected for.
+   */
+  template <typename T>
+  struct RowKernels {
+	int32_t (*dot)(const T *weights, const uint64_t *history,
+				   unsigned length);
+	void (*train)(T *weights, const uint64_t *history, unsigned length,
+				  bool taken, int32_t min_weight, int32_t max_weight);
+	/** Set when the kernels are compiled for a fixed length */
+	bool fixedLength;
+  };
+
+  /**
+   * Picks the row kernels of the host implementation for a length.
+   * @param length Weights per row the kernels will be given.
+   * @param specialize Whether a fixed-length version may be picked;
+   * the generic kernels are returned otherwise, or when the length
+   * is none of the fixedRowLengths.
+   */
+  template <typename T>
+  RowKernels<T> rowKernels(unsigned length, bool specialize);
+
+  /**
+   * The kernels of one implementation, taking the same arguments as
+   * dot(), train() and accumulate(), and its row kernels compiled for
+   * each of the fixedRowLengths.
+   */
+  template <typename T>
+  struct Implementation {
+	typedef int32_t (*DotFn)(const T *, const uint64_t *, unsigned);
+	typedef void (*TrainFn)(T *, const uint64_t *, unsigned, bool,
+							int32_t, int32_t);
+	typedef void (*AccumulateFn)(int32_t *, const T *, unsigned, bool);
+
+	const char *name;
+	DotFn dot;
+	TrainFn train;
+	AccumulateFn accumulate;
+
+	/** Row kernels compiled for each of the fixedRowLengths */
+	RowKernels<T> fixed[numFixedRowLengths];
+  };
+
+  /**
+   * Lists the implementations compiled in that the host CPU supports,
+   * widest first and the scalar reference last; dot(), train(),
+   * accumulate() and rowKernels() use the first one.
+   */
+  template <typename T>
+  std::vector<Implementation<T>> hostImplementations();
+
+  /** Name of the implementation selected for this host. */
+  const char *isaName();
+}
+
+#endif // __CPU_PRED_PERCEPTRON_KERNEL_HH__
@@ -7,11 +7,103 @@ the default ones packaged in the gem5 environment with the custom ones
 """
 
 import argparse
+import collections
+import os
+import time
 
 import m5
 from m5.objects import *
 
-def simulate_BP(predictor, executable):
+# exit cause of the instruction counts ending a sample or a fast-forward
+SAMPLE_CAUSE = "sample boundary"
+
+# counters of the detailed samples summed, in the output directory
+SAMPLES_FILE = "stats_samples.txt"
+
+# integer stats of a dump that are not counts over its sample and so are
+# not summed: the tick the sample ended at, the tick frequency, the host
+# rates and memory usage, and the extremes of the distributions
+UNSUMMED_STATS = ("final_tick", "sim_freq")
+UNSUMMED_PREFIXES = ("host_",)
+UNSUMMED_SUFFIXES = ("::min_value", "::max_value")
+
+def sample_simulation(system, atomic, detailed, fast_forward, interval,
+                      length, samples):
+    """
+    Runs the workload fast-forwarded on the atomic CPU, which still trains
+    the branch predictor it shares with the detailed CPU, switching to the
+    detailed CPU for a sample of length instructions every interval
+    instructions after the first fast_forward. The stats are reset at the
+    start of every sample and dumped at its end, so each sample has a dump
+    of its own in stats.txt
+    @param samples Samples to take before stopping, 0 to run to the end
+    @return (exit event of the simulation, number of samples dumped)
+    """
+    exit_event = None
+    if fast_forward:
+        atomic.scheduleInstStop(0, fast_forward, SAMPLE_CAUSE)
+        exit_event = m5.simulate()
+
+    taken = 0
+    while exit_event is None or exit_event.getCause() == SAMPLE_CAUSE:
+        m5.switchCpus(system, [(atomic, detailed)])
+        m5.stats.reset()
+        detailed.scheduleInstStop(0, length, SAMPLE_CAUSE)
+        exit_event = m5.simulate()
+        m5.stats.dump()
+        taken += 1
+        if exit_event.getCause() != SAMPLE_CAUSE or taken == samples:
+            break
+
+        m5.switchCpus(system, [(detailed, atomic)])
+        atomic.scheduleInstStop(0, interval - length, SAMPLE_CAUSE)
+        exit_event = m5.simulate()
+    return exit_event, taken
+
+def aggregate_samples(stats_file, samples, samples_file, host_seconds):
+    """
+    Sums the integer stats of the first samples dumps of a stats file into
+    a dump of their own, read as stats.txt is. samples_file then holds
+    num_samples, the number of dumps summed; every counter of the detailed
+    CPU and predictor (condIncorrect, sim_insts, sim_ticks, the samples
+    and buckets of the distributions...) summed over the samples; and
+    host_seconds. Ratios and other real-valued stats are left out as they
+    do not add up, and so are the integer stats of UNSUMMED_STATS,
+    UNSUMMED_PREFIXES and UNSUMMED_SUFFIXES, which are not counts
+    @param host_seconds Wall-clock time of the whole run, fast-forwarding
+    included, written as host_seconds
+    """
+    totals = collections.OrderedDict()
+    dumps = 0
+    with open(stats_file, "r") as f:
+        for line in f:
+            if line.startswith("---------- Begin Simulation Statistics"):
+                dumps += 1
+                if dumps > samples:
+                    break
+                continue
+            fields = line.split()
+            if dumps == 0 or len(fields) < 2 or \
+                    not fields[1].lstrip("-").isdigit():
+                continue
+            if fields[0] in UNSUMMED_STATS or \
+                    fields[0].startswith(UNSUMMED_PREFIXES) or \
+                    fields[0].endswith(UNSUMMED_SUFFIXES):
+                continue
+            totals[fields[0]] = totals.get(fields[0], 0) + int(fields[1])
+
+    with open(samples_file, "w") as f:
+        f.write("\n---------- Begin Simulation Statistics ----------\n")
+        f.write("{:<50} {:>12} # Detailed samples summed\n".format(
+            "num_samples", min(dumps, samples)))
+        for name, value in totals.items():
+            f.write("{:<50} {:>12}\n".format(name, value))
+        f.write("{:<50} {:>12.2f} # Wall-clock seconds of the run\n".format(
+            "host_seconds", host_seconds))
+        f.write("\n---------- End Simulation Statistics   ----------\n")
+
+def simulate_BP(predictor, executable, profile=0, fast_forward=0,
+                interval=0, length=0, samples=0):
     """
     Given ints corresponding to the branch predictor to use in the gem5
     environment in addition to the executable to test on, runs the
@@ -20,8 +112,16 @@ def simulate_BP(predictor, executable):
     by the executable
     @param predictor The address of the branch to look up.
     @param bp_history Pointer to any bp history state.
+    @param profile Slots of the per-PC branch profile the neural predictors
+    write to branch_profile.csv in the output directory, 0 for none
+    @param fast_forward, interval, length, samples Sampled simulation (see
+    sample_simulation) when length is set, the counters of the samples
+    being summed into stats_samples.txt; the whole run is simulated in
+    detail otherwise
     @return void
     """
+    start = time.time()
+    sampled = length > 0
 
     # create the system we are going to simulate
     system = System()
@@ -31,14 +131,18 @@ def simulate_BP(predictor, executable):
     system.clk_domain.clock = '1GHz'
     system.clk_domain.voltage_domain = VoltageDomain()
 
-    # Set up the system
-    system.mem_mode = 'timing'               # Use timing accesses
+    # Set up the system, starting with atomic accesses when sampling
+    system.mem_mode = 'atomic' if sampled else 'timing'
     system.mem_ranges = [AddrRange('8192MB')] # Create an address range
 
-    # Create a simple CPU
-    system.cpu = TimingSimpleCPU()
+    # Create a simple CPU, which fast-forwards between samples
+    system.cpu = AtomicSimpleCPU(cpu_id=0) if sampled else TimingSimpleCPU()
 
     # --------------------------- Main Alteration ---------------------------- #
+    # the neural predictors profile their branches into the output directory
+    # (settings.PROFILE_FILE, read back by accuracy.py --hot)
+    profiled = dict(profileSize=profile, profileFile="branch_profile.csv")
+
     # default branch predictors of the gem5 simulator ecosystem
     branchPredictors = [
         LocalBP(),      # simple local history branch predictor
@@ -46,8 +150,10 @@ def simulate_BP(predictor, executable):
         BiModeBP(),     # 2-bit history mode predictor
         LTAGE(),        # often best-performing current mainstream predictor
         AlwaysBP(),     # always true branch predictor (static)
-        NeuroBP(),      # single perceptron neural branch predictor
-        NeuroPathBP()   # neural path branch predictor
+        NeuroBP(**profiled),       # single perceptron neural predictor
+        NeuroPathBP(**profiled),   # neural path branch predictor
+        HashedNeuroBP(**profiled), # PC/history-segment hashed predictor
+        HybridNeuroBP(perceptron=NeuroBP(**profiled)) # bimodal + NeuroBP
     ]
 
     system.cpu.branchPred = branchPredictors[predictor]
@@ -112,6 +218,15 @@ def simulate_BP(predictor, executable):
     system.cpu.workload = process
     system.cpu.createThreads()
 
+    # the detailed CPU of the samples waits switched out, taking over the
+    # ports, interrupts and thread of the atomic CPU at every sample; it
+    # uses the same branch predictor, warm from the fast-forward
+    if sampled:
+        system.detailed_cpu = TimingSimpleCPU(cpu_id=0, switched_out=True)
+        system.detailed_cpu.branchPred = system.cpu.branchPred
+        system.detailed_cpu.workload = process
+        system.detailed_cpu.createThreads()
+
     # set up the root SimObject and start the simulation
     root = Root(full_system = False, system = system)
 
@@ -119,7 +234,15 @@ def simulate_BP(predictor, executable):
     m5.instantiate()
 
     print "Beginning simulation!"
-    exit_event = m5.simulate()
+    if not sampled:
+        exit_event = m5.simulate()
+    else:
+        exit_event, taken = sample_simulation(system, system.cpu,
+            system.detailed_cpu, fast_forward, interval, length, samples)
+        aggregate_samples(os.path.join(m5.options.outdir, "stats.txt"),
+            taken, os.path.join(m5.options.outdir, SAMPLES_FILE),
+            time.time() - start)
+        print "Summed %i samples into %s" % (taken, SAMPLES_FILE)
     print 'Exiting @ tick %i because %s' % (m5.curTick(), exit_event.getCause())
 
 # --------------------------- Runs simulation ---------------------------- #
@@ -143,5 +266,29 @@ parser.add_argument('--exec', metavar='exec', type=int,
 """
 )
 
+parser.add_argument('--profile', metavar='slots', type=int, default=0,
+                    help="""slots of the per-PC branch profile the neural
+                    predictors write to branch_profile.csv in the output
+                    directory (0, no profile)""")
+
+parser.add_argument('--fast-forward', metavar='insts', type=int, default=0,
+                    help="""instructions run on the atomic CPU, training the
+                    branch predictor, before the first sample""")
+parser.add_argument('--sample-length', metavar='insts', type=int,
+                    default=0, help="""instructions of every sample run on
+                    the detailed CPU (0, simulate the whole run in detail)""")
+parser.add_argument('--sample-interval', metavar='insts', type=int,
+                    default=0, help="""instructions from the start of a
+                    sample to the start of the next, above the sample
+                    length""")
+parser.add_argument('--samples', metavar='count', type=int, default=0,
+                    help="""samples to take before stopping (0, sample to the
+                    end of the workload)""")
+
 args = parser.parse_args()
-simulate_BP(predictor=vars(args)["pred"], executable=vars(args)["exec"])
+if args.sample_length and args.sample_interval <= args.sample_length:
+    parser.error("--sample-interval must exceed --sample-length")
+simulate_BP(predictor=vars(args)["pred"], executable=vars(args)["exec"],
+            profile=vars(args)["profile"], fast_forward=args.fast_forward,
+            interval=args.sample_interval, length=args.sample_length,
+            samples=args.samples)
@@ -0,0 +1,274 @@
+/*****************************************************************
+ * File: bench.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Google Benchmark microbenchmarks of the predictor
+ * hot paths (lookup, update, squash, uncondBranch and the path
+ * update of NeuroPathBP) across predictors, history lengths,
+ * table sizes and SMT thread counts, over a synthetic branch
+ * stream and a slice of a trace. --benchmark_out=file.json
+ * --benchmark_out_format=json writes results that compare across
+ * commits with the compare.py tool of Google Benchmark.
+ ****************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "branch_trace.hh"
+#include "cpu/pred/history_follower.hh"
+#include "cpu/pred/perceptron_kernel.hh"
+#include "predictor_factory.hh"
+
+namespace
+{
+  /** Branches one iteration works on, i.e. the branches in flight
+   *  between their prediction and their update or squash. */
+  const unsigned batchSize = 64;
+
+  /** Branches of the synthetic stream, and at most of the trace. */
+  const size_t streamBranches = 1 << 16;
+
+  /** Addresses and outcomes of the branches fed to the predictors. */
+  struct BranchStream
+  {
+	std::vector<Addr> pcs;
+	std::vector<uint8_t> taken;
+
+	size_t size() const { return pcs.size(); }
+  };
+
+  /**
+   * A deterministic stream of 1024 static branches, each strongly
+   * biased one way (90%) or following a short loop pattern, visited
+   * in a random order: enough hard branches to keep the training
+   * paths busy and enough easy ones to leave the threshold test in
+   * play.
+   */
+  BranchStream
+  syntheticStream()
+  {
+	BranchStream stream;
+	uint64_t state = 0x9e3779b97f4a7c15ULL;
+	auto next = [&state]() {
+	  // xorshift64*
+	  state ^= state >> 12;
+	  state ^= state << 25;
+	  state ^= state >> 27;
+	  return state * 0x2545f4914f6cdd1dULL;
+	};
+
+	std::vector<unsigned> visits(1024, 0);
+	for (size_t i = 0; i < streamBranches; i++) {
+	  unsigned branch = next() % visits.size();
+	  bool taken;
+	  if (branch % 4 == 0)
+		taken = visits[branch] % 8 != 7;
+	  else
+		taken = (next() % 10 < 9) == (branch % 2 == 0);
+	  visits[branch]++;
+	  stream.pcs.push_back(0x400000 + 4 * branch);
+	  stream.taken.push_back(taken);
+	}
+	return stream;
+  }
+
+  /** The first streamBranches branches of a trace. */
+  BranchStream
+  traceStream(const BranchTrace &trace)
+  {
+	BranchStream stream;
+	for (size_t i = 0; i < trace.size() && i < streamBranches; i++) {
+	  stream.pcs.push_back(trace.pc(i));
+	  stream.taken.push_back(trace.taken(i));
+	}
+	return stream;
+  }
+
+  enum HotPath { Lookup, Update, Squash, UncondBranch, UpdatePath };
+
+  const char *hotPathNames[] = { "lookup", "update", "squash",
+								 "uncondBranch", "updatePath" };
+
+  /** One predictor configuration benchmarked. */
+  struct Config
+  {
+	std::string predictor;
+	std::vector<std::string> overrides;
+	unsigned threads;
+  };
+
+  /**
+   * Times one hot path over batches of batchSize branches, the other
+   * calls every batch needs (e.g. the lookups an update resolves)
+   * running with the timer paused. The branches of a batch go to one
+   * thread, the threads taking turns batch by batch. UpdatePath times
+   * the path and history steps of a HistoryFollower alone: every
+   * branch is recorded with recordBranch() and committed by update(),
+   * which for NeuroPathBP steps the speculative sums and path forward
+   * and pushes the branch onto the committed path, with no output
+   * computed or trained on.
+   */
+  void
+  runHotPath(benchmark::State &state, const Config &config,
+			 const BranchStream &stream, HotPath path)
+  {
+	std::vector<std::string> overrides = config.overrides;
+	overrides.push_back("numThreads=" + std::to_string(config.threads));
+	std::unique_ptr<BPredUnit> bp(createPredictor(config.predictor,
+												  overrides));
+	for (BPredUnit *object : simObjects(*bp))
+	  object->init();
+
+	// train on the stream once so the weights are not all zero
+	for (ThreadID tid = 0; tid < config.threads; tid++) {
+	  for (size_t i = 0; i < stream.size(); i++) {
+		void *history = NULL;
+		bp->lookup(tid, stream.pcs[i], history);
+		bp->update(tid, stream.pcs[i], stream.taken[i], history, false);
+	  }
+	}
+
+	HistoryFollower *follower = dynamic_cast<HistoryFollower *>(bp.get());
+	assert(path != UpdatePath || follower);
+
+	std::vector<void *> histories(batchSize);
+	size_t first = 0;
+	ThreadID tid = 0;
+	bool timed_predict = path != Update && path != Squash;
+	bool timed_resolve = path != Lookup && path != UncondBranch;
+	for (auto _ : state) {
+	  if (!timed_predict)
+		state.PauseTiming();
+	  for (unsigned i = 0; i < batchSize; i++) {
+		if (path == UncondBranch) {
+		  bp->uncondBranch(tid, stream.pcs[first + i], histories[i]);
+		} else if (path == UpdatePath) {
+		  follower->recordBranch(tid, stream.pcs[first + i],
+								 stream.taken[first + i], histories[i]);
+		} else {
+		  bp->lookup(tid, stream.pcs[first + i], histories[i]);
+		}
+	  }
+	  if (!timed_resolve)
+		state.PauseTiming();
+	  else if (!timed_predict)
+		state.ResumeTiming();
+
+	  if (path == Squash) {
+		// youngest first, as the CPU squashes them
+		for (unsigned i = batchSize; i-- > 0; )
+		  bp->squash(tid, histories[i]);
+	  } else {
+		for (unsigned i = 0; i < batchSize; i++) {
+		  bp->update(tid, stream.pcs[first + i], stream.taken[first + i],
+					 histories[i], false);
+		}
+	  }
+	  if (!timed_resolve)
+		state.ResumeTiming();
+
+	  benchmark::ClobberMemory();
+	  first += batchSize;
+	  if (first + batchSize > stream.size())
+		first = 0;
+	  tid = (tid + 1) % config.threads;
+	}
+	state.SetItemsProcessed(state.iterations() * batchSize);
+  }
+
+  /** The configurations of every predictor benchmarked. */
+  std::vector<Config>
+  configs()
+  {
+	std::vector<Config> result;
+	for (unsigned threads : { 1, 2 }) {
+	  result.push_back(Config{ "AlwaysBP", {}, threads });
+	  for (unsigned history : { 16, 64, 256 }) {
+		std::string h = "historyLength=" + std::to_string(history);
+		for (unsigned rows : { 64, 1024 }) {
+		  std::string n = "numPerceptrons=" + std::to_string(rows);
+		  result.push_back(Config{ "NeuroBP", { h, n }, threads });
+		  result.push_back(Config{ "NeuroPathBP", { h, n }, threads });
+		}
+		for (unsigned log_size : { 8, 12 }) {
+		  std::string t = "logTableSize=" + std::to_string(log_size);
+		  result.push_back(Config{ "HashedNeuroBP", { h, t }, threads });
+		}
+		result.push_back(Config{ "HybridNeuroBP", { "perceptron." + h },
+								 threads });
+	  }
+	}
+	return result;
+  }
+
+  /** e.g. lookup/NeuroBP/historyLength:64/numPerceptrons:64/threads:1 */
+  std::string
+  benchmarkName(const char *path, const Config &config,
+				const std::string &stream)
+  {
+	std::string name = std::string(path) + "/" + config.predictor;
+	for (std::string o : config.overrides)
+	  name += "/" + o.replace(o.find('='), 1, ":");
+	return name + "/threads:" + std::to_string(config.threads) + "/" +
+	  stream;
+  }
+}
+
+int
+main(int argc, char **argv)
+{
+  benchmark::Initialize(&argc, argv);
+
+  std::string trace_path = "../../static/data/gcc-1K.trace";
+  for (int i = 1; i < argc; i++) {
+	if (!strncmp(argv[i], "--trace=", 8)) {
+	  trace_path = argv[i] + 8;
+	} else {
+	  fprintf(stderr, "usage: %s [--trace=file] [benchmark flags]\n"
+			  "  --trace  text or .npbt trace sliced into the trace "
+			  "stream\n          (default %s)\n", argv[0],
+			  trace_path.c_str());
+	  return 1;
+	}
+  }
+
+  // streams live until the benchmarks have run
+  std::vector<std::pair<std::string, BranchStream>> streams;
+  streams.emplace_back("synthetic", syntheticStream());
+  BranchTrace trace;
+  if (trace.load(trace_path) && trace.size() > batchSize) {
+	streams.emplace_back("trace", traceStream(trace));
+  } else {
+	fprintf(stderr, "warning: cannot read %s, only the synthetic stream "
+			"is benchmarked\n", trace_path.c_str());
+  }
+
+  benchmark::AddCustomContext("kernelIsa", PerceptronKernel::isaName());
+  benchmark::AddCustomContext("trace", trace_path);
+
+  for (const auto &stream : streams) {
+	const BranchStream *branches = &stream.second;
+	for (const Config &config : configs()) {
+	  for (HotPath path : { Lookup, Update, Squash, UncondBranch,
+							UpdatePath }) {
+		if (path == UpdatePath && config.predictor != "NeuroPathBP")
+		  continue;
+		benchmark::RegisterBenchmark(
+			benchmarkName(hotPathNames[path], config, stream.first).c_str(),
+			[config, branches, path](benchmark::State &state) {
+			  runHotPath(state, config, *branches, path);
+			});
+	  }
+	}
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,269 @@
+/*****************************************************************
+ * File: branch_trace.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Branch records of an instruction trace, kept as
+ * columns (one array per field) so the replay loop only streams
+ * through the fields it needs.
+ ****************************************************************/
+
+#include "branch_trace.hh"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "base/misc.hh"
+#include "trace_format.hh"
+
+// columns of the text trace format, as in static/settings.py
+enum TextField {
+  UOP = 0, PC, SRC1, SRC2, DEST, FLAGS, BRANCH, LD, IMM, MEMADDR,
+  FALLTHROUGH, TARGET, MACRO, MICRO, NumTextFields
+};
+
+BranchTrace::BranchTrace()
+  : count(0), totalInsts(0), pcs(NULL), targets(NULL),
+	fallthroughs(NULL), flags(NULL), kinds(NULL), instDeltas(NULL),
+	mapping(NULL), mappingSize(0)
+{ }
+
+BranchTrace::~BranchTrace()
+{
+  reset();
+}
+
+void
+BranchTrace::reset()
+{
+  if (mapping)
+	munmap(mapping, mappingSize);
+  mapping = NULL;
+  mappingSize = 0;
+
+  ownedPcs.clear();
+  ownedTargets.clear();
+  ownedFallthroughs.clear();
+  ownedFlags.clear();
+  ownedKinds.clear();
+  ownedInstDeltas.clear();
+  totalInsts = 0;
+  bindOwned();
+}
+
+void
+BranchTrace::bindOwned()
+{
+  count        = ownedPcs.size();
+  pcs          = ownedPcs.data();
+  targets      = ownedTargets.data();
+  fallthroughs = ownedFallthroughs.data();
+  flags        = ownedFlags.data();
+  kinds        = ownedKinds.data();
+  instDeltas   = ownedInstDeltas.data();
+}
+
+/** Classifies a branch from its flags, macro op and micro op fields. */
+static BranchKind
+classify(const char *flags, const char *macro, const char *micro)
+{
+  if (strcmp(flags, "R") == 0)
+	return CondBranch;
+  bool indirect = strcmp(micro, "JMP_REG") == 0;
+  if (strcmp(macro, "RET") == 0)
+	return Return;
+  if (strcmp(macro, "CALL") == 0)
+	return indirect ? IndirectCall : DirectCall;
+  return indirect ? IndirectJump : DirectJump;
+}
+
+bool
+BranchTrace::loadText(const std::string &path, size_t max_branches)
+{
+  FILE *file = fopen(path.c_str(), "r");
+  if (!file)
+	return false;
+
+  reset();
+
+  char line[512];
+  uint32_t insts = 0;
+  while (fgets(line, sizeof(line), file)) {
+	char *field[NumTextFields];
+	unsigned n = 0;
+	for (char *tok = strtok(line, " \t\r\n"); tok && n < NumTextFields;
+		 tok = strtok(NULL, " \t\r\n"))
+	  field[n++] = tok;
+	if (n < NumTextFields)
+	  continue;
+
+	// a uop number of 1 starts a new macro instruction
+	if (strcmp(field[UOP], "1") == 0)
+	  insts++;
+
+	if (strcmp(field[BRANCH], "-") == 0)
+	  continue;
+
+	ownedPcs.push_back(strtoull(field[PC], NULL, 16));
+	ownedTargets.push_back(strtoull(field[TARGET], NULL, 16));
+	ownedFallthroughs.push_back(strtoull(field[FALLTHROUGH], NULL, 16));
+	ownedFlags.push_back(strcmp(field[BRANCH], "T") == 0 ? TakenFlag : 0);
+	ownedKinds.push_back(classify(field[FLAGS], field[MACRO],
+								  field[MICRO]));
+	ownedInstDeltas.push_back(insts);
+	totalInsts += insts;
+	insts = 0;
+
+	if (max_branches && ownedPcs.size() == max_branches)
+	  break;
+  }
+  // instructions after the last branch still count towards the trace
+  totalInsts += insts;
+  fclose(file);
+
+  bindOwned();
+  return true;
+}
+
+bool
+BranchTrace::load(const std::string &path, size_t max_branches)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+	return false;
+  char magic[sizeof(TraceFormat::magic)];
+  bool binary = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+	memcmp(magic, TraceFormat::magic, sizeof(magic)) == 0;
+  fclose(file);
+
+  return binary ? loadBinary(path, max_branches) :
+	loadText(path, max_branches);
+}
+
+void
+BranchTrace::appendBlock(const uint8_t *block, size_t records, size_t limit)
+{
+  size_t n = records < limit ? records : limit;
+  const uint64_t *pc = (const uint64_t *)block;
+  const uint64_t *target = pc + records;
+  const uint64_t *fallthrough = target + records;
+  const uint32_t *delta = (const uint32_t *)(fallthrough + records);
+  const uint8_t *flag = (const uint8_t *)(delta + records);
+  const uint8_t *kind = flag + records;
+
+  ownedPcs.insert(ownedPcs.end(), pc, pc + n);
+  ownedTargets.insert(ownedTargets.end(), target, target + n);
+  ownedFallthroughs.insert(ownedFallthroughs.end(), fallthrough,
+						   fallthrough + n);
+  ownedInstDeltas.insert(ownedInstDeltas.end(), delta, delta + n);
+  ownedFlags.insert(ownedFlags.end(), flag, flag + n);
+  ownedKinds.insert(ownedKinds.end(), kind, kind + n);
+  for (size_t i = 0; i < n; i++)
+	totalInsts += delta[i];
+}
+
+bool
+BranchTrace::loadBinary(const std::string &path, size_t max_branches)
+{
+  using namespace TraceFormat;
+
+  reset();
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+	return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Header)) {
+	close(fd);
+	return false;
+  }
+  void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED)
+	return false;
+  mapping = base;
+  mappingSize = st.st_size;
+
+  const uint8_t *file = (const uint8_t *)base;
+  const Header *header = (const Header *)file;
+  if (memcmp(header->magic, magic, sizeof(magic)) != 0 ||
+	  header->version != version ||
+	  header->indexOffset + header->numBlocks * sizeof(IndexEntry) >
+	  mappingSize) {
+	reset();
+	return false;
+  }
+  bool compressed = header->flags & flagZlib;
+  const IndexEntry *index = (const IndexEntry *)(file + header->indexOffset);
+  for (uint32_t b = 0; b < header->numBlocks; b++) {
+	if (index[b].offset + index[b].storedSize > mappingSize ||
+		(!compressed &&
+		 index[b].storedSize < index[b].records * recordBytes)) {
+	  reset();
+	  return false;
+	}
+  }
+
+  size_t limit = max_branches ? max_branches : header->branches;
+
+  if (!compressed && header->numBlocks == 1) {
+	// the columns are used straight from the mapping
+	size_t records = index[0].records;
+	const uint8_t *block = file + index[0].offset;
+	count        = records < limit ? records : limit;
+	pcs          = (const uint64_t *)block;
+	targets      = pcs + records;
+	fallthroughs = targets + records;
+	instDeltas   = (const uint32_t *)(fallthroughs + records);
+	flags        = (const uint8_t *)(instDeltas + records);
+	kinds        = flags + records;
+	totalInsts   = header->instructions;
+	if (count < records) {
+	  totalInsts = 0;
+	  for (size_t i = 0; i < count; i++)
+		totalInsts += instDeltas[i];
+	}
+	return true;
+  }
+
+  std::vector<uint8_t> inflated;
+  for (uint32_t b = 0; b < header->numBlocks && ownedPcs.size() < limit;
+	   b++) {
+	const uint8_t *block = file + index[b].offset;
+	size_t records = index[b].records;
+	if (compressed) {
+#if HAVE_ZLIB
+	  uLongf raw_size = records * recordBytes;
+	  inflated.resize(raw_size);
+	  if (uncompress(inflated.data(), &raw_size, block,
+					 index[b].storedSize) != Z_OK ||
+		  raw_size != records * recordBytes) {
+		reset();
+		return false;
+	  }
+	  block = inflated.data();
+#else
+	  fatal("%s is compressed, rebuild the replay with zlib!\n",
+			path.c_str());
+#endif
+	}
+	appendBlock(block, records, limit - ownedPcs.size());
+  }
+  // a complete trace also counts the instructions after its last branch
+  if (ownedPcs.size() == header->branches)
+	totalInsts = header->instructions;
+
+  munmap(mapping, mappingSize);
+  mapping = NULL;
+  mappingSize = 0;
+  bindOwned();
+  return true;
+}
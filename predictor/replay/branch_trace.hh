@@ -0,0 +1,125 @@
+/*****************************************************************
+ * File: branch_trace.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Branch records of an instruction trace, kept as
+ * columns (one array per field) so the replay loop only streams
+ * through the fields it needs: header file.
+ ****************************************************************/
+
+#ifndef __REPLAY_BRANCH_TRACE_HH__
+#define __REPLAY_BRANCH_TRACE_HH__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+/** Kind of control transfer of a branch record. */
+enum BranchKind {
+  CondBranch = 0,  // conditional direct jump (reads the flags)
+  DirectJump,      // unconditional jump to an immediate target
+  DirectCall,      // call to an immediate target
+  IndirectJump,    // unconditional jump through a register
+  IndirectCall,    // call through a register
+  Return,          // return
+  NumBranchKinds
+};
+
+class BranchTrace
+{
+public:
+  BranchTrace();
+  ~BranchTrace();
+
+  /**
+   * Reads a trace, binary (.npbt, see trace_format.hh) or text
+   * depending on its first bytes.
+   * @param path Trace file to read.
+   * @param max_branches Stop after this many branches (0 for all).
+   * @return Whether the file could be read.
+   */
+  bool load(const std::string &path, size_t max_branches = 0);
+
+  /**
+   * Reads the branches of a text trace in the static/data format
+   * (whitespace separated: uop, pc, src1, src2, dest, flags, branch,
+   * ld, imm, memaddr, fallthrough, target, macro op, micro op).
+   * @param path Trace file to read.
+   * @param max_branches Stop after this many branches (0 for all).
+   * @return Whether the file could be read.
+   */
+  bool loadText(const std::string &path, size_t max_branches = 0);
+
+  /**
+   * Maps a binary trace. An uncompressed single-block trace is read in
+   * place (the columns point into the mapping); otherwise the blocks
+   * are decoded, and inflated if compressed, into memory.
+   * @param path Trace file to map.
+   * @param max_branches Stop after this many branches (0 for all).
+   * @return Whether the file is a readable binary trace.
+   */
+  bool loadBinary(const std::string &path, size_t max_branches = 0);
+
+  /** Number of branch records. */
+  size_t size() const { return count; }
+
+  /** Instructions in the trace, i.e. the sum of all instDeltas. */
+  uint64_t instructions() const { return totalInsts; }
+
+  Addr pc(size_t i) const { return pcs[i]; }
+  Addr target(size_t i) const { return targets[i]; }
+  Addr fallthrough(size_t i) const { return fallthroughs[i]; }
+  bool taken(size_t i) const { return flags[i] & TakenFlag; }
+  BranchKind kind(size_t i) const { return (BranchKind)kinds[i]; }
+
+  /** Instructions since the previous branch record, this one included. */
+  uint32_t instDelta(size_t i) const { return instDeltas[i]; }
+
+  /** Bit of the flags column set on taken branches. */
+  static const uint8_t TakenFlag = 1;
+
+protected:
+  BranchTrace(const BranchTrace &) = delete;
+  BranchTrace &operator=(const BranchTrace &) = delete;
+
+  /** Points the column accessors at the owned vectors. */
+  void bindOwned();
+
+  /** Drops the columns and any mapping. */
+  void reset();
+
+  /** Unpacks the columns of an uncompressed block into the owned
+   *  vectors, keeping at most limit records. */
+  void appendBlock(const uint8_t *block, size_t records, size_t limit);
+
+  /** Number of branch records */
+  size_t count;
+
+  /** Instructions covered by the records */
+  uint64_t totalInsts;
+
+  /** Columns read by the accessors, owned or mapped */
+  const uint64_t *pcs;
+  const uint64_t *targets;
+  const uint64_t *fallthroughs;
+  const uint8_t *flags;
+  const uint8_t *kinds;
+  const uint32_t *instDeltas;
+
+  /** Mapping of a binary trace, NULL for traces read into memory */
+  void *mapping;
+  size_t mappingSize;
+
+  /** Storage of the columns of a trace decoded in memory */
+  std::vector<uint64_t> ownedPcs;
+  std::vector<uint64_t> ownedTargets;
+  std::vector<uint64_t> ownedFallthroughs;
+  std::vector<uint8_t> ownedFlags;
+  std::vector<uint8_t> ownedKinds;
+  std::vector<uint32_t> ownedInstDeltas;
+};
+
+#endif // __REPLAY_BRANCH_TRACE_HH__
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Replays a trace through every predictor with no branch in flight,
+# then with branches in flight and with SMT threads, and fails if
+# squashing and re-predicting the younger branches (or sharing the
+# predictor between threads) costs more than a tenth of the
+# mispredictions, as it does when a squash loses committed history.
+#   ./check.sh [trace] [passes]
+
+TRACE=${1:-../../static/data/gcc-1K.trace}
+PASSES=${2:-50}
+DEPTH=8
+THREADS=3
+status=0
+
+mispredicts()
+{
+  ./replay -r "$PASSES" "$@" "$TRACE" | awk '/^mispredictions/ { print $2 }'
+}
+
+for p in NeuroBP HashedNeuroBP NeuroPathBP HybridNeuroBP; do
+  base=$(mispredicts -p $p)
+  deep=$(mispredicts -p $p -d $DEPTH)
+  smt=$(mispredicts -p $p -d $DEPTH -t $THREADS)
+  # a few mispredictions either way come from the order the
+  # predictions and trainings interleave in
+  if [ "$deep" -gt $((base + base / 10 + 10)) ] ||
+     [ "$smt" -gt $((THREADS * (base + base / 10 + 10))) ]; then
+    echo "FAIL $p: $base mispredictions, $deep at -d $DEPTH," \
+         "$smt at -d $DEPTH -t $THREADS"
+    status=1
+  else
+    echo "ok   $p: $base, $deep at -d $DEPTH, $smt at -t $THREADS"
+  fi
+done
+exit $status
@@ -0,0 +1,263 @@
+/*****************************************************************
+ * File: kernel_check.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Checks every perceptron kernel implementation the
+ * host supports (SSE2/AVX2/AVX-512 or NEON) against the scalar
+ * reference: dot products, training and accumulation, the generic
+ * and fixed-length row kernels, rows of odd lengths and unaligned
+ * starts, and weights at the ends of the int8_t/int16_t range.
+ * Exits with status 1 on the first mismatching implementation.
+ ****************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <random>
+#include <vector>
+
+#include "cpu/pred/perceptron_kernel.hh"
+
+using namespace PerceptronKernel;
+
+namespace
+{
+  /** Longest row checked. */
+  const unsigned maxLength = 1024;
+
+  /** Weights past the end of the row, which no kernel may write. */
+  const unsigned guardLength = 64;
+
+  /** History words covering the longest row. */
+  const unsigned historyWords = maxLength / 64;
+
+  /** Mismatches printed per implementation. */
+  const unsigned maxReported = 10;
+
+  /** How the weights of a row are filled in. */
+  enum WeightPattern { Random, AllMin, AllMax, Alternating };
+  const char *patternNames[] = { "random", "min", "max", "alternating" };
+
+  /** How the history paired with a row is filled in. */
+  enum HistoryPattern { RandomBits, AllSet, AllClear };
+  const char *historyNames[] = { "random", "set", "clear" };
+
+  template <typename T> const char *typeName();
+  template <> const char *typeName<int8_t>() { return "int8_t"; }
+  template <> const char *typeName<int16_t>() { return "int16_t"; }
+
+  std::mt19937 rng(1);
+
+  template <typename T>
+  class KernelCheck
+  {
+  public:
+	KernelCheck(const Implementation<T> &implementation, unsigned bits)
+	  : impl(implementation), bits(bits),
+		minWeight(-(1 << (bits - 1))), maxWeight((1 << (bits - 1)) - 1),
+		rows(0), failures(0)
+	{ }
+
+	/**
+	 * Runs every kernel of the implementation and the scalar
+	 * reference over one row and compares the results.
+	 * @param length Weights in the row.
+	 * @param offset Elements from an aligned start to the row.
+	 */
+	void
+	check(unsigned length, unsigned offset, WeightPattern weights,
+		  HistoryPattern history)
+	{
+	  this->length = length;
+	  this->offset = offset;
+	  this->weights = weights;
+	  this->history = history;
+	  fill();
+	  rows++;
+
+	  const T *row = &row_buffer[offset];
+	  int32_t expected = dotScalar(row, history_buffer, length);
+	  compare(impl.dot(row, history_buffer, length), expected, "dot");
+	  for (unsigned k = 0; k < numFixedRowLengths; k++) {
+		if (fixedRowLengths[k] == length)
+		  compare(impl.fixed[k].dot(row, history_buffer, length),
+				  expected, "fixed-length dot");
+	  }
+
+	  for (int taken = 0; taken < 2; taken++) {
+		std::vector<T> trained = row_buffer;
+		trainScalar(&trained[offset], history_buffer, length,
+					taken, minWeight, maxWeight);
+		std::vector<T> result = row_buffer;
+		impl.train(&result[offset], history_buffer, length, taken,
+				   minWeight, maxWeight);
+		compare(result, trained, "train");
+		for (unsigned k = 0; k < numFixedRowLengths; k++) {
+		  if (fixedRowLengths[k] != length)
+			continue;
+		  result = row_buffer;
+		  impl.fixed[k].train(&result[offset], history_buffer,
+							  length, taken, minWeight, maxWeight);
+		  compare(result, trained, "fixed-length train");
+		}
+
+		std::vector<int32_t> summed = sums_buffer;
+		accumulateScalar(&summed[offset], row, length, taken);
+		std::vector<int32_t> sums = sums_buffer;
+		impl.accumulate(&sums[offset], row, length, taken);
+		compare(sums, summed, "accumulate");
+	  }
+	}
+
+	/** Prints the outcome; returns whether every row matched. */
+	bool
+	report() const
+	{
+	  if (failures) {
+		printf("FAIL %s %s %u-bit: %u mismatches over %u rows\n",
+			   impl.name, typeName<T>(), bits, failures, rows);
+	  } else {
+		printf("ok   %s %s %u-bit: %u rows\n", impl.name,
+			   typeName<T>(), bits, rows);
+	  }
+	  return failures == 0;
+	}
+
+  private:
+	/** Fills the row, its guard, the history and the sums. */
+	void
+	fill()
+	{
+	  std::uniform_int_distribution<int32_t> any(minWeight, maxWeight);
+	  row_buffer.assign(offset + length + guardLength, 0);
+	  for (unsigned i = 0; i < row_buffer.size(); i++) {
+		bool in_row = i >= offset && i < offset + length;
+		WeightPattern pattern = in_row ? weights : Random;
+		int32_t value = any(rng);
+		if (pattern == AllMin || (pattern == Random && rng() % 4 == 0))
+		  value = minWeight;
+		else if (pattern == AllMax ||
+				 (pattern == Random && rng() % 4 == 1))
+		  value = maxWeight;
+		else if (pattern == Alternating)
+		  value = i % 2 ? maxWeight : minWeight;
+		row_buffer[i] = value;
+	  }
+
+	  for (unsigned i = 0; i < historyWords; i++) {
+		history_buffer[i] = history == AllSet ? ~(uint64_t)0 :
+		  history == AllClear ? 0 :
+		  (uint64_t)rng() << 32 | rng();
+	  }
+
+	  std::uniform_int_distribution<int32_t> sum(-1 << 20, 1 << 20);
+	  sums_buffer.resize(row_buffer.size());
+	  for (unsigned i = 0; i < sums_buffer.size(); i++)
+		sums_buffer[i] = sum(rng);
+	}
+
+	void
+	describe(const char *kernel)
+	{
+	  if (++failures > maxReported)
+		return;
+	  printf("  %s %s %u-bit %s: length %u, offset %u, %s weights, "
+			 "%s history\n", impl.name, typeName<T>(), bits, kernel,
+			 length, offset, patternNames[weights],
+			 historyNames[history]);
+	}
+
+	void
+	compare(int32_t result, int32_t expected, const char *kernel)
+	{
+	  if (result != expected) {
+		describe(kernel);
+		if (failures <= maxReported)
+		  printf("    %d instead of %d\n", result, expected);
+	  }
+	}
+
+	template <typename E>
+	void
+	compare(const std::vector<E> &result,
+			const std::vector<E> &expected, const char *kernel)
+	{
+	  for (unsigned i = 0; i < result.size(); i++) {
+		if (result[i] == expected[i])
+		  continue;
+		describe(kernel);
+		if (failures <= maxReported) {
+		  printf("    element %d is %d instead of %d\n",
+				 (int)i - (int)offset, (int)result[i],
+				 (int)expected[i]);
+		}
+		return;
+	  }
+	}
+
+	const Implementation<T> &impl;
+	const unsigned bits;
+	const int32_t minWeight;
+	const int32_t maxWeight;
+
+	unsigned rows;
+	unsigned failures;
+
+	unsigned length;
+	unsigned offset;
+	WeightPattern weights;
+	HistoryPattern history;
+
+	std::vector<T> row_buffer;
+	std::vector<int32_t> sums_buffer;
+	uint64_t history_buffer[historyWords];
+  };
+
+  /** Lengths covering every vector tail and the fixed row lengths. */
+  std::vector<unsigned>
+  rowLengths()
+  {
+	std::vector<unsigned> lengths;
+	for (unsigned length = 1; length <= 72; length++)
+	  lengths.push_back(length);
+	const unsigned long_rows[] = { 127, 128, 129, 255, 256, 257, 511,
+								   1000, maxLength };
+	lengths.insert(lengths.end(), long_rows, long_rows + 9);
+	return lengths;
+  }
+
+  template <typename T>
+  bool
+  checkImplementations(const unsigned *widths, unsigned num_widths)
+  {
+	bool ok = true;
+	for (const Implementation<T> &impl : hostImplementations<T>()) {
+	  for (unsigned w = 0; w < num_widths; w++) {
+		KernelCheck<T> check(impl, widths[w]);
+		for (unsigned length : rowLengths()) {
+		  for (unsigned offset = 0; offset < 2; offset++) {
+			for (int p = Random; p <= Alternating; p++) {
+			  for (int h = RandomBits; h <= AllClear; h++)
+				check.check(length, offset, (WeightPattern)p,
+							(HistoryPattern)h);
+			}
+		  }
+		}
+		ok &= check.report();
+	  }
+	}
+	return ok;
+  }
+}
+
+int
+main()
+{
+  // the narrow widths clamp inside the storage type, the full ones
+  // at its ends, where the vector adds and stores saturate
+  const unsigned narrow[] = { 5, 8 };
+  const unsigned wide[] = { 12, 16 };
+  bool ok = checkImplementations<int8_t>(narrow, 2);
+  ok &= checkImplementations<int16_t>(wide, 2);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+/*****************************************************************
+ * File: predictor_factory.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Builds the predictors for trace replay by their
+ * gem5 class name, with their BranchPredictor.py parameters
+ * overridable from the command line.
+ ****************************************************************/
+
+#include "predictor_factory.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+
+#include "cpu/pred/always.hh"
+#include "cpu/pred/hashed_neurobranch.hh"
+#include "cpu/pred/hybrid_neurobranch.hh"
+#include "cpu/pred/neurobranch.hh"
+#include "cpu/pred/neuropath.hh"
+
+namespace
+{
+  /** Named parameter fields of one params object. */
+  class ParamTable
+  {
+  public:
+	void
+	add(const char *name, unsigned &field)
+	{
+	  fields.push_back(Field{name, &field, NULL, NULL});
+	}
+
+	void
+	add(const char *name, bool &field)
+	{
+	  fields.push_back(Field{name, NULL, &field, NULL});
+	}
+
+	void
+	add(const char *name, std::string &field)
+	{
+	  fields.push_back(Field{name, NULL, NULL, &field});
+	}
+
+	/** Applies "param=value" overrides to the registered fields. */
+	void
+	apply(const std::string &predictor,
+		  const std::vector<std::string> &overrides)
+	{
+	  for (const std::string &setting : overrides) {
+		size_t eq = setting.find('=');
+		if (eq == std::string::npos)
+		  fatal("Expected param=value, got '%s'!\n", setting.c_str());
+		std::string key = setting.substr(0, eq);
+		const char *value = setting.c_str() + eq + 1;
+
+		Field *field = find(key);
+		if (!field)
+		  fatal("%s has no param '%s'!\n", predictor.c_str(),
+				key.c_str());
+
+		if (field->text) {
+		  *field->text = value;
+		  continue;
+		}
+
+		char *end;
+		unsigned long parsed = strtoul(value, &end, 0);
+		if (field->flag && (!strcmp(value, "True") ||
+							!strcmp(value, "true"))) {
+		  parsed = 1;
+		} else if (field->flag && (!strcmp(value, "False") ||
+								   !strcmp(value, "false"))) {
+		  parsed = 0;
+		} else if (*value == '\0' || *end != '\0') {
+		  fatal("Invalid value '%s' for %s!\n", value, key.c_str());
+		}
+
+		if (field->number)
+		  *field->number = parsed;
+		else
+		  *field->flag = parsed != 0;
+	  }
+	}
+
+  private:
+	struct Field {
+	  std::string name;
+	  unsigned *number;
+	  bool *flag;
+	  std::string *text;
+	};
+
+	Field *
+	find(const std::string &name)
+	{
+	  for (Field &field : fields)
+		if (field.name == name)
+		  return &field;
+	  return NULL;
+	}
+
+	std::vector<Field> fields;
+  };
+
+  void
+  addCommon(ParamTable &table, BranchPredictorParams &params)
+  {
+	table.add("name", params.name);
+	table.add("numThreads", params.numThreads);
+	table.add("instShiftAmt", params.instShiftAmt);
+  }
+
+  /**
+   * Predictors built as params of others, by the predictor they were
+   * given to. Like every SimObject of gem5 they live as long as the
+   * process, the predictors holding them only keep a pointer.
+   */
+  std::map<const BPredUnit *, std::vector<std::unique_ptr<BPredUnit>>> &
+  components()
+  {
+	static std::map<const BPredUnit *,
+					std::vector<std::unique_ptr<BPredUnit>>> built;
+	return built;
+  }
+
+  /**
+   * Splits the overrides of a predictor with a predictor param: "param"
+   * selects its class and "param.name=value" settings are forwarded to
+   * it, the rest are left to the predictor itself.
+   */
+  std::vector<std::string>
+  componentOverrides(const std::string &param, std::string &class_name,
+					 std::vector<std::string> &overrides)
+  {
+	std::vector<std::string> own, forwarded;
+	for (const std::string &setting : overrides) {
+	  if (setting.compare(0, param.size() + 1, param + "=") == 0)
+		class_name = setting.substr(param.size() + 1);
+	  else if (setting.compare(0, param.size() + 1, param + ".") == 0)
+		forwarded.push_back(setting.substr(param.size() + 1));
+	  else
+		own.push_back(setting);
+	}
+	overrides = own;
+	return forwarded;
+  }
+}
+
+BPredUnit *
+createPredictor(const std::string &name,
+				const std::vector<std::string> &overrides)
+{
+  ParamTable table;
+
+  if (name == "AlwaysBP") {
+	AlwaysBPParams params;
+	params.name = name;
+	addCommon(table, params);
+	table.apply(name, overrides);
+	return params.create();
+  }
+
+  if (name == "NeuroBP") {
+	NeuroBPParams params;
+	params.name = name;
+	addCommon(table, params);
+	table.add("historyLength", params.historyLength);
+	table.add("numPerceptrons", params.numPerceptrons);
+	table.add("globalCtrBits", params.globalCtrBits);
+	table.add("weightBits", params.weightBits);
+	table.add("historyPoolSize", params.historyPoolSize);
+	table.add("detailedStats", params.detailedStats);
+	table.add("weightsFile", params.weightsFile);
+	table.add("sharedWeights", params.sharedWeights);
+	table.add("specializedKernels", params.specializedKernels);
+	table.add("updateDelay", params.updateDelay);
+	table.add("updateBufferRows", params.updateBufferRows);
+	table.add("earlyExit", params.earlyExit);
+	table.add("associativity", params.associativity);
+	table.add("tagBits", params.tagBits);
+	table.add("replacement", params.replacement);
+	table.add("profileSize", params.profileSize);
+	table.add("profileFile", params.profileFile);
+	table.apply(name, overrides);
+	return params.create();
+  }
+
+  if (name == "HashedNeuroBP") {
+	HashedNeuroBPParams params;
+	params.name = name;
+	addCommon(table, params);
+	table.add("historyLength", params.historyLength);
+	table.add("numPerceptrons", params.numPerceptrons);
+	table.add("globalCtrBits", params.globalCtrBits);
+	table.add("weightBits", params.weightBits);
+	table.add("historyPoolSize", params.historyPoolSize);
+	table.add("detailedStats", params.detailedStats);
+	table.add("weightsFile", params.weightsFile);
+	table.add("sharedWeights", params.sharedWeights);
+	table.add("specializedKernels", params.specializedKernels);
+	table.add("numTables", params.numTables);
+	table.add("logTableSize", params.logTableSize);
+	table.add("profileSize", params.profileSize);
+	table.add("profileFile", params.profileFile);
+	table.apply(name, overrides);
+	return params.create();
+  }
+
+  if (name == "NeuroPathBP") {
+	NeuroPathBPParams params;
+	params.name = name;
+	addCommon(table, params);
+	table.add("historyLength", params.historyLength);
+	table.add("numPerceptrons", params.numPerceptrons);
+	table.add("globalCtrBits", params.globalCtrBits);
+	table.add("weightBits", params.weightBits);
+	table.add("historyPoolSize", params.historyPoolSize);
+	table.add("detailedStats", params.detailedStats);
+	table.add("weightsFile", params.weightsFile);
+	table.add("sharedWeights", params.sharedWeights);
+	table.add("specializedKernels", params.specializedKernels);
+	table.add("updateDelay", params.updateDelay);
+	table.add("updateBufferRows", params.updateBufferRows);
+	table.add("aheadPipelined", params.aheadPipelined);
+	table.add("lookupLatency", params.lookupLatency);
+	table.add("adderLevelsPerCycle", params.adderLevelsPerCycle);
+	table.add("indirectPathLength", params.indirectPathLength);
+	table.add("profileSize", params.profileSize);
+	table.add("profileFile", params.profileFile);
+	table.apply(name, overrides);
+	return params.create();
+  }
+
+  if (name == "HybridNeuroBP") {
+	HybridNeuroBPParams params;
+	params.name = name;
+	addCommon(table, params);
+	table.add("bimodalSize", params.bimodalSize);
+	table.add("bimodalCtrBits", params.bimodalCtrBits);
+	table.add("chooserSize", params.chooserSize);
+	table.add("chooserCtrBits", params.chooserCtrBits);
+	table.add("historyPoolSize", params.historyPoolSize);
+
+	std::string perceptron_class = "NeuroBP";
+	std::vector<std::string> own = overrides;
+	std::vector<std::string> forwarded =
+	  componentOverrides("perceptron", perceptron_class, own);
+	table.apply(name, own);
+
+	// the component shares the threads and PC shift of the
+	// predictor, and is named after it as gem5 names children
+	forwarded.insert(forwarded.begin(), {
+		"name=" + params.name + ".perceptron",
+		"numThreads=" + std::to_string(params.numThreads),
+		"instShiftAmt=" + std::to_string(params.instShiftAmt) });
+	std::unique_ptr<BPredUnit> perceptron(
+	  createPredictor(perceptron_class, forwarded));
+	params.perceptron = perceptron.get();
+
+	BPredUnit *bp = params.create();
+	components()[bp].push_back(std::move(perceptron));
+	return bp;
+  }
+
+  fatal("Unknown predictor '%s'!\n", name.c_str());
+}
+
+std::vector<BPredUnit *>
+simObjects(BPredUnit &bp)
+{
+  std::vector<BPredUnit *> objects;
+  auto it = components().find(&bp);
+  if (it != components().end()) {
+	for (const std::unique_ptr<BPredUnit> &component : it->second) {
+	  std::vector<BPredUnit *> nested = simObjects(*component);
+	  objects.insert(objects.end(), nested.begin(), nested.end());
+	}
+  }
+  objects.push_back(&bp);
+  return objects;
+}
+
+std::vector<std::string>
+predictorNames()
+{
+  return { "AlwaysBP", "NeuroBP", "HashedNeuroBP", "NeuroPathBP",
+		   "HybridNeuroBP" };
+}
@@ -0,0 +1,38 @@
+/*****************************************************************
+ * File: predictor_factory.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Builds the predictors for trace replay by their
+ * gem5 class name, with their BranchPredictor.py parameters
+ * overridable from the command line: header file.
+ ****************************************************************/
+
+#ifndef __REPLAY_PREDICTOR_FACTORY_HH__
+#define __REPLAY_PREDICTOR_FACTORY_HH__
+
+#include <string>
+#include <vector>
+
+#include "cpu/pred/bpred_unit.hh"
+
+/**
+ * Builds a predictor, fatal() on an unknown name or parameter.
+ * @param name gem5 class name of the predictor (see predictorNames).
+ * @param overrides "param=value" settings applied over the defaults.
+ * @return The predictor, owned by the caller.
+ */
+BPredUnit *createPredictor(const std::string &name,
+						   const std::vector<std::string> &overrides);
+
+/**
+ * The SimObjects making up a predictor built by createPredictor: the
+ * predictors it was given as params (the perceptron of HybridNeuroBP),
+ * then the predictor itself. gem5 calls init(), regStats() and
+ * (un)serialize() on each of them, so the replay does too.
+ */
+std::vector<BPredUnit *> simObjects(BPredUnit &bp);
+
+/** Class names accepted by createPredictor. */
+std::vector<std::string> predictorNames();
+
+#endif // __REPLAY_PREDICTOR_FACTORY_HH__
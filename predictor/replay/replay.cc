@@ -0,0 +1,375 @@
+/*****************************************************************
+ * File: replay.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Standalone trace replay of the branch predictors,
+ * built against stand-ins for the few gem5 headers they use, to
+ * measure accuracy (MPKI) and prediction throughput in seconds
+ * rather than full TimingSimpleCPU runs.
+ ****************************************************************/
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "base/statistics.hh"
+#include "branch_trace.hh"
+#include "predictor_factory.hh"
+#include "replay_engine.hh"
+#include "sim/core.hh"
+#include "sim/serialize.hh"
+
+static void
+usage(const char *prog)
+{
+  fprintf(stderr,
+		  "usage: %s [-p predictor] [-o param=value]... [-d depth]\n"
+		  "          [-t threads] [-r passes] [-n branches] [-s]\n"
+		  "          [-l dir] [-w dir] [-x param=values]... [-j workers]\n"
+		  "          [-S shards] [-W warmup] [-c] [-P file] [-i] trace\n"
+		  "  trace is a text dump or a binary .npbt trace "
+		  "(static/trace_format.py)\n"
+		  "  -p  predictor class name (default NeuroBP):",
+		  prog);
+  for (const std::string &name : predictorNames())
+	fprintf(stderr, " %s", name.c_str());
+  fprintf(stderr,
+		  "\n"
+		  "  -o  override a BranchPredictor.py param, may be repeated\n"
+		  "  -d  branches in flight before a branch resolves (0)\n"
+		  "  -t  SMT threads replaying the trace side by side (1), sets "
+		  "numThreads\n"
+		  "  -r  times the trace is replayed (1)\n"
+		  "  -n  only read the first branches of the trace (all)\n"
+		  "  -s  also print the predictor stats as in stats.txt\n"
+		  "  -l  restore the predictor from a checkpoint directory\n"
+		  "  -w  checkpoint the predictor into a directory afterwards\n"
+		  "  -x  sweep a param over v1,v2,... or first:last[:step], may be\n"
+		  "      repeated (every combination); the configurations share\n"
+		  "      one pass over the trace\n"
+		  "  -j  host threads the sweep or shards are spread over (one per\n"
+		  "      core)\n"
+		  "  -S  cut the trace into shards replayed in parallel, each on a\n"
+		  "      fresh predictor (1)\n"
+		  "  -W  branches before each shard its predictor warms on "
+		  "(100000)\n"
+		  "  -c  also replay serially and report how close the shards "
+		  "come\n"
+		  "  -P  write the branches and mispredictions of every PC to a "
+		  "CSV\n"
+		  "      file, JSON if it ends in .json, most mispredicted first\n"
+		  "  -i  also predict the targets of indirect jumps and calls with\n"
+		  "      gem5's indirect predictor, indexed with getGHR()\n");
+  exit(2);
+}
+
+/**
+ * Writes the predictor state as the m5.cpt of a checkpoint directory,
+ * one section per SimObject named after it as gem5 would.
+ */
+static void
+writeCheckpoint(BPredUnit &bp, const std::string &dir)
+{
+  if (mkdir(dir.c_str(), 0775) != 0 && errno != EEXIST)
+	fatal("Can't create checkpoint directory %s!\n", dir.c_str());
+  CheckpointIn::setDir(dir);
+
+  std::string path = dir + "/" + CheckpointIn::baseFilename();
+  std::ofstream cp(path.c_str());
+  cp << "## checkpoint written by replay\n";
+  for (const BPredUnit *object : simObjects(bp)) {
+	Serializable::ScopedCheckpointSection sec(cp, object->name());
+	object->serialize(cp);
+  }
+  if (!cp.flush())
+	fatal("Error writing checkpoint file %s!\n", path.c_str());
+}
+
+/** Restores the predictor from the sections named after its
+ *  SimObjects. */
+static void
+restoreCheckpoint(BPredUnit &bp, const std::string &dir)
+{
+  CheckpointIn cp(dir);
+  for (BPredUnit *object : simObjects(bp)) {
+	Serializable::ScopedCheckpointSection sec(cp, object->name());
+	object->unserialize(cp);
+  }
+}
+
+/** Initialises the SimObjects of a predictor and registers their stats,
+ *  as gem5 does once the system is built. */
+static void
+initPredictor(BPredUnit &bp)
+{
+  std::vector<BPredUnit *> objects = simObjects(bp);
+  for (BPredUnit *object : objects)
+	object->init();
+  for (BPredUnit *object : objects)
+	object->regStats();
+}
+
+/** Relative MPKI error under which a sharded replay is trusted. */
+static const double convergenceTolerance = 0.01;
+
+/** Prints the counts of a replay as the single-predictor report, with
+ *  the indirect branches if their targets were predicted. */
+static void
+printResult(const std::string &predictor, const ReplayResult &result,
+			bool indirect)
+{
+  printf("predictor       %s\n", predictor.c_str());
+  printf("instructions    %llu\n", (unsigned long long)result.instructions);
+  printf("branches        %llu\n", (unsigned long long)result.branches);
+  printf("conditional     %llu\n", (unsigned long long)result.condBranches);
+  printf("mispredictions  %llu\n", (unsigned long long)result.mispredicts);
+  if (indirect) {
+	printf("indirect        %llu\n",
+		   (unsigned long long)result.indirectBranches);
+	printf("wrong targets   %llu\n",
+		   (unsigned long long)result.indirectMispredicts);
+  }
+  printf("squashed        %llu\n", (unsigned long long)result.squashed);
+  if (result.predictionCycles) {
+	printf("predict cycles  %llu\n",
+		   (unsigned long long)result.predictionCycles);
+	printf("fetch stalls    %llu\n", (unsigned long long)result.fetchStalls);
+	printf("stalls/kinst    %.3f\n", result.stallsPerKilo());
+  }
+  printf("accuracy        %.4f\n", result.accuracy());
+  printf("mpki            %.3f\n", result.mpki());
+  printf("seconds         %.6f\n", result.seconds);
+  printf("predictions/s   %.0f\n", result.predictionsPerSecond());
+}
+
+/**
+ * Expands a sweep given as param=v1,v2,... or param=first:last[:step]
+ * into one "param=value" setting per value.
+ */
+static std::vector<std::string>
+expandSweep(const std::string &sweep)
+{
+  size_t eq = sweep.find('=');
+  if (eq == std::string::npos)
+	fatal("Expected param=values, got '%s'!\n", sweep.c_str());
+  std::string param = sweep.substr(0, eq + 1);
+  std::string values = sweep.substr(eq + 1);
+
+  std::vector<std::string> settings;
+  unsigned long first, last, step = 1;
+  int parsed = sscanf(values.c_str(), "%lu:%lu:%lu", &first, &last, &step);
+  if (values.find(':') != std::string::npos) {
+	if (parsed < 2 || step == 0 || last < first)
+	  fatal("Invalid range '%s'!\n", values.c_str());
+	for (unsigned long v = first; v <= last; v += step)
+	  settings.push_back(param + std::to_string(v));
+	return settings;
+  }
+
+  size_t begin = 0;
+  while (begin <= values.size()) {
+	size_t comma = values.find(',', begin);
+	if (comma == std::string::npos)
+	  comma = values.size();
+	settings.push_back(param + values.substr(begin, comma - begin));
+	begin = comma + 1;
+  }
+  return settings;
+}
+
+/** Every combination of the values of the sweeps. */
+static std::vector<std::vector<std::string>>
+sweepConfigs(const std::vector<std::string> &sweeps)
+{
+  std::vector<std::vector<std::string>> configs(1);
+  for (const std::string &sweep : sweeps) {
+	std::vector<std::vector<std::string>> expanded;
+	for (const std::string &setting : expandSweep(sweep)) {
+	  for (const std::vector<std::string> &config : configs) {
+		expanded.push_back(config);
+		expanded.back().push_back(setting);
+	  }
+	}
+	configs.swap(expanded);
+  }
+  return configs;
+}
+
+int
+main(int argc, char **argv)
+{
+  std::string predictor = "NeuroBP";
+  std::vector<std::string> overrides;
+  ReplayOptions options;
+  size_t max_branches = 0;
+  bool print_stats = false;
+  std::string restore_dir, checkpoint_dir;
+  std::vector<std::string> sweeps;
+  unsigned workers = 0;
+  ShardOptions shard_options;
+  shard_options.warmup = 100000;
+  bool check_convergence = false;
+  std::string profile_file;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "p:o:d:t:r:n:sl:w:x:j:S:W:cP:ih")) != -1) {
+	switch (opt) {
+	  case 'p': predictor = optarg; break;
+	  case 'o': overrides.push_back(optarg); break;
+	  case 'd': options.depth = strtoul(optarg, NULL, 0); break;
+	  case 't': options.threads = strtoul(optarg, NULL, 0); break;
+	  case 'r': options.passes = strtoul(optarg, NULL, 0); break;
+	  case 'n': max_branches = strtoull(optarg, NULL, 0); break;
+	  case 's': print_stats = true; break;
+	  case 'l': restore_dir = optarg; break;
+	  case 'w': checkpoint_dir = optarg; break;
+	  case 'x': sweeps.push_back(optarg); break;
+	  case 'j': workers = strtoul(optarg, NULL, 0); break;
+	  case 'S': shard_options.shards = strtoul(optarg, NULL, 0); break;
+	  case 'W': shard_options.warmup = strtoull(optarg, NULL, 0); break;
+	  case 'c': check_convergence = true; break;
+	  case 'P': profile_file = optarg; break;
+	  case 'i': options.indirect = true; break;
+	  default: usage(argv[0]);
+	}
+  }
+  if (optind != argc - 1)
+	usage(argv[0]);
+
+  BranchTrace trace;
+  if (!trace.load(argv[optind], max_branches))
+	fatal("Cannot read trace %s!\n", argv[optind]);
+
+  if (options.threads == 0)
+	usage(argv[0]);
+  // an explicit -o numThreads still wins
+  if (options.threads > 1)
+	overrides.insert(overrides.begin(),
+					 "numThreads=" + std::to_string(options.threads));
+
+  if (shard_options.shards == 0)
+	usage(argv[0]);
+  if (shard_options.shards > 1 || check_convergence) {
+	if (!sweeps.empty() || !checkpoint_dir.empty() || print_stats ||
+		options.passes != 1) {
+	  fatal("A sharded replay is a single pass of one predictor, with no "
+			"checkpoint or stats to merge!\n");
+	}
+
+	// every shard starts from the same restored state
+	PredictorMaker make = [&]() {
+	  BPredUnit *bp = createPredictor(predictor, overrides);
+	  initPredictor(*bp);
+	  if (!restore_dir.empty())
+		restoreCheckpoint(*bp, restore_dir);
+	  return bp;
+	};
+
+	ShardedResult sharded =
+	  replaySharded(make, trace, options, shard_options, workers);
+	printResult(predictor, sharded.total, options.indirect);
+	printf("shards          %u\n", (unsigned)sharded.shards.size());
+	printf("warmup          %llu\n",
+		   (unsigned long long)shard_options.warmup);
+	if (!profile_file.empty())
+	  sharded.profile.dump(profile_file);
+
+	if (check_convergence) {
+	  ShardOptions serial_options;
+	  ShardedResult serial =
+		replaySharded(make, trace, options, serial_options, 1);
+	  double error = serial.total.mpki() > 0 ?
+		std::fabs(sharded.total.mpki() - serial.total.mpki()) /
+		serial.total.mpki() : sharded.total.mpki();
+	  printf("serial mpki     %.3f\n", serial.total.mpki());
+	  printf("serial seconds  %.6f\n", serial.total.seconds);
+	  printf("mpki error      %.4f\n", error);
+	  printf("pc divergence   %.4f\n",
+			 profileDivergence(sharded.profile, serial.profile));
+	  printf("converged       %s\n",
+			 error <= convergenceTolerance ? "yes" : "no");
+	}
+	return 0;
+  }
+
+  if (!sweeps.empty()) {
+	if (!checkpoint_dir.empty() || !profile_file.empty())
+	  fatal("A sweep can't be checkpointed or profiled into a single "
+			"file!\n");
+
+	std::vector<std::vector<std::string>> configs = sweepConfigs(sweeps);
+	std::vector<std::unique_ptr<BPredUnit>> owned;
+	std::vector<BPredUnit *> bps;
+	for (const std::vector<std::string> &config : configs) {
+	  std::vector<std::string> settings = overrides;
+	  settings.insert(settings.end(), config.begin(), config.end());
+	  owned.emplace_back(createPredictor(predictor, settings));
+	  initPredictor(*owned.back());
+	  if (!restore_dir.empty())
+		restoreCheckpoint(*owned.back(), restore_dir);
+	  bps.push_back(owned.back().get());
+	}
+
+	std::vector<ReplayResult> results =
+	  replayBatch(bps, trace, options, workers);
+
+	printf("%-40s %14s %9s %9s %10s%s\n", predictor.c_str(),
+		   "mispredictions", "accuracy", "mpki", "seconds",
+		   options.indirect ? "  wrong targets" : "");
+	for (size_t c = 0; c < configs.size(); c++) {
+	  std::string name;
+	  for (const std::string &setting : configs[c])
+		name += (name.empty() ? "" : " ") + setting;
+	  printf("%-40s %14llu %9.4f %9.3f %10.6f", name.c_str(),
+			 (unsigned long long)results[c].mispredicts,
+			 results[c].accuracy(), results[c].mpki(), results[c].seconds);
+	  if (options.indirect) {
+		printf(" %14llu",
+			   (unsigned long long)results[c].indirectMispredicts);
+	  }
+	  printf("\n");
+	}
+
+	if (print_stats) {
+	  printf("\n");
+	  Stats::dump(stdout);
+	}
+	doExitCleanup();
+	return 0;
+  }
+
+  std::unique_ptr<BPredUnit> bp(createPredictor(predictor, overrides));
+  initPredictor(*bp);
+  if (!restore_dir.empty())
+	restoreCheckpoint(*bp, restore_dir);
+
+  BranchProfile profile;
+  if (!profile_file.empty())
+	profile.init(shard_options.profileSize);
+
+  ReplayResult result = replayTrace(*bp, trace, options,
+									profile.enabled() ? &profile : NULL);
+  if (!checkpoint_dir.empty())
+	writeCheckpoint(*bp, checkpoint_dir);
+
+  printResult(predictor, result, options.indirect);
+  if (profile.enabled())
+	profile.dump(profile_file);
+
+  if (print_stats) {
+	printf("\n");
+	Stats::dump(stdout);
+  }
+
+  // predictors given a profileSize write their own profile, as at the
+  // exit of gem5
+  doExitCleanup();
+  return 0;
+}
@@ -0,0 +1,391 @@
+/*****************************************************************
+ * File: replay_engine.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Drives a BPredUnit through the branches of a trace
+ * with the same lookup/update/squash sequence the gem5 CPU models
+ * issue, optionally keeping branches in flight for a number of
+ * branches before they resolve.
+ ****************************************************************/
+
+#include "replay_engine.hh"
+
+#include "cpu/pred/neuropath.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  /** Branches fed to every predictor of a worker in turn, small
+   *  enough for the columns of a block to stay in L1/L2 */
+  const size_t blockBranches = 2048;
+
+  /** A predicted branch waiting to resolve. */
+  struct InFlight {
+	size_t index;
+	void *history;
+	bool predTaken;
+	/** Sequence number the indirect predictor knows the branch by */
+	InstSeqNum seqNum;
+	/** Target predicted for an indirect branch, 0 for none */
+	Addr predTarget;
+  };
+
+  /** Whether a branch gets its target from the indirect predictor. */
+  inline bool
+  isIndirect(BranchKind kind)
+  {
+	return kind == IndirectJump || kind == IndirectCall;
+  }
+
+  /** An indirect predictor configured as gem5's BranchPredictor.py
+   *  does by default. */
+  IndirectPredictor *
+  indirectPredictor(unsigned num_threads)
+  {
+	return new IndirectPredictor(true, true, 256, 2, 16, 3, 2, num_threads);
+  }
+
+  class Replayer
+  {
+  public:
+	/**
+	 * @param measure_from First branch counted in the result, the
+	 * earlier ones only warming the predictor.
+	 * @param profile Per-PC counts to add the counted branches to, if
+	 * any.
+	 * @param ipred Indirect predictor of the predictor, shared by its
+	 * threads, NULL to leave the targets out.
+	 */
+	Replayer(BPredUnit &bp, const BranchTrace &trace, ThreadID tid,
+			 ReplayResult &result, size_t measure_from = 0,
+			 BranchProfile *profile = NULL, IndirectPredictor *ipred = NULL)
+	  : bp(bp), trace(trace), tid(tid), result(result),
+		measureFrom(measure_from), profile(profile), ipred(ipred),
+		latencyModel(dynamic_cast<const NeuroPathBP *>(&bp)),
+		nextSeqNum(0)
+	{ }
+
+	/** Predicts branch i and adds it to the youngest end. */
+	void
+	predict(size_t i)
+	{
+	  InFlight branch = { i, NULL, true, ++nextSeqNum, 0 };
+	  if (trace.kind(i) == CondBranch) {
+		branch.predTaken = bp.lookup(tid, trace.pc(i), branch.history);
+		if (latencyModel && i >= measureFrom) {
+		  unsigned cycles = latencyModel->predictionLatency(tid);
+		  result.predictionCycles += cycles;
+		  result.fetchStalls += cycles - 1;
+		}
+	  } else
+		bp.uncondBranch(tid, trace.pc(i), branch.history);
+
+	  // as BPredUnit::predict does, the target cache is indexed with
+	  // the GHR the direction predictor gives for the branch
+	  if (ipred && isIndirect(trace.kind(i))) {
+		unsigned ghr = bp.getGHR(tid, branch.history);
+		Addr target;
+		if (ipred->lookup(trace.pc(i), ghr, target, tid))
+		  branch.predTarget = target;
+		ipred->recordIndirect(trace.pc(i), branch.predTarget, ghr,
+							  branch.seqNum, tid);
+	  }
+	  window.push_back(branch);
+	  result.predictions += i >= measureFrom;
+	}
+
+	/** Resolves branches until at most limit are left in flight. */
+	void
+	drain(size_t limit)
+	{
+	  while (window.size() > limit)
+		resolveOldest();
+	}
+
+  private:
+	void
+	resolveOldest()
+	{
+	  InFlight &oldest = window.front();
+	  size_t i = oldest.index;
+	  Addr pc = trace.pc(i);
+	  bool taken = trace.taken(i);
+
+	  bool cond = trace.kind(i) == CondBranch;
+	  bool indirect = ipred && isIndirect(trace.kind(i));
+	  bool mispredicted = cond && oldest.predTaken != taken;
+	  bool wrong_target = indirect && oldest.predTarget != trace.target(i);
+
+	  if (i >= measureFrom) {
+		result.branches++;
+		result.condBranches += cond;
+		result.mispredicts += mispredicted;
+		result.indirectBranches += indirect;
+		result.indirectMispredicts += wrong_target;
+		if (mispredicted || wrong_target)
+		  result.squashed += window.size() - 1;
+		if (cond && profile)
+		  profile->record(pc, mispredicted, false);
+	  }
+
+	  if (!mispredicted && !wrong_target) {
+		bp.update(tid, pc, taken, oldest.history, false);
+		if (indirect)
+		  ipred->commit(oldest.seqNum, tid);
+		window.pop_front();
+		return;
+	  }
+
+	  // the younger branches were fetched down the wrong path: squash
+	  // them youngest first, as the CPU does
+	  for (size_t j = window.size() - 1; j > 0; j--)
+		bp.squash(tid, window[j].history);
+	  if (ipred)
+		ipred->squash(oldest.seqNum, tid);
+
+	  // update with the correct outcome on the squash, then commit;
+	  // a wrong target is written into the target cache meanwhile
+	  bp.update(tid, pc, taken, oldest.history, true);
+	  if (wrong_target)
+		ipred->recordTarget(oldest.seqNum, trace.target(i), tid);
+	  bp.update(tid, pc, taken, oldest.history, false);
+	  if (indirect)
+		ipred->commit(oldest.seqNum, tid);
+
+	  // the trace is the committed path, so the squashed branches are
+	  // fetched and predicted again
+	  std::vector<size_t> refetch;
+	  for (size_t j = 1; j < window.size(); j++)
+		refetch.push_back(window[j].index);
+	  window.clear();
+	  for (size_t j : refetch)
+		predict(j);
+	}
+
+  private:
+	BPredUnit &bp;
+	const BranchTrace &trace;
+	ThreadID tid;
+	ReplayResult &result;
+	size_t measureFrom;
+	BranchProfile *profile;
+	IndirectPredictor *ipred;
+
+	/** The predictor if it models its prediction latency */
+	const NeuroPathBP *latencyModel;
+
+	/** Sequence number of the last branch predicted */
+	InstSeqNum nextSeqNum;
+
+	/** Branches in flight, oldest first */
+	std::deque<InFlight> window;
+  };
+}
+
+ReplayResult
+replayTrace(BPredUnit &bp, const BranchTrace &trace,
+			const ReplayOptions &options, BranchProfile *profile)
+{
+  return replayBatch({ &bp }, trace, options, 1, { profile })[0];
+}
+
+std::vector<ReplayResult>
+replayBatch(const std::vector<BPredUnit *> &bps, const BranchTrace &trace,
+			const ReplayOptions &options, unsigned workers,
+			const std::vector<BranchProfile *> &profiles)
+{
+  std::vector<ReplayResult> results(bps.size());
+
+  // the indirect predictor is part of BPredUnit in gem5, one for the
+  // threads of each predictor
+  std::vector<std::unique_ptr<IndirectPredictor>> ipreds(bps.size());
+  unsigned num_threads = options.tid + options.threads;
+  if (options.indirect) {
+	for (auto &ipred : ipreds)
+	  ipred.reset(indirectPredictor(num_threads));
+  }
+
+  // the state of the replays, one replayer per predictor and thread,
+  // predictor-major next to one another rather than inside each
+  // predictor's own driver
+  std::vector<Replayer> replayers;
+  replayers.reserve(bps.size() * options.threads);
+  for (size_t p = 0; p < bps.size(); p++) {
+	BranchProfile *profile = profiles.empty() ? NULL : profiles[p];
+	for (unsigned t = 0; t < options.threads; t++) {
+	  replayers.emplace_back(*bps[p], trace, options.tid + t, results[p], 0,
+							 profile, ipreds[p].get());
+	}
+  }
+
+  if (workers == 0)
+	workers = std::max(1u, std::thread::hardware_concurrency());
+  workers = std::min<size_t>(workers, bps.size());
+
+  // predictor p goes to worker p % workers, which interleaves cheap
+  // and expensive points of a sweep
+  auto work = [&](unsigned worker) {
+	for (unsigned pass = 0; pass < options.passes; pass++) {
+	  for (size_t first = 0; first < trace.size(); first += blockBranches) {
+		size_t last = std::min(first + blockBranches, trace.size());
+		for (size_t p = worker; p < bps.size(); p += workers) {
+		  auto start = std::chrono::steady_clock::now();
+		  Replayer *threads = &replayers[p * options.threads];
+		  for (size_t i = first; i < last; i++) {
+			for (unsigned t = 0; t < options.threads; t++) {
+			  threads[t].predict(i);
+			  threads[t].drain(options.depth);
+			}
+		  }
+		  if (pass == options.passes - 1 && last == trace.size()) {
+			for (unsigned t = 0; t < options.threads; t++)
+			  threads[t].drain(0);
+		  }
+		  auto end = std::chrono::steady_clock::now();
+		  results[p].seconds +=
+			std::chrono::duration<double>(end - start).count();
+		}
+	  }
+	}
+  };
+
+  if (workers == 1) {
+	work(0);
+  } else {
+	std::vector<std::thread> pool;
+	for (unsigned w = 0; w < workers; w++)
+	  pool.emplace_back(work, w);
+	for (std::thread &thread : pool)
+	  thread.join();
+  }
+
+  for (ReplayResult &result : results) {
+	result.instructions = trace.instructions() * options.passes *
+	  options.threads;
+  }
+  return results;
+}
+
+ShardedResult
+replaySharded(const PredictorMaker &make, const BranchTrace &trace,
+			  const ReplayOptions &options, const ShardOptions &shard_options,
+			  unsigned workers)
+{
+  unsigned shards = std::max(1u, shard_options.shards);
+  ShardedResult sharded;
+  sharded.shards.resize(shards);
+  std::vector<BranchProfile> profiles(shards);
+  for (BranchProfile &profile : profiles)
+	profile.init(shard_options.profileSize);
+  sharded.profile.init(shard_options.profileSize);
+
+  if (workers == 0)
+	workers = std::max(1u, std::thread::hardware_concurrency());
+  workers = std::min(workers, shards);
+
+  // building and destroying predictors registers and drops their stats
+  std::mutex registration;
+  std::atomic<unsigned> next_shard(0);
+
+  auto work = [&]() {
+	for (unsigned s; (s = next_shard++) < shards; ) {
+	  size_t begin = trace.size() * s / shards;
+	  size_t end = trace.size() * (s + 1) / shards;
+	  size_t warm_begin = begin - std::min(begin, shard_options.warmup);
+	  ReplayResult &result = sharded.shards[s];
+
+	  std::unique_ptr<BPredUnit> bp;
+	  {
+		std::lock_guard<std::mutex> lock(registration);
+		bp.reset(make());
+	  }
+	  std::unique_ptr<IndirectPredictor> ipred;
+	  if (options.indirect)
+		ipred.reset(indirectPredictor(options.tid + options.threads));
+
+	  auto start = std::chrono::steady_clock::now();
+	  std::vector<Replayer> threads;
+	  for (unsigned t = 0; t < options.threads; t++) {
+		threads.emplace_back(*bp, trace, options.tid + t, result, begin,
+							 &profiles[s], ipred.get());
+	  }
+	  for (size_t i = warm_begin; i < end; i++) {
+		for (Replayer &thread : threads) {
+		  thread.predict(i);
+		  thread.drain(options.depth);
+		}
+	  }
+	  for (Replayer &thread : threads)
+		thread.drain(0);
+	  auto stop = std::chrono::steady_clock::now();
+	  result.seconds = std::chrono::duration<double>(stop - start).count();
+
+	  for (size_t i = begin; i < end; i++)
+		result.instructions += trace.instDelta(i);
+	  result.instructions *= options.threads;
+
+	  std::lock_guard<std::mutex> lock(registration);
+	  bp.reset();
+	}
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  if (workers == 1) {
+	work();
+  } else {
+	std::vector<std::thread> pool;
+	for (unsigned w = 0; w < workers; w++)
+	  pool.emplace_back(work);
+	for (std::thread &thread : pool)
+	  thread.join();
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  ReplayResult &total = sharded.total;
+  for (unsigned s = 0; s < shards; s++) {
+	const ReplayResult &shard = sharded.shards[s];
+	total.branches += shard.branches;
+	total.condBranches += shard.condBranches;
+	total.mispredicts += shard.mispredicts;
+	total.indirectBranches += shard.indirectBranches;
+	total.indirectMispredicts += shard.indirectMispredicts;
+	total.predictions += shard.predictions;
+	total.squashed += shard.squashed;
+	total.predictionCycles += shard.predictionCycles;
+	total.fetchStalls += shard.fetchStalls;
+	total.instructions += shard.instructions;
+	sharded.profile.merge(profiles[s]);
+  }
+  total.seconds = std::chrono::duration<double>(stop - start).count();
+  return sharded;
+}
+
+double
+profileDivergence(const BranchProfile &profile,
+				  const BranchProfile &reference)
+{
+  uint64_t difference = 0, mispredicts = 0;
+  for (const BranchProfile::Entry &entry : reference.sorted()) {
+	const BranchProfile::Entry *match = profile.find(entry.pc);
+	uint64_t other = match ? match->mispredicts : 0;
+	difference += std::llabs((long long)entry.mispredicts -
+							 (long long)other);
+	mispredicts += entry.mispredicts;
+  }
+  // PCs only the profile has are all difference
+  for (const BranchProfile::Entry &entry : profile.sorted()) {
+	if (!reference.find(entry.pc))
+	  difference += entry.mispredicts;
+  }
+  return mispredicts ? (double)difference / mispredicts :
+	(difference ? 1.0 : 0.0);
+}
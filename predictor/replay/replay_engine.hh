@@ -0,0 +1,212 @@
+/*****************************************************************
+ * File: replay_engine.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Drives a BPredUnit through the branches of a trace
+ * with the same lookup/update/squash sequence the gem5 CPU models
+ * issue, optionally keeping branches in flight for a number of
+ * branches before they resolve: header file.
+ ****************************************************************/
+
+#ifndef __REPLAY_REPLAY_ENGINE_HH__
+#define __REPLAY_REPLAY_ENGINE_HH__
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "branch_trace.hh"
+#include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/branch_profile.hh"
+#include "cpu/pred/indirect.hh"
+
+struct ReplayOptions
+{
+  /** Branches predicted after a branch before it resolves; a
+   *  mispredicted branch squashes them and they are predicted again
+   *  (0 resolves every branch straight after its prediction). */
+  unsigned depth = 0;
+
+  /** Number of times the trace is replayed back to back. */
+  unsigned passes = 1;
+
+  /** Thread the branches are issued on. */
+  ThreadID tid = 0;
+
+  /** SMT threads (tid onwards) replaying the trace side by side, the
+   *  threads taking turns branch by branch; the predictor needs at
+   *  least tid + threads threads. */
+  unsigned threads = 1;
+
+  /** Whether indirect jumps and calls also get a target, from gem5's
+   *  IndirectPredictor looking them up with the getGHR() of the
+   *  predictor; a wrong or missing target squashes the younger
+   *  branches like a wrong direction. */
+  bool indirect = false;
+};
+
+struct ShardOptions
+{
+  /** Pieces the trace is cut into, each replayed on a fresh copy of
+   *  the predictor, in parallel. */
+  unsigned shards = 1;
+
+  /** Branches before its start a shard warms its copy on without
+   *  counting them, taken from the end of the previous shard. */
+  size_t warmup = 0;
+
+  /** Slots of the per-PC profile of every shard and of the merged
+   *  one (see BranchProfile::init). */
+  unsigned profileSize = 1 << 16;
+};
+
+struct ReplayResult
+{
+  /** Branches resolved, conditional or not */
+  uint64_t branches = 0;
+
+  /** Conditional branches resolved */
+  uint64_t condBranches = 0;
+
+  /** Conditional branches resolved against their prediction */
+  uint64_t mispredicts = 0;
+
+  /** Indirect jumps and calls resolved, and those whose target was
+   *  wrong or missing, with ReplayOptions::indirect */
+  uint64_t indirectBranches = 0;
+  uint64_t indirectMispredicts = 0;
+
+  /** Calls to lookup/uncondBranch, re-predictions after squashes
+   *  included */
+  uint64_t predictions = 0;
+
+  /** Branches squashed by an older misprediction */
+  uint64_t squashed = 0;
+
+  /** Cycles the conditional predictions (re-predictions included)
+   *  took by the latency model of the predictor, 0 without one
+   *  (NeuroPathBP::predictionLatency()) */
+  uint64_t predictionCycles = 0;
+
+  /** Cycles a fetch stage predicting a branch a cycle would have
+   *  stalled waiting for those predictions, i.e. every cycle of a
+   *  prediction past the first */
+  uint64_t fetchStalls = 0;
+
+  /** Instructions covered by the replay */
+  uint64_t instructions = 0;
+
+  /** Wall-clock time spent driving the predictor */
+  double seconds = 0;
+
+  /** Mispredictions per thousand instructions. */
+  double
+  mpki() const
+  {
+	return instructions ? 1000.0 * mispredicts / instructions : 0;
+  }
+
+  /** Fraction of conditional branches predicted correctly. */
+  double
+  accuracy() const
+  {
+	return condBranches ? 1.0 - (double)mispredicts / condBranches : 0;
+  }
+
+  /** Predictions made per second of replay. */
+  double
+  predictionsPerSecond() const
+  {
+	return seconds > 0 ? predictions / seconds : 0;
+  }
+
+  /** Fetch stall cycles per thousand instructions. */
+  double
+  stallsPerKilo() const
+  {
+	return instructions ? 1000.0 * fetchStalls / instructions : 0;
+  }
+};
+
+/**
+ * Replays a trace through a predictor.
+ * @param bp Predictor to drive, trained in place.
+ * @param trace Branches to replay.
+ * @param options Pipeline depth, passes and threads.
+ * @param profile Initialised profile to count the conditional branches
+ * and mispredictions of every PC into, if any.
+ * @return Prediction counts and timing of the replay.
+ */
+ReplayResult replayTrace(BPredUnit &bp, const BranchTrace &trace,
+						 const ReplayOptions &options,
+						 BranchProfile *profile = NULL);
+
+/**
+ * Replays a trace through many predictors (e.g. the points of a
+ * parameter sweep) in one pass over the decoded trace: the trace is
+ * walked in blocks, and each block is fed to every predictor of a
+ * worker while it is still in cache. The predictors are spread over
+ * worker threads, each predictor driven by a single worker.
+ * @param bps Predictors to drive, trained in place.
+ * @param trace Branches to replay.
+ * @param options Pipeline depth, passes and threads of every replay.
+ * @param workers Host threads to use, 0 for one per core.
+ * @param profiles Profile of each predictor, as for replayTrace(); none
+ * when empty, otherwise one per predictor, NULL for none.
+ * @return The result of every predictor, in the order of bps.
+ */
+std::vector<ReplayResult> replayBatch(
+	const std::vector<BPredUnit *> &bps, const BranchTrace &trace,
+	const ReplayOptions &options, unsigned workers,
+	const std::vector<BranchProfile *> &profiles = {});
+
+/** Builds and readies a new copy of the predictor of a replay. */
+typedef std::function<BPredUnit *()> PredictorMaker;
+
+struct ShardedResult
+{
+  /** Counts of every shard added up; seconds is the wall-clock time
+   *  of the whole replay */
+  ReplayResult total;
+
+  /** Counts of each shard, in trace order */
+  std::vector<ReplayResult> shards;
+
+  /** Per-PC counts of every shard added up */
+  BranchProfile profile;
+};
+
+/**
+ * Replays a trace cut into shards, each on its own copy of the
+ * predictor warmed on the branches just before the shard: the copies
+ * start cold, so the counts approximate those of a serial replay, and
+ * more closely the longer the warmup. Idle workers take the next shard
+ * left, so shards of uneven cost balance out. One shard with no
+ * warmup is exactly the serial replay.
+ * @param make Builds the copy of each shard; it is called, and the
+ * copy destroyed, with the other workers held off, since predictors
+ * register their stats globally.
+ * @param trace Branches to replay.
+ * @param options Pipeline depth and threads of every shard; a single
+ * pass is replayed.
+ * @param shard_options Number of shards, warmup length and profile
+ * size.
+ * @param workers Host threads to use, 0 for one per core.
+ * @return The merged counts and per-PC profile of the shards.
+ */
+ShardedResult replaySharded(const PredictorMaker &make,
+							const BranchTrace &trace,
+							const ReplayOptions &options,
+							const ShardOptions &shard_options,
+							unsigned workers);
+
+/**
+ * How far the per-PC mispredictions of a replay are from a reference
+ * replay of the same trace: the sum over the PCs of the absolute
+ * differences, over the mispredictions of the reference.
+ */
+double profileDivergence(const BranchProfile &profile,
+						 const BranchProfile &reference);
+
+#endif // __REPLAY_REPLAY_ENGINE_HH__
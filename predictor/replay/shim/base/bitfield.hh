@@ -0,0 +1,21 @@
+/*****************************************************************
+ * File: bitfield.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's base/bitfield.hh for trace
+ * replay.
+ ****************************************************************/
+
+#ifndef __BASE_BITFIELD_HH__
+#define __BASE_BITFIELD_HH__
+
+#include <cstdint>
+
+/** Mask with the low nbits bits set. */
+inline uint64_t
+mask(int nbits)
+{
+  return (nbits >= 64) ? (uint64_t)-1LL : (1ULL << nbits) - 1;
+}
+
+#endif // __BASE_BITFIELD_HH__
@@ -0,0 +1,54 @@
+/*****************************************************************
+ * File: callback.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's base/callback.hh for trace
+ * replay. Unlike gem5, whose SimObjects live until the simulator
+ * exits, the replay destroys predictors (sweeps, shards), so a
+ * callback takes itself off the exit callbacks when destroyed.
+ ****************************************************************/
+
+#ifndef __BASE_CALLBACK_HH__
+#define __BASE_CALLBACK_HH__
+
+#include <algorithm>
+#include <vector>
+
+class Callback;
+
+/** Callbacks registerExitCallback() was given, in order. */
+inline std::vector<Callback *> &
+exitCallbacks()
+{
+  static std::vector<Callback *> callbacks;
+  return callbacks;
+}
+
+class Callback
+{
+public:
+  virtual ~Callback()
+  {
+	std::vector<Callback *> &callbacks = exitCallbacks();
+	callbacks.erase(std::remove(callbacks.begin(), callbacks.end(), this),
+					callbacks.end());
+  }
+
+  virtual void process() = 0;
+};
+
+/** Callback calling a member function of an object. */
+template <class T, void (T::* F)()>
+class MakeCallback : public Callback
+{
+private:
+  T *object;
+
+public:
+  MakeCallback(T *o) : object(o) { }
+  MakeCallback(T &o) : object(&o) { }
+
+  void process() { (object->*F)(); }
+};
+
+#endif // __BASE_CALLBACK_HH__
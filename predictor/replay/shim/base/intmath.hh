@@ -0,0 +1,46 @@
+/*****************************************************************
+ * File: intmath.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's base/intmath.hh for trace
+ * replay, same semantics as the gem5 helpers.
+ ****************************************************************/
+
+#ifndef __BASE_INTMATH_HH__
+#define __BASE_INTMATH_HH__
+
+#include <cstdint>
+
+template <class T>
+inline bool
+isPowerOf2(const T &n)
+{
+  return n != 0 && ((n & (n - 1)) == 0);
+}
+
+inline int
+floorLog2(uint64_t x)
+{
+  int y = 0;
+  while (x >>= 1)
+	y++;
+  return y;
+}
+
+template <class T>
+inline int
+ceilLog2(const T &n)
+{
+  if (n == 1)
+	return 0;
+  return floorLog2(n - (T)1) + 1;
+}
+
+template <class T, class U>
+inline T
+divCeil(const T &a, const U &b)
+{
+  return (a + b - 1) / b;
+}
+
+#endif // __BASE_INTMATH_HH__
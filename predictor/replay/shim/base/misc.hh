@@ -0,0 +1,29 @@
+/*****************************************************************
+ * File: misc.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's base/misc.hh error reporting
+ * for trace replay: fatal() exits, panic() aborts.
+ ****************************************************************/
+
+#ifndef __BASE_MISC_HH__
+#define __BASE_MISC_HH__
+
+#include <cstdio>
+#include <cstdlib>
+
+#define fatal(...) do {                         \
+	fprintf(stderr, "fatal: " __VA_ARGS__);     \
+	exit(1);                                    \
+  } while (0)
+
+#define panic(...) do {                         \
+	fprintf(stderr, "panic: " __VA_ARGS__);     \
+	abort();                                    \
+  } while (0)
+
+#define warn(...) do {                          \
+	fprintf(stderr, "warn: " __VA_ARGS__);      \
+  } while (0)
+
+#endif // __BASE_MISC_HH__
@@ -0,0 +1,27 @@
+/*****************************************************************
+ * File: output.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's base/output.hh for trace
+ * replay, whose output directory is the working directory.
+ ****************************************************************/
+
+#ifndef __BASE_OUTPUT_HH__
+#define __BASE_OUTPUT_HH__
+
+#include <string>
+
+class OutputDirectory
+{
+public:
+  OutputDirectory() { }
+
+  /** Path of a file of the output directory; absolute paths are
+   *  kept as they are, as by gem5. */
+  std::string resolve(const std::string &name) const { return name; }
+};
+
+/** Output directory of the simulation (--outdir in gem5). */
+static const OutputDirectory simout;
+
+#endif // __BASE_OUTPUT_HH__
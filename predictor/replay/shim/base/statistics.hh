@@ -0,0 +1,233 @@
+/*****************************************************************
+ * File: statistics.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for the part of gem5's Stats package the
+ * predictors use for trace replay: Scalar, Histogram and Formula
+ * with the name/desc/precision/init chaining, and dump() writing
+ * the named stats in the stats.txt layout. Histograms keep their
+ * moments but not their buckets.
+ ****************************************************************/
+
+#ifndef __BASE_STATISTICS_HH__
+#define __BASE_STATISTICS_HH__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Stats
+{
+  typedef double Counter;
+
+  class Info;
+
+  /** Every stat given a name, in registration order. */
+  inline std::vector<Info *> &
+  registry()
+  {
+	static std::vector<Info *> stats;
+	return stats;
+  }
+
+  /** Name, description and output format of one stat. */
+  class Info
+  {
+  public:
+	Info() : registered(false), digits(0) { }
+	Info(const Info &) = delete;
+	Info &operator=(const Info &) = delete;
+
+	virtual
+	~Info()
+	{
+	  std::vector<Info *> &stats = registry();
+	  if (registered)
+		stats.erase(std::find(stats.begin(), stats.end(), this));
+	}
+
+	/** Writes the stat as one or more stats.txt lines. */
+	virtual void print(FILE *out) const = 0;
+
+	const std::string &statName() const { return _name; }
+
+  protected:
+	void
+	setName(const std::string &name)
+	{
+	  _name = name;
+	  if (!registered)
+		registry().push_back(this);
+	  registered = true;
+	}
+
+	void
+	line(FILE *out, const std::string &suffix, double value) const
+	{
+	  std::string full = _name + suffix;
+	  fprintf(out, "%-40s %12.*f  # %s\n", full.c_str(), digits, value,
+			  _desc.c_str());
+	}
+
+	bool registered;
+	std::string _name;
+	std::string _desc;
+	int digits;
+  };
+
+  /** Chaining setters shared by every stat type. */
+  template <class Derived>
+  class DataWrap : public Info
+  {
+  public:
+	Derived &
+	name(const std::string &name)
+	{
+	  setName(name);
+	  return self();
+	}
+
+	Derived &
+	desc(const std::string &desc)
+	{
+	  _desc = desc;
+	  return self();
+	}
+
+	Derived &
+	precision(int digits)
+	{
+	  this->digits = digits;
+	  return self();
+	}
+
+  protected:
+	Derived &self() { return *static_cast<Derived *>(this); }
+  };
+
+  /** Deferred value of a formula expression. */
+  struct Temp
+  {
+	std::function<Counter()> value;
+  };
+
+  class Scalar : public DataWrap<Scalar>
+  {
+  public:
+	Scalar() : count(0) { }
+
+	Scalar &operator++() { ++count; return *this; }
+	Scalar &operator+=(Counter v) { count += v; return *this; }
+
+	Counter value() const { return count; }
+
+	operator Temp() const { return Temp{[this]() { return count; }}; }
+
+	void print(FILE *out) const { line(out, "", count); }
+
+  private:
+	Counter count;
+  };
+
+  class Histogram : public DataWrap<Histogram>
+  {
+  public:
+	Histogram()
+	  : samples(0), sum(0), squares(0), minValue(0), maxValue(0)
+	{ }
+
+	/** Buckets are not modelled, the size is only accepted. */
+	Histogram &init(unsigned size) { return *this; }
+
+	void
+	sample(Counter v, int n = 1)
+	{
+	  minValue = samples ? std::min(minValue, v) : v;
+	  maxValue = samples ? std::max(maxValue, v) : v;
+	  samples += n;
+	  sum += v * n;
+	  squares += v * v * n;
+	}
+
+	void
+	print(FILE *out) const
+	{
+	  double mean = samples ? sum / samples : 0;
+	  double var = samples > 1 ?
+		(squares - sum * mean) / (samples - 1) : 0;
+	  line(out, "::samples", samples);
+	  line(out, "::mean", mean);
+	  line(out, "::stdev", std::sqrt(std::max(var, 0.0)));
+	  line(out, "::min", minValue);
+	  line(out, "::max", maxValue);
+	  line(out, "::total", sum);
+	}
+
+  private:
+	Counter samples;
+	Counter sum;
+	Counter squares;
+	Counter minValue;
+	Counter maxValue;
+  };
+
+  class Formula : public DataWrap<Formula>
+  {
+  public:
+	Formula &
+	operator=(const Temp &expr)
+	{
+	  value = expr.value;
+	  return *this;
+	}
+
+	void
+	print(FILE *out) const
+	{
+	  double v = value ? value() : 0;
+	  line(out, "", std::isfinite(v) ? v : 0);
+	}
+
+  private:
+	std::function<Counter()> value;
+  };
+
+  inline Temp
+  operator+(const Temp &a, const Temp &b)
+  {
+	std::function<Counter()> l = a.value, r = b.value;
+	return Temp{[l, r]() { return l() + r(); }};
+  }
+
+  inline Temp
+  operator/(const Temp &a, const Temp &b)
+  {
+	std::function<Counter()> l = a.value, r = b.value;
+	return Temp{[l, r]() { return l() / r(); }};
+  }
+
+  inline Temp
+  operator+(const Scalar &a, const Scalar &b)
+  {
+	return Temp(a) + Temp(b);
+  }
+
+  inline Temp
+  operator/(const Scalar &a, const Scalar &b)
+  {
+	return Temp(a) / Temp(b);
+  }
+
+  /** Writes every named stat in the stats.txt layout. */
+  inline void
+  dump(FILE *out)
+  {
+	for (const Info *info : registry())
+	  info->print(out);
+  }
+}
+
+#endif // __BASE_STATISTICS_HH__
@@ -0,0 +1,14 @@
+/*****************************************************************
+ * File: trace.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's base/trace.hh for trace replay;
+ * debug printing compiles away.
+ ****************************************************************/
+
+#ifndef __BASE_TRACE_HH__
+#define __BASE_TRACE_HH__
+
+#define DPRINTF(...) do { } while (0)
+
+#endif // __BASE_TRACE_HH__
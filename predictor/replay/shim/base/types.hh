@@ -0,0 +1,22 @@
+/*****************************************************************
+ * File: types.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's base/types.hh, providing just
+ * the types the branch predictors use so they can be built for
+ * trace replay without a full gem5 build.
+ ****************************************************************/
+
+#ifndef __BASE_TYPES_HH__
+#define __BASE_TYPES_HH__
+
+#include <cassert>
+#include <cstdint>
+
+typedef uint64_t Addr;
+typedef int16_t ThreadID;
+typedef uint64_t Counter;
+
+#define ULL(N) ((uint64_t)N##ULL)
+
+#endif // __BASE_TYPES_HH__
@@ -0,0 +1,17 @@
+/*****************************************************************
+ * File: inst_seq.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's cpu/inst_seq.hh for trace
+ * replay, where the index of a branch in the trace serves as its
+ * sequence number.
+ ****************************************************************/
+
+#ifndef __STD_TYPES_HH__
+#define __STD_TYPES_HH__
+
+#include <stdint.h>
+
+typedef uint64_t InstSeqNum;
+
+#endif // __STD_TYPES_HH__
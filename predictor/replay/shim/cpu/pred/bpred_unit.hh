@@ -0,0 +1,79 @@
+/*****************************************************************
+ * File: bpred_unit.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's BPredUnit for trace replay. It
+ * keeps the direction predictor interface (lookup, uncondBranch,
+ * btbUpdate, update, squash, getGHR) with the same signatures and
+ * drops the BTB, RAS and indirect predictor the replay does not
+ * model, as well as the stats BPredUnit registers itself.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_BPRED_UNIT_HH__
+#define __CPU_PRED_BPRED_UNIT_HH__
+
+#include <string>
+
+#include "base/misc.hh"
+#include "base/types.hh"
+#include "sim/serialize.hh"
+
+struct BranchPredictorParams
+{
+  std::string name = "branchPred";
+  unsigned numThreads = 1;
+  unsigned instShiftAmt = 2;
+};
+
+class BPredUnit
+{
+public:
+  typedef BranchPredictorParams Params;
+
+  BPredUnit(const Params *params)
+	: _name(params->name), instShiftAmt(params->instShiftAmt)
+  { }
+
+  virtual ~BPredUnit() { }
+
+  virtual bool lookup(ThreadID tid, Addr instPC, void * &bp_history) = 0;
+
+  virtual void uncondBranch(ThreadID tid, Addr pc,
+							void * &bp_history) = 0;
+
+  virtual void btbUpdate(ThreadID tid, Addr instPC,
+						 void * &bp_history) = 0;
+
+  virtual void update(ThreadID tid, Addr instPC, bool taken,
+					  void *bp_history, bool squashed) = 0;
+
+  virtual void squash(ThreadID tid, void *bp_history) = 0;
+
+  virtual unsigned getGHR(ThreadID tid, void *bp_history) const
+  {
+	return 0;
+  }
+
+  /** Called once every object is built, before any checkpoint is
+   *  restored. */
+  virtual void init() { }
+
+  /** Saves and restores the predictor state, see sim/serialize.hh. */
+  virtual void serialize(CheckpointOut &cp) const { }
+  virtual void unserialize(CheckpointIn &cp) { }
+
+  /** Registers the stats of the predictor; gem5 calls this once the
+   *  simulated system is built, the replay right after creating it. */
+  virtual void regStats() { }
+
+  const std::string &name() const { return _name; }
+
+private:
+  std::string _name;
+
+protected:
+  /** Number of bits to shift instructions by for predictor addresses */
+  const unsigned instShiftAmt;
+};
+
+#endif // __CPU_PRED_BPRED_UNIT_HH__
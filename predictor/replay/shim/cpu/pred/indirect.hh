@@ -0,0 +1,179 @@
+/*****************************************************************
+ * File: indirect.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's IndirectPredictor for trace
+ * replay, the set-associative target cache BPredUnit owns and
+ * indexes with the branch PC, the getGHR() of the direction
+ * predictor and the targets of the previous indirect branches.
+ * Targets are plain addresses rather than TheISA::PCState, and
+ * a full set replaces its ways round robin.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_INDIRECT_HH__
+#define __CPU_PRED_INDIRECT_HH__
+
+#include <deque>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+#include "cpu/inst_seq.hh"
+
+class IndirectPredictor
+{
+public:
+  /** Defaults of the indirect* params of gem5's BranchPredictor.py */
+  IndirectPredictor(bool hash_ghr = true, bool hash_targets = true,
+					unsigned num_sets = 256, unsigned num_ways = 2,
+					unsigned tag_bits = 16, unsigned path_len = 3,
+					unsigned inst_shift = 2, unsigned num_threads = 1)
+	: hashGHR(hash_ghr), hashTargets(hash_targets), numSets(num_sets),
+	  numWays(num_ways), tagBits(tag_bits), pathLength(path_len),
+	  instShift(inst_shift), threadInfo(num_threads),
+	  targetCache(num_sets, std::vector<IPredEntry>(num_ways)),
+	  nextWay(num_sets, 0)
+  {
+	assert(isPowerOf2(num_sets) && num_ways > 0 && path_len > 0);
+  }
+
+  /**
+   * Predicts the target of an indirect branch.
+   * @param ghr getGHR() of the direction predictor for the branch.
+   * @param target Set to the predicted target on a hit.
+   * @return Whether the target cache had a target for the branch.
+   */
+  bool
+  lookup(Addr br_addr, unsigned ghr, Addr &target, ThreadID tid)
+  {
+	Addr set_index = getSetIndex(br_addr, ghr, tid);
+	Addr tag = getTag(br_addr);
+	for (const IPredEntry &entry : targetCache[set_index]) {
+	  if (entry.valid && entry.tag == tag) {
+		target = entry.target;
+		return true;
+	  }
+	}
+	return false;
+  }
+
+  /**
+   * Records an indirect branch just predicted, with the GHR it was
+   * looked up with and its predicted target, youngest last.
+   */
+  void
+  recordIndirect(Addr br_addr, Addr tgt_addr, unsigned ghr,
+				 InstSeqNum seq_num, ThreadID tid)
+  {
+	threadInfo[tid].pathHist.push_back(
+	  HistoryEntry{br_addr, tgt_addr, ghr, seq_num});
+  }
+
+  /** Retires the recorded branches up to seq_num, keeping the targets
+   *  of the last pathLength for the set index. */
+  void
+  commit(InstSeqNum seq_num, ThreadID tid)
+  {
+	std::deque<HistoryEntry> &path = threadInfo[tid].pathHist;
+	while (path.size() > pathLength && path.front().seqNum <= seq_num)
+	  path.pop_front();
+  }
+
+  /** Drops the recorded branches younger than seq_num. */
+  void
+  squash(InstSeqNum seq_num, ThreadID tid)
+  {
+	std::deque<HistoryEntry> &path = threadInfo[tid].pathHist;
+	while (!path.empty() && path.back().seqNum > seq_num)
+	  path.pop_back();
+  }
+
+  /**
+   * Writes the resolved target of the youngest recorded branch, which
+   * is seq_num once the branches after it are squashed, into its set.
+   */
+  void
+  recordTarget(InstSeqNum seq_num, Addr target, ThreadID tid)
+  {
+	std::deque<HistoryEntry> &path = threadInfo[tid].pathHist;
+	assert(!path.empty() && path.back().seqNum == seq_num);
+
+	// the set is the one the branch was looked up in, before its own
+	// target entered the path
+	HistoryEntry entry = path.back();
+	path.pop_back();
+	Addr set_index = getSetIndex(entry.pcAddr, entry.ghr, tid);
+	Addr tag = getTag(entry.pcAddr);
+	entry.targetAddr = target;
+	path.push_back(entry);
+
+	std::vector<IPredEntry> &set = targetCache[set_index];
+	for (IPredEntry &way : set) {
+	  if (way.valid && way.tag == tag) {
+		way.target = target;
+		return;
+	  }
+	}
+	IPredEntry &victim = set[nextWay[set_index]];
+	nextWay[set_index] = (nextWay[set_index] + 1) % numWays;
+	victim = IPredEntry{true, tag, target};
+  }
+
+private:
+  struct HistoryEntry {
+	Addr pcAddr;
+	Addr targetAddr;
+	unsigned ghr;
+	InstSeqNum seqNum;
+  };
+
+  struct IPredEntry {
+	bool valid;
+	Addr tag;
+	Addr target;
+  };
+
+  struct ThreadInfo {
+	std::deque<HistoryEntry> pathHist;
+  };
+
+  /** The PC, hashed with the GHR and the recent targets as gem5 does. */
+  Addr
+  getSetIndex(Addr br_addr, unsigned ghr, ThreadID tid) const
+  {
+	Addr hash = br_addr >> instShift;
+	if (hashGHR)
+	  hash ^= ghr;
+	if (hashTargets) {
+	  const std::deque<HistoryEntry> &path = threadInfo[tid].pathHist;
+	  unsigned hash_shift = floorLog2(numSets) / pathLength;
+	  unsigned p = 0;
+	  for (auto it = path.rbegin(); it != path.rend() && p < pathLength;
+		   ++it, ++p)
+		hash ^= it->targetAddr >> (instShift + p * hash_shift);
+	}
+	return hash & (numSets - 1);
+  }
+
+  Addr
+  getTag(Addr br_addr) const
+  {
+	return (br_addr >> instShift) & ((Addr(1) << tagBits) - 1);
+  }
+
+  const bool hashGHR;
+  const bool hashTargets;
+  const unsigned numSets;
+  const unsigned numWays;
+  const unsigned tagBits;
+  const unsigned pathLength;
+  const unsigned instShift;
+
+  std::vector<ThreadInfo> threadInfo;
+  std::vector<std::vector<IPredEntry>> targetCache;
+
+  /** Way each set replaces next */
+  std::vector<unsigned> nextWay;
+};
+
+#endif // __CPU_PRED_INDIRECT_HH__
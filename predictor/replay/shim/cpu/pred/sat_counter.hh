@@ -0,0 +1,43 @@
+/*****************************************************************
+ * File: sat_counter.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's SatCounter for trace replay.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_SAT_COUNTER_HH__
+#define __CPU_PRED_SAT_COUNTER_HH__
+
+#include <cstdint>
+
+class SatCounter
+{
+public:
+  SatCounter() : initialVal(0), maxVal(0), counter(0) { }
+
+  SatCounter(unsigned bits)
+	: initialVal(0), maxVal((1 << bits) - 1), counter(0)
+  { }
+
+  SatCounter(unsigned bits, uint8_t initial_val)
+	: initialVal(initial_val), maxVal((1 << bits) - 1),
+	  counter(initial_val)
+  { }
+
+  void setBits(unsigned bits) { maxVal = (1 << bits) - 1; }
+
+  void reset() { counter = initialVal; }
+
+  void increment() { if (counter < maxVal) ++counter; }
+
+  void decrement() { if (counter > 0) --counter; }
+
+  uint8_t read() const { return counter; }
+
+private:
+  uint8_t initialVal;
+  uint8_t maxVal;
+  uint8_t counter;
+};
+
+#endif // __CPU_PRED_SAT_COUNTER_HH__
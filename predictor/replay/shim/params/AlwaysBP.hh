@@ -0,0 +1,21 @@
+/*****************************************************************
+ * File: AlwaysBP.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for the scons-generated AlwaysBP params,
+ * defaults matching BranchPredictor.py.
+ ****************************************************************/
+
+#ifndef __PARAMS__AlwaysBP__
+#define __PARAMS__AlwaysBP__
+
+#include "cpu/pred/bpred_unit.hh"
+
+class AlwaysBP;
+
+struct AlwaysBPParams : public BranchPredictorParams
+{
+  AlwaysBP *create();
+};
+
+#endif // __PARAMS__AlwaysBP__
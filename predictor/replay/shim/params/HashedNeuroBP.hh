@@ -0,0 +1,24 @@
+/*****************************************************************
+ * File: HashedNeuroBP.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for the scons-generated HashedNeuroBP
+ * params, defaults matching BranchPredictor.py.
+ ****************************************************************/
+
+#ifndef __PARAMS__HashedNeuroBP__
+#define __PARAMS__HashedNeuroBP__
+
+#include "params/NeuroBP.hh"
+
+class HashedNeuroBP;
+
+struct HashedNeuroBPParams : public NeuroBPParams
+{
+  unsigned numTables = 8;
+  unsigned logTableSize = 10;
+
+  HashedNeuroBP *create();
+};
+
+#endif // __PARAMS__HashedNeuroBP__
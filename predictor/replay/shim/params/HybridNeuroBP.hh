@@ -0,0 +1,29 @@
+/*****************************************************************
+ * File: HybridNeuroBP.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for the scons-generated HybridNeuroBP
+ * params, defaults matching BranchPredictor.py.
+ ****************************************************************/
+
+#ifndef __PARAMS__HybridNeuroBP__
+#define __PARAMS__HybridNeuroBP__
+
+#include "cpu/pred/bpred_unit.hh"
+
+class HybridNeuroBP;
+
+struct HybridNeuroBPParams : public BranchPredictorParams
+{
+  /** Built by the replay factory, as gem5 builds child SimObjects */
+  BPredUnit *perceptron = NULL;
+  unsigned bimodalSize = 4096;
+  unsigned bimodalCtrBits = 2;
+  unsigned chooserSize = 4096;
+  unsigned chooserCtrBits = 2;
+  unsigned historyPoolSize = 192;
+
+  HybridNeuroBP *create();
+};
+
+#endif // __PARAMS__HybridNeuroBP__
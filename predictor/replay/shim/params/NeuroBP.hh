@@ -0,0 +1,39 @@
+/*****************************************************************
+ * File: NeuroBP.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for the scons-generated NeuroBP params,
+ * defaults matching BranchPredictor.py.
+ ****************************************************************/
+
+#ifndef __PARAMS__NeuroBP__
+#define __PARAMS__NeuroBP__
+
+#include "cpu/pred/bpred_unit.hh"
+
+class NeuroBP;
+
+struct NeuroBPParams : public BranchPredictorParams
+{
+  unsigned historyLength = 64;
+  unsigned numPerceptrons = 20;
+  unsigned globalCtrBits = 2;
+  unsigned weightBits = 8;
+  unsigned historyPoolSize = 192;
+  bool detailedStats = false;
+  std::string weightsFile;
+  bool sharedWeights = true;
+  bool specializedKernels = true;
+  unsigned updateDelay = 0;
+  unsigned updateBufferRows = 16;
+  bool earlyExit = false;
+  unsigned associativity = 0;
+  unsigned tagBits = 8;
+  std::string replacement = "lru";
+  unsigned profileSize = 0;
+  std::string profileFile;
+
+  NeuroBP *create();
+};
+
+#endif // __PARAMS__NeuroBP__
@@ -0,0 +1,39 @@
+/*****************************************************************
+ * File: NeuroPathBP.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for the scons-generated NeuroPathBP params,
+ * defaults matching BranchPredictor.py.
+ ****************************************************************/
+
+#ifndef __PARAMS__NeuroPathBP__
+#define __PARAMS__NeuroPathBP__
+
+#include "cpu/pred/bpred_unit.hh"
+
+class NeuroPathBP;
+
+struct NeuroPathBPParams : public BranchPredictorParams
+{
+  unsigned historyLength = 64;
+  unsigned numPerceptrons = 10;
+  unsigned globalCtrBits = 2;
+  unsigned weightBits = 8;
+  unsigned historyPoolSize = 192;
+  bool detailedStats = false;
+  std::string weightsFile;
+  bool sharedWeights = true;
+  bool specializedKernels = true;
+  unsigned updateDelay = 0;
+  unsigned updateBufferRows = 16;
+  bool aheadPipelined = true;
+  unsigned lookupLatency = 1;
+  unsigned adderLevelsPerCycle = 2;
+  unsigned indirectPathLength = 16;
+  unsigned profileSize = 0;
+  std::string profileFile;
+
+  NeuroPathBP *create();
+};
+
+#endif // __PARAMS__NeuroPathBP__
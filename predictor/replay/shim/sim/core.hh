@@ -0,0 +1,34 @@
+/*****************************************************************
+ * File: core.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for the exit callbacks of gem5's
+ * sim/core.hh for trace replay, which runs them at the end of
+ * main() as gem5 does when its Python side exits.
+ ****************************************************************/
+
+#ifndef __SIM_CORE_HH__
+#define __SIM_CORE_HH__
+
+#include <vector>
+
+#include "base/callback.hh"
+
+/** Registers a callback to run when the simulation exits. */
+inline void
+registerExitCallback(Callback *callback)
+{
+  exitCallbacks().push_back(callback);
+}
+
+/** Runs the exit callbacks, each once. */
+inline void
+doExitCleanup()
+{
+  std::vector<Callback *> callbacks;
+  callbacks.swap(exitCallbacks());
+  for (Callback *callback : callbacks)
+	callback->process();
+}
+
+#endif // __SIM_CORE_HH__
@@ -0,0 +1,225 @@
+/*****************************************************************
+ * File: serialize.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Stand-in for gem5's checkpointing for trace replay:
+ * paramOut/paramIn, arrayParamOut/arrayParamIn and the SERIALIZE
+ * macros over an m5.cpt-style ini file of [section] key=value
+ * lines, values of arrays separated by spaces.
+ ****************************************************************/
+
+#ifndef __SERIALIZE_HH__
+#define __SERIALIZE_HH__
+
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "base/misc.hh"
+
+typedef std::ostream CheckpointOut;
+
+class CheckpointIn
+{
+public:
+  /** Name of the checkpoint file within its directory. */
+  static const char *baseFilename() { return "m5.cpt"; }
+
+  /**
+   * Reads the m5.cpt file of a checkpoint directory.
+   * @param cpt_dir Directory the checkpoint was written to.
+   */
+  CheckpointIn(const std::string &cpt_dir)
+	: cptDir(cpt_dir)
+  {
+	setDir(cpt_dir);
+	std::string path = cptDir + "/" + baseFilename();
+	std::ifstream in(path.c_str());
+	if (!in)
+	  fatal("Can't open checkpoint file %s!\n", path.c_str());
+
+	std::string line, section;
+	while (std::getline(in, line)) {
+	  if (line.empty() || line[0] == '#')
+		continue;
+	  if (line[0] == '[') {
+		section = line.substr(1, line.find(']') - 1);
+		continue;
+	  }
+	  size_t eq = line.find('=');
+	  if (eq != std::string::npos)
+		entries[section][line.substr(0, eq)] = line.substr(eq + 1);
+	}
+  }
+
+  /** Looks up an entry, false if the section or entry is missing. */
+  bool
+  find(const std::string &section, const std::string &entry,
+	   std::string &value) const
+  {
+	auto s = entries.find(section);
+	if (s == entries.end())
+	  return false;
+	auto e = s->second.find(entry);
+	if (e == s->second.end())
+	  return false;
+	value = e->second;
+	return true;
+  }
+
+  /** Directory of the checkpoint being written or read. */
+  static std::string &
+  dir()
+  {
+	static std::string current;
+	return current;
+  }
+
+  /** Sets the directory files next to the checkpoint go to. */
+  static std::string
+  setDir(const std::string &name)
+  {
+	return dir() = name;
+  }
+
+  const std::string cptDir;
+
+private:
+  std::map<std::string, std::map<std::string, std::string>> entries;
+};
+
+class Serializable
+{
+public:
+  /** Section the paramIn/paramOut calls currently refer to. */
+  static std::string &
+  currentSection()
+  {
+	static std::string section;
+	return section;
+  }
+
+  /** Scopes the entries of one object under its [section]. */
+  class ScopedCheckpointSection
+  {
+  public:
+	ScopedCheckpointSection(CheckpointOut &cp, const std::string &name)
+	  : saved(currentSection())
+	{
+	  currentSection() = name;
+	  cp << "\n[" << name << "]\n";
+	}
+
+	ScopedCheckpointSection(CheckpointIn &cp, const std::string &name)
+	  : saved(currentSection())
+	{
+	  currentSection() = name;
+	}
+
+	~ScopedCheckpointSection() { currentSection() = saved; }
+
+  private:
+	std::string saved;
+  };
+};
+
+template <class T>
+void
+paramOut(CheckpointOut &os, const std::string &name, const T &param)
+{
+  os << name << "=" << +param << "\n";
+}
+
+inline void
+paramOut(CheckpointOut &os, const std::string &name,
+		 const std::string &param)
+{
+  os << name << "=" << param << "\n";
+}
+
+template <class T>
+void
+arrayParamOut(CheckpointOut &os, const std::string &name, const T *param,
+			  unsigned size)
+{
+  os << name << "=";
+  for (unsigned i = 0; i < size; i++)
+	os << (i ? " " : "") << +param[i];
+  os << "\n";
+}
+
+template <class T>
+void
+arrayParamOut(CheckpointOut &os, const std::string &name,
+			  const std::vector<T> &param)
+{
+  arrayParamOut(os, name, param.data(), param.size());
+}
+
+/** Raw text of an entry of the current section, fatal if missing. */
+inline std::string
+paramText(CheckpointIn &cp, const std::string &name)
+{
+  std::string value;
+  if (!cp.find(Serializable::currentSection(), name, value))
+	fatal("Can't unserialize '%s:%s'\n",
+		  Serializable::currentSection().c_str(), name.c_str());
+  return value;
+}
+
+/** Reads the next number of a value, as signed or unsigned as T. */
+template <class T>
+bool
+parseParam(std::istringstream &in, T &param)
+{
+  if (std::is_signed<T>::value) {
+	long long value;
+	if (!(in >> value))
+	  return false;
+	param = value;
+  } else {
+	unsigned long long value;
+	if (!(in >> value))
+	  return false;
+	param = value;
+  }
+  return true;
+}
+
+template <class T>
+void
+paramIn(CheckpointIn &cp, const std::string &name, T &param)
+{
+  std::istringstream in(paramText(cp, name));
+  if (!parseParam(in, param))
+	fatal("Can't unserialize '%s'\n", name.c_str());
+}
+
+inline void
+paramIn(CheckpointIn &cp, const std::string &name, std::string &param)
+{
+  param = paramText(cp, name);
+}
+
+template <class T>
+void
+arrayParamIn(CheckpointIn &cp, const std::string &name,
+			 std::vector<T> &param)
+{
+  std::istringstream in(paramText(cp, name));
+  param.clear();
+  T value;
+  while (parseParam(in, value))
+	param.push_back(value);
+}
+
+#define SERIALIZE_SCALAR(scalar)        paramOut(cp, #scalar, scalar)
+#define UNSERIALIZE_SCALAR(scalar)      paramIn(cp, #scalar, scalar)
+#define SERIALIZE_CONTAINER(member)     arrayParamOut(cp, #member, member)
+#define UNSERIALIZE_CONTAINER(member)   arrayParamIn(cp, #member, member)
+
+#endif // __SERIALIZE_HH__
@@ -0,0 +1,52 @@
+/*****************************************************************
+ * File: trace_format.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: On-disk layout of the columnar binary branch traces
+ * (.npbt) written by static/trace_format.py. All fields are
+ * little-endian; blocks are 8-byte aligned and hold, for n
+ * records, pc u64[n], target u64[n], fallthrough u64[n],
+ * inst_delta u32[n], flags u8[n] and kind u8[n], zlib compressed
+ * when the header says so.
+ ****************************************************************/
+
+#ifndef __REPLAY_TRACE_FORMAT_HH__
+#define __REPLAY_TRACE_FORMAT_HH__
+
+#include <stdint.h>
+
+namespace TraceFormat
+{
+  const char magic[4] = { 'N', 'P', 'B', 'T' };
+  const uint32_t version = 1;
+
+  /** Header flag: blocks are zlib compressed. */
+  const uint32_t flagZlib = 1;
+
+  /** Bytes per record of an uncompressed block. */
+  const unsigned recordBytes = 8 + 8 + 8 + 4 + 1 + 1;
+
+  struct Header {
+	char magic[4];
+	uint32_t version;
+	uint32_t flags;
+	uint32_t blockRecords;
+	uint64_t branches;
+	uint64_t instructions;
+	uint64_t indexOffset;
+	uint32_t numBlocks;
+	uint32_t reserved;
+  };
+
+  struct IndexEntry {
+	uint64_t offset;
+	uint64_t storedSize;
+	uint32_t records;
+	uint32_t reserved;
+  };
+
+  static_assert(sizeof(Header) == 48, "header layout");
+  static_assert(sizeof(IndexEntry) == 24, "index entry layout");
+}
+
+#endif // __REPLAY_TRACE_FORMAT_HH__
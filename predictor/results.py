@@ -0,0 +1,209 @@
+"""
+__name__ = results.py
+__author__ = Yash Patel
+__description__ = Append-only store of the results of the accuracy
+sweep, one SQLite database for every ISA, executable and predictor in
+place of a text file per run. Runs are keyed by (ISA, predictor,
+executable, params, commit) and only ever appended, the latest run of a
+key being its result, sampled simulations apart from full ones; the
+figures and tables made from them remember
+the last run they were drawn from, so a refresh only redraws those that
+newer runs have changed
+"""
+
+import settings as s
+
+import json
+import os
+import sqlite3
+import subprocess
+import time
+
+SCHEMA = """
+CREATE TABLE IF NOT EXISTS runs (
+    id          INTEGER PRIMARY KEY,
+    isa         TEXT NOT NULL,
+    predictor   TEXT NOT NULL,
+    executable  TEXT NOT NULL,
+    params      TEXT NOT NULL,
+    commit_id   TEXT NOT NULL,
+    conditional REAL,
+    indirect    REAL,
+    latency     REAL,
+    recorded    REAL NOT NULL
+);
+CREATE INDEX IF NOT EXISTS runs_key
+    ON runs (isa, predictor, executable, params, commit_id);
+CREATE INDEX IF NOT EXISTS runs_isa_executable
+    ON runs (isa, executable);
+CREATE INDEX IF NOT EXISTS runs_isa_predictor
+    ON runs (isa, predictor);
+
+CREATE TABLE IF NOT EXISTS outputs (
+    path        TEXT PRIMARY KEY,
+    last_run    INTEGER NOT NULL
+);
+"""
+
+# columns of a result, in the order accuracy.ATTRIBUTES lists them
+VALUES = ["conditional", "indirect", "latency"]
+
+# runs of sampled simulations, whose params give their "sampling"
+SAMPLED = "params LIKE '%\"sampling\":%'"
+
+def sampling_condition(sampled):
+    """
+    Condition on the runs of sampled or of full simulations, as a sampled
+    result only compares with other sampled ones
+    @param sampled Whether the runs are sampled, None for either
+    """
+    if sampled is None:
+        return ""
+    return " AND {}{}".format("" if sampled else "NOT ", SAMPLED)
+
+def open_store(path=None):
+    """
+    Opens (creating it if need be) the results database
+    @param path Database file, settings.RESULTS_DB by default
+    @return sqlite3 connection to the store
+    """
+    path = path or s.RESULTS_DB
+    directory = os.path.dirname(path)
+    if directory and not os.path.isdir(directory):
+        os.makedirs(directory)
+    store = sqlite3.connect(path)
+    store.executescript(SCHEMA)
+    return store
+
+def encode_params(params):
+    """
+    Canonical text of the parameters of a run, the same for equal dicts
+    whatever their order
+    """
+    return json.dumps(params or {}, sort_keys=True)
+
+def current_commit():
+    """
+    Commit of the tree the simulations run from (the gem5 root), so
+    results of different builds are kept apart
+    @return the short hash, "unknown" outside a git checkout
+    """
+    try:
+        with open(os.devnull, "w") as devnull:
+            output = subprocess.check_output(
+                ["git", "rev-parse", "--short", "HEAD"], stderr=devnull)
+        return output.decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "unknown"
+
+def append_run(store, isa, predictor, executable, params, commit, values):
+    """
+    Appends the result of a run; a result of the same key recorded
+    before stays in the store, superseded by this one
+    @param values The values of VALUES, in order
+    @return id of the new run
+    """
+    with store:
+        cursor = store.execute(
+            "INSERT INTO runs (isa, predictor, executable, params, "
+            "commit_id, conditional, indirect, latency, recorded) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+            [isa, predictor, executable, encode_params(params), commit] +
+            [float(value) for value in values] + [time.time()])
+    return cursor.lastrowid
+
+def has_run(store, isa, predictor, executable, params, commit):
+    """
+    Whether a run of the key was recorded, which is what makes a sweep
+    resumable
+    """
+    return store.execute(
+        "SELECT 1 FROM runs WHERE isa = ? AND predictor = ? AND "
+        "executable = ? AND params = ? AND commit_id = ? LIMIT 1",
+        (isa, predictor, executable, encode_params(params),
+         commit)).fetchone() is not None
+
+def latest_runs(store, isa, executable=None, predictor=None, sampled=False):
+    """
+    The result of every (predictor, executable) of an ISA: its latest
+    run of full simulations, or of sampled ones, whatever its other params
+    and commit
+    @param executable Only the runs of this executable (name), if given
+    @param predictor Only the runs of this predictor (name), if given
+    @param sampled Whether the results are those of sampled simulations
+    @return list of dicts of the columns of runs, by predictor then
+    executable
+    """
+    query = ("SELECT * FROM runs WHERE id IN (SELECT MAX(id) FROM runs "
+        "WHERE isa = ?{} GROUP BY predictor, executable) "
+        "ORDER BY predictor, executable")
+    conditions, args = sampling_condition(sampled), [isa]
+    if executable is not None:
+        conditions += " AND executable = ?"
+        args.append(executable)
+    if predictor is not None:
+        conditions += " AND predictor = ?"
+        args.append(predictor)
+    cursor = store.execute(query.format(conditions), args)
+    columns = [column[0] for column in cursor.description]
+    return [dict(zip(columns, row)) for row in cursor.fetchall()]
+
+def last_run(store, isa, executable=None, predictor=None, sampled=None):
+    """
+    Id of the latest run an output drawn from the runs of an ISA (and
+    of an executable or predictor, full or sampled) depends on, 0 if
+    there is none
+    """
+    query = "SELECT MAX(id) FROM runs WHERE isa = ?" + \
+        sampling_condition(sampled)
+    args = [isa]
+    if executable is not None:
+        query += " AND executable = ?"
+        args.append(executable)
+    if predictor is not None:
+        query += " AND predictor = ?"
+        args.append(predictor)
+    return store.execute(query, args).fetchone()[0] or 0
+
+def is_stale(store, path, run):
+    """
+    Whether an output has to be redrawn: it is missing, or was drawn
+    before the given run
+    @param run Id returned by last_run for the runs of the output
+    """
+    row = store.execute("SELECT last_run FROM outputs WHERE path = ?",
+        (path,)).fetchone()
+    return row is None or row[0] < run or not os.path.exists(path)
+
+def mark_drawn(store, path, run):
+    """
+    Records that an output was drawn from the runs up to the given one
+    """
+    with store:
+        store.execute("INSERT OR REPLACE INTO outputs (path, last_run) "
+            "VALUES (?, ?)", (path, run))
+
+def import_text_results(store, isa, commit="unknown"):
+    """
+    Appends the name_exec.txt results older sweeps left in
+    m5cached/<isa>, lines of "attribute : value", with no params
+    @return number of runs imported
+    """
+    directory = "{}/{}".format(s.OUTPUT_DIR, isa)
+    if not os.path.isdir(directory):
+        return 0
+    imported = 0
+    for f in sorted(os.listdir(directory)):
+        if not f.endswith(".txt") or "_" not in f:
+            continue
+        predictor, executable = f[:-len(".txt")].split("_", 1)
+        props = open("{}/{}".format(directory, f), "r").readlines()
+        values = dict((prop.split(":")[0].strip(), prop.split(":")[1].strip())
+            for prop in props if ":" in prop)
+        if any(value not in values for value in VALUES) or \
+                has_run(store, isa, predictor, executable, {}, commit):
+            continue
+        append_run(store, isa, predictor, executable, {}, commit,
+            [values[value] for value in VALUES])
+        imported += 1
+    return imported
@@ -0,0 +1,123 @@
+/*****************************************************************
+ * File: running_sums.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Running partial sums of the neural path branch
+ * predictor (SR and R in the paper) kept in a rotating ring, so
+ * moving the pipeline one branch forward is an index bump plus
+ * one vector add of a weight row instead of a copy of the array.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_RUNNING_SUMS_HH__
+#define __CPU_PRED_RUNNING_SUMS_HH__
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+#include "cpu/pred/cache_line.hh"
+#include "cpu/pred/weight_table.hh"
+
+class RunningSums
+{
+public:
+  RunningSums() : depth(0), start(0) { }
+
+  /**
+   * Allocates zeroed sums 0 to depth (depth + 1 entries).
+   * @param history_length Number of branches a sum is carried for.
+   */
+  void
+  init(unsigned history_length)
+  {
+	depth = history_length;
+	sums.assign(depth + 1, 0);
+	start = 0;
+  }
+
+  /** Number of sums held, i.e. the history length plus one. */
+  inline unsigned size() const { return depth + 1; }
+
+  /** Partial sum i, 0 being the one started by the newest branch. */
+  inline int32_t
+  operator[](unsigned i) const
+  {
+	return sums[start >= i ? start - i : start + depth + 1 - i];
+  }
+
+  /**
+   * Overwrites every partial sum, e.g. from a checkpoint.
+   * @param entries The size() sums, entry i first read by [i].
+   */
+  void
+  assign(const std::vector<int32_t> &entries)
+  {
+	start = 0;
+	for (unsigned i = 0; i <= depth; i++)
+	  sums[i ? depth + 1 - i : 0] = entries[i];
+  }
+
+  /** Words save() writes: the ring as stored, then its start. */
+  inline unsigned snapshotSize() const { return depth + 2; }
+
+  /** Copies the sums out as they stand, for load() to go back to. */
+  inline void
+  save(int32_t *out) const
+  {
+	std::copy(sums.begin(), sums.end(), out);
+	out[depth + 1] = start;
+  }
+
+  /** Restores the sums from the snapshotSize() words of save(). */
+  inline void
+  load(const int32_t *in)
+  {
+	std::copy(in, in + depth + 1, sums.begin());
+	start = in[depth + 1];
+  }
+
+  /** The completed sum, i.e. entry depth (SR[h] in the paper). */
+  inline int32_t
+  top() const
+  {
+	return sums[start == depth ? 0 : start + 1];
+  }
+
+  /**
+   * Moves every partial sum one step forward: entry i becomes entry
+   * i - 1 plus weight depth - i of the row, in the direction the
+   * branch went, entry 0 restarts at zero and the completed sum drops
+   * off the end.
+   * @param table Perceptron weights.
+   * @param row Perceptron of the branch being recorded.
+   * @param taken Direction the branch is recorded with.
+   */
+  inline void
+  advance(const WeightTable &table, unsigned row, bool taken)
+  {
+	// entry i lives at (start - i) mod (depth + 1), so stepping start
+	// forward renames entry i - 1 to i and reuses the slot of the
+	// dropped completed sum for the new entry 0
+	start = (start == depth) ? 0 : start + 1;
+	sums[start] = 0;
+
+	// the slots after start hold entries depth, depth - 1, ..., which
+	// take weights 0, 1, ... of the row: two contiguous runs with the
+	// wrap-around
+	unsigned tail = depth - start;
+	table.accumulate(row, 0, tail, sums.data() + start + 1, taken);
+	table.accumulate(row, tail, start, sums.data(), taken);
+  }
+
+private:
+  /** History length, the ring holds depth + 1 sums */
+  unsigned depth;
+
+  /** Slot of entry 0 */
+  unsigned start;
+
+  /** Partial sums, entry i stored at (start - i) mod (depth + 1) */
+  std::vector<int32_t, CacheLineAllocator<int32_t>> sums;
+};
+
+#endif // __CPU_PRED_RUNNING_SUMS_HH__
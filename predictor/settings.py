@@ -15,28 +15,60 @@ BP_NAMES = [
     "LTAGE",        # often best-performing current mainstream predictor
     "AlwaysBP",     # always true branch predictor (static)
     "NeuroBP",      # single perceptron neural branch predictor
-    "NeuroPathBP"   # neural path branch predictor
+    "NeuroPathBP",  # neural path branch predictor
+    "HashedNeuroBP", # PC/history-segment hashed neural branch predictor
+    "HybridNeuroBP"  # bimodal fast path in front of NeuroBP
 ]
 
+# indices match the commands list of predict.py (its --exec argument)
 EXEC_NAMES = [
     "ConnCompSmall",  # 0
     "ConnCompMedium", # 1
+    "ConnCompLarge",  # 2
 
-    "Bubblesort",     # 2
-    "IntMM",          # 3
-    "Oscar",          # 4
-    "Perm",           # 5
-    "Puzzle",         # 6
-    "Queens",         # 7
-    "Quicksort",      # 8
-    "RealMM",         # 9
-    "Towers",         # 10
-    "Treesort",       # 11
+    "Bubblesort",     # 3
+    "IntMM",          # 4
+    "Oscar",          # 5
+    "Perm",           # 6
+    "Puzzle",         # 7
+    "Queens",         # 8
+    "Quicksort",      # 9
+    "RealMM",         # 10
+    "Towers",         # 11
+    "Treesort",       # 12
+
+    "Primes",         # 13
+    "ShellSort",      # 14
 ]
 
+ISAS = ["ARM", "X86"]
+
+# simulation run for one (isa, executable, predictor) job, each with its
+# own gem5 output directory so concurrent runs do not share stats.txt
+GEM5_COMMAND = ("build/{isa}/gem5.opt --outdir={outdir} "
+    "configs/branch/predict.py --exec {executable} --pred {predictor} "
+    "--profile {profile}")
+
+# sampled simulation (predict.py --fast-forward and --sample-*): the atomic
+# CPU runs the first fast_forward instructions and between the samples,
+# training the predictor, and the detailed CPU a sample of length
+# instructions every interval, up to samples of them (0, to the end)
+SAMPLING = {
+    "fast_forward": 10000000,
+    "interval":     10000000,
+    "length":       1000000,
+    "samples":      0,
+}
+GEM5_SAMPLING = (" --fast-forward {fast_forward} --sample-interval "
+    "{interval} --sample-length {length} --samples {samples}")
+
 # --------------------------- Input Specs  ---------------------------- #
-# location of the final results dump file
-INPUT_FILE = "m5out/stats.txt"
+# name of the final results dump file within a run's output directory
+INPUT_FILE = "stats.txt"
+
+# counters of the samples of a sampled run summed by predict.py, read in
+# place of INPUT_FILE
+SAMPLES_FILE = "stats_samples.txt"
 
 # --------------------------- Output Specs ---------------------------- #
 # outputs are by convention specified by executable
@@ -44,3 +76,30 @@ OUTPUT_DIR = "m5cached"
 
 # outputs are by convention specified by executable
 FIGURE_DIR = "m5cached/{}/figures"
+
+# gem5 output directory of every run, by isa and run name
+RUN_DIR = "m5cached/{}/runs/{}"
+
+# HTML table rows of the results of every predictor, by isa
+TABLE_DIR = "m5cached/{}/tables"
+
+# append-only SQLite store of the results of every run (results.py), the
+# figures and tables being redrawn from it as new runs come in
+RESULTS_DB = "m5cached/results.sqlite"
+
+# slots of the per-PC branch profile the neural predictors write into the
+# output directory of every run (profileSize in BranchPredictor.py), and
+# the name of that file (profileFile, written by predict.py --profile)
+PROFILE_SIZE = 4096
+PROFILE_FILE = "branch_profile.csv"
+
+# Stanford binaries run by predict.py, built from tests/stanford with
+# debug info and their sources copied next to them, which the hot branches
+# of a profile are mapped back to
+STANFORD_DIR = "tests/test-progs/predict/stanford"
+
+# addr2line able to read the binaries of each ISA
+ADDR2LINE = {
+    "ARM": "arm-linux-gnueabi-addr2line",
+    "X86": "addr2line",
+}
@@ -0,0 +1,233 @@
+/*****************************************************************
+ * File: tagged_rows.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Set-associative placement of the perceptron rows
+ * of NeuroBP. A branch owns a row of its set while the partial
+ * tag of its PC sits in it, and predicts with a shared fallback
+ * row otherwise, so branches stop training the weights of the
+ * unrelated branches their PC used to alias with.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_TAGGED_ROWS_HH__
+#define __CPU_PRED_TAGGED_ROWS_HH__
+
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+#include "base/types.hh"
+
+class TaggedRows
+{
+public:
+  /** Choice of the row a missing branch takes over in its set. */
+  enum Replacement {
+	/** The row of the set used least recently */
+	LRU,
+	/** A row whose last prediction was wrong, all the rows of the set
+	 *  losing their useful bit when none is */
+	Useful
+  };
+
+  TaggedRows()
+	: ways(0), sets(0), tagBits(0), tagMask(0), replacement(LRU)
+  { }
+
+  /**
+   * Empties the rows and sizes the sets.
+   * @param num_rows Tagged rows, a multiple of num_ways; the fallback
+   * row comes after them.
+   * @param num_ways Rows per set, 1 to 256.
+   * @param tag_bits Bits of the partial tags, 1 to 16.
+   * @param policy Row a missing branch replaces.
+   */
+  void
+  init(unsigned num_rows, unsigned num_ways, unsigned tag_bits,
+	   Replacement policy)
+  {
+	assert(num_ways > 0 && num_ways <= 256 && num_rows % num_ways == 0);
+	assert(tag_bits > 0 && tag_bits <= 16);
+	ways = num_ways;
+	sets = num_rows / num_ways;
+	tagBits = tag_bits;
+	tagMask = (1 << tag_bits) - 1;
+	replacement = policy;
+
+	// ranks start as a valid LRU order of every set
+	entries.assign(num_rows, Entry());
+	for (unsigned row = 0; row < num_rows; row++)
+	  entries[row].rank = row % ways;
+  }
+
+  /** Row predicting the branches no row of their set is tagged for. */
+  unsigned fallbackRow() const { return entries.size(); }
+
+  /**
+   * The row of a branch: the row of its set holding its tag, or the
+   * fallback row.
+   * @param pc Address of the branch, shifted by instShiftAmt.
+   */
+  inline unsigned
+  find(Addr pc) const
+  {
+	unsigned first = setOf(pc) * ways;
+	uint16_t tag = tagOf(pc);
+	for (unsigned row = first; row < first + ways; row++) {
+	  if (entries[row].valid && entries[row].tag == tag)
+		return row;
+	}
+	return fallbackRow();
+  }
+
+  /**
+   * Gives a branch a row of its set, replacing another branch.
+   * @param pc Address of the branch, shifted by instShiftAmt.
+   * @param evicted Set when the row was tagged for another branch.
+   * @return The row, whose weights now need replacing, or the
+   * fallback row when every row of the set was useful.
+   */
+  unsigned
+  allocate(Addr pc, bool &evicted)
+  {
+	unsigned first = setOf(pc) * ways;
+	unsigned victim = first;
+	for (unsigned row = first; row < first + ways; row++) {
+	  // free rows go first, whatever the policy
+	  if (!entries[row].valid) {
+		victim = row;
+		break;
+	  }
+	  if (replacement == LRU) {
+		if (entries[row].rank > entries[victim].rank)
+		  victim = row;
+	  } else if (entries[victim].useful && !entries[row].useful) {
+		victim = row;
+	  }
+	}
+
+	// every row of the set useful: they age, and the branch waits
+	// for one to lose its use
+	if (replacement == Useful && entries[victim].useful) {
+	  for (unsigned row = first; row < first + ways; row++)
+		entries[row].useful = false;
+	  evicted = false;
+	  return fallbackRow();
+	}
+
+	evicted = entries[victim].valid;
+	entries[victim].valid = true;
+	entries[victim].useful = false;
+	entries[victim].tag = tagOf(pc);
+	touch(victim);
+	return victim;
+  }
+
+  /**
+   * Records that a tagged row was used by a committed branch.
+   * @param row Tagged row, below fallbackRow().
+   * @param correct Whether the row predicted the branch right.
+   */
+  inline void
+  used(unsigned row, bool correct)
+  {
+	entries[row].useful = correct;
+	touch(row);
+  }
+
+  /** Bytes of tag and replacement state, beside the weights. */
+  size_t footprint() const { return entries.size() * sizeof(Entry); }
+
+  /**
+   * The state of every row packed into one word, for checkpoints:
+   * the tag, then the valid and useful bits and the LRU rank.
+   */
+  std::vector<uint32_t>
+  save() const
+  {
+	std::vector<uint32_t> words;
+	for (const Entry &entry : entries) {
+	  words.push_back(uint32_t(entry.tag) | uint32_t(entry.valid) << 16 |
+					  uint32_t(entry.useful) << 17 |
+					  uint32_t(entry.rank) << 24);
+	}
+	return words;
+  }
+
+  /** Restores the words of save(); false if they do not fit. */
+  bool
+  load(const std::vector<uint32_t> &words)
+  {
+	if (words.size() != entries.size())
+	  return false;
+	for (size_t row = 0; row < words.size(); row++) {
+	  entries[row].tag = words[row] & tagMask;
+	  entries[row].valid = (words[row] >> 16) & 1;
+	  entries[row].useful = (words[row] >> 17) & 1;
+	  entries[row].rank = (words[row] >> 24) % ways;
+	}
+	return true;
+  }
+
+private:
+  /** Tag and replacement state of a row. */
+  struct Entry {
+	Entry() : tag(0), valid(false), useful(false), rank(0) { }
+	uint16_t tag;
+	bool valid;
+	bool useful;
+	/** Position in the LRU order of its set, 0 for the most recent */
+	uint8_t rank;
+  };
+
+  /** The set of a PC, hashed so strided branches spread over them. */
+  inline unsigned
+  setOf(Addr pc) const
+  {
+	return ((uint64_t(pc) * 0x9e3779b97f4a7c15ull) >> 32) % sets;
+  }
+
+  /**
+   * The partial tag of a PC, from a hash of its own (the finalizer of
+   * MurmurHash3) rather than the bits setOf() leaves: the set hash
+   * mixes every bit of the PC, so the PCs of a set share no bits a tag
+   * could be cut from, and only an independent hash leaves a false hit
+   * at 1 in 2^tagBits a way.
+   */
+  inline uint16_t
+  tagOf(Addr pc) const
+  {
+	uint64_t tag = pc;
+	tag = (tag ^ (tag >> 33)) * 0xff51afd7ed558ccdull;
+	tag = (tag ^ (tag >> 33)) * 0xc4ceb9fe1a85ec53ull;
+	return (tag ^ (tag >> 33)) & tagMask;
+  }
+
+  /** Makes a row the most recent of its set. */
+  inline void
+  touch(unsigned row)
+  {
+	unsigned first = row - row % ways;
+	for (unsigned other = first; other < first + ways; other++) {
+	  if (entries[other].rank < entries[row].rank)
+		entries[other].rank++;
+	}
+	entries[row].rank = 0;
+  }
+
+  /** Rows per set, and sets */
+  unsigned ways;
+  unsigned sets;
+
+  /** Width of the tags, and its mask */
+  unsigned tagBits;
+  unsigned tagMask;
+
+  /** Row a missing branch replaces */
+  Replacement replacement;
+
+  /** State of every tagged row, set after set */
+  std::vector<Entry> entries;
+};
+
+#endif // __CPU_PRED_TAGGED_ROWS_HH__
@@ -0,0 +1,188 @@
+/*****************************************************************
+ * File: update_buffer.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Deferred training of a weight table. Trainings
+ * add their +/-1 steps into the deltas of a few buffered rows,
+ * which are written back together every few commits, or one at a
+ * time when a row has to make room for another, so lookups read
+ * a table that only changes in batches.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_UPDATE_BUFFER_HH__
+#define __CPU_PRED_UPDATE_BUFFER_HH__
+
+#include <algorithm>
+#include <assert.h>
+#include <stdint.h>
+#include <vector>
+
+#include "cpu/pred/weight_table.hh"
+
+class UpdateBuffer
+{
+public:
+  UpdateBuffer()
+	: table(NULL), length(0), delay(0), commits(0), victim(0)
+  { }
+
+  /**
+   * Empties the buffer and attaches it to a table.
+   * @param weights Table the deltas are written back to.
+   * @param rows Rows the buffer holds deltas for at once.
+   * @param commit_delay Commits between two write backs.
+   */
+  void
+  init(WeightTable &weights, unsigned rows, unsigned commit_delay)
+  {
+	assert(rows > 0 && commit_delay > 0);
+	table = &weights;
+	length = weights.rowLength();
+	delay = commit_delay;
+	commits = 0;
+	victim = 0;
+	slotRows.assign(rows, unsigned(unused));
+	rowSlots.assign(weights.numRows(), unsigned(unused));
+	deltas.assign(rows * length, 0);
+	biasDeltas.assign(rows, 0);
+  }
+
+  /**
+   * Trains a whole row like WeightTable::trainRow(), into its deltas.
+   * @return Whether another row was written back to make room.
+   */
+  inline bool
+  trainRow(unsigned row, const uint64_t *history, bool taken)
+  {
+	bool evicted;
+	int32_t *delta = rowDeltas(row, evicted);
+	for (unsigned i = 0; i < length; i++) {
+	  bool bit = (history[i >> 6] >> (i & 63)) & 1;
+	  delta[i] += bit == taken ? 1 : -1;
+	}
+	return evicted;
+  }
+
+  /**
+   * Steps weight i of a row like WeightTable::adjust(), into its delta.
+   * @return Whether another row was written back to make room.
+   */
+  inline bool
+  adjust(unsigned row, unsigned i, bool inc)
+  {
+	bool evicted;
+	rowDeltas(row, evicted)[i] += inc ? 1 : -1;
+	return evicted;
+  }
+
+  /**
+   * Steps the bias of a row like WeightTable::adjustBias().
+   * @return Whether another row was written back to make room.
+   */
+  inline bool
+  adjustBias(unsigned row, bool inc)
+  {
+	bool evicted;
+	rowDeltas(row, evicted);
+	biasDeltas[rowSlots[row]] += inc ? 1 : -1;
+	return evicted;
+  }
+
+  /**
+   * Counts a committed branch, writing every buffered row back once
+   * the delay has elapsed.
+   * @return Whether the rows were written back.
+   */
+  inline bool
+  commit()
+  {
+	if (++commits < delay)
+	  return false;
+	flush();
+	return true;
+  }
+
+  /** Drops every buffered delta, e.g. when the weights are replaced. */
+  void
+  clear()
+  {
+	std::fill(slotRows.begin(), slotRows.end(), unsigned(unused));
+	std::fill(rowSlots.begin(), rowSlots.end(), unsigned(unused));
+	std::fill(deltas.begin(), deltas.end(), 0);
+	std::fill(biasDeltas.begin(), biasDeltas.end(), 0);
+	commits = 0;
+	victim = 0;
+  }
+
+  /** Writes every buffered row back, e.g. before a checkpoint. */
+  void
+  flush()
+  {
+	for (unsigned slot = 0; slot < slotRows.size(); slot++)
+	  writeBack(slot);
+	commits = 0;
+	victim = 0;
+  }
+
+private:
+  /** Marks slots holding no row and rows held by no slot */
+  static const unsigned unused = ~0u;
+
+  /**
+   * Deltas of a row, taking a slot for it if it has none; slots are
+   * taken round robin, writing the row they held back first.
+   */
+  inline int32_t *
+  rowDeltas(unsigned row, bool &evicted)
+  {
+	evicted = false;
+	unsigned slot = rowSlots[row];
+	if (slot == unused) {
+	  slot = victim;
+	  victim = (victim + 1) % slotRows.size();
+	  evicted = slotRows[slot] != unused;
+	  writeBack(slot);
+	  slotRows[slot] = row;
+	  rowSlots[row] = slot;
+	}
+	return &deltas[slot * length];
+  }
+
+  /** Applies the deltas of a slot to its row and frees the slot. */
+  void
+  writeBack(unsigned slot)
+  {
+	unsigned row = slotRows[slot];
+	if (row == unused)
+	  return;
+	int32_t *delta = &deltas[slot * length];
+	table->addDeltas(row, delta, biasDeltas[slot]);
+	std::fill(delta, delta + length, 0);
+	biasDeltas[slot] = 0;
+	slotRows[slot] = unused;
+	rowSlots[row] = unused;
+  }
+
+  /** Table the deltas are written back to */
+  WeightTable *table;
+
+  /** Weights per row, bias excluded */
+  unsigned length;
+
+  /** Commits between two write backs, and since the last one */
+  unsigned delay;
+  unsigned commits;
+
+  /** Slot the next newly buffered row takes */
+  unsigned victim;
+
+  /** Row buffered in each slot, and slot buffering each row */
+  std::vector<unsigned> slotRows;
+  std::vector<unsigned> rowSlots;
+
+  /** Pending weight and bias deltas, one run of length per slot */
+  std::vector<int32_t> deltas;
+  std::vector<int32_t> biasDeltas;
+};
+
+#endif // __CPU_PRED_UPDATE_BUFFER_HH__
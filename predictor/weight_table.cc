@@ -0,0 +1,267 @@
+/*****************************************************************
+ * File: weight_table.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Flat, cache-aligned storage for the perceptron
+ * weights of the neural branch predictors.
+ ****************************************************************/
+
+#include "cpu/pred/weight_table.hh"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "base/misc.hh"
+
+namespace
+{
+  /** Bytes of the header of a standalone weight dump. */
+  const size_t dumpHeaderBytes = 24;
+
+  const char dumpMagic[4] = { 'N', 'P', 'W', 'T' };
+  const uint32_t dumpVersion = 1;
+
+  /** Stores the low bytes of value into out, least significant first. */
+  void
+  putLE(uint8_t *out, uint32_t value, unsigned bytes)
+  {
+	for (unsigned i = 0; i < bytes; i++)
+	  out[i] = value >> (8 * i);
+  }
+
+  /** Reads bytes bytes stored least significant first. */
+  uint32_t
+  getLE(const uint8_t *in, unsigned bytes)
+  {
+	uint32_t value = 0;
+	for (unsigned i = 0; i < bytes; i++)
+	  value |= (uint32_t)in[i] << (8 * i);
+	return value;
+  }
+}
+
+WeightTable::WeightTable()
+  : rows(0), length(0), bits(0), wide(false), stride(0),
+	minWeight(0), maxWeight(0), arena(NULL), bounded(false), numBlocks(0)
+{
+}
+
+WeightTable::~WeightTable()
+{
+  free(arena);
+}
+
+void
+WeightTable::init(unsigned num_rows, unsigned row_length,
+				  unsigned weight_bits, bool specialize, bool bounded)
+{
+  if (weight_bits < 2 || weight_bits > 16)
+	fatal("Perceptron weights must be 2 to 16 bits wide!\n");
+
+  rows   = num_rows;
+  length = row_length;
+  bits   = weight_bits;
+  wide   = weight_bits > 8;
+
+  // two's complement range of the configured width
+  maxWeight = (1 << (weight_bits - 1)) - 1;
+  minWeight = -(maxWeight + 1);
+
+  // whole rows go through the kernels compiled for their length when
+  // there are some
+  rowKernels8 = PerceptronKernel::rowKernels<int8_t>(length, specialize);
+  rowKernels16 = PerceptronKernel::rowKernels<int16_t>(length, specialize);
+
+  // pad every row to whole cache lines so rows never share a line and
+  // the kernels always start on an aligned address
+  size_t elem_size = wide ? sizeof(int16_t) : sizeof(int8_t);
+  size_t row_bytes = (length * elem_size + rowAlignment - 1) /
+	rowAlignment * rowAlignment;
+  stride = row_bytes / elem_size;
+
+  free(arena);
+  arena = NULL;
+  size_t bytes = rows * row_bytes;
+  if (bytes && posix_memalign(&arena, rowAlignment, bytes) != 0)
+	fatal("Unable to allocate %lu bytes of perceptron weights!\n",
+		  (unsigned long)bytes);
+  if (arena)
+	memset(arena, 0, bytes);
+
+  biases.assign(rows, 0);
+
+  // zeroed rows have nothing left to bound
+  this->bounded = bounded;
+  numBlocks = (length + boundBlockLength - 1) / boundBlockLength;
+  bounds.assign(bounded ? rows * (numBlocks + 1) : 0, 0);
+}
+
+void
+WeightTable::adjust(unsigned row, unsigned i, bool inc)
+{
+  int32_t old_value = weight(row, i);
+  int32_t value = saturate(old_value + (inc ? 1 : -1));
+  if (wide) row16(row)[i] = value;
+  else      row8(row)[i]  = value;
+
+  // only the suffix sums from the blocks up to that of the weight
+  // include it, the step moves them all by the same amount
+  if (bounded) {
+	int32_t delta = abs(value) - abs(old_value);
+	int32_t *remaining = &bounds[row * (numBlocks + 1)];
+	for (unsigned block = 0; delta && block <= i / boundBlockLength;
+		 block++)
+	  remaining[block] += delta;
+  }
+}
+
+void
+WeightTable::addDeltas(unsigned row, const int32_t *deltas,
+					   int32_t bias_delta)
+{
+  for (unsigned i = 0; i < length; i++) {
+	if (!deltas[i])
+	  continue;
+	int32_t value = saturate(weight(row, i) + deltas[i]);
+	if (wide) row16(row)[i] = value;
+	else      row8(row)[i]  = value;
+  }
+  biases[row] = saturate(biases[row] + bias_delta);
+  if (bounded)
+	refreshBounds(row);
+}
+
+void
+WeightTable::copyRow(unsigned from, unsigned to)
+{
+  size_t elem_size = wide ? sizeof(int16_t) : sizeof(int8_t);
+  memcpy(wide ? (void *)row16(to) : (void *)row8(to),
+		 wide ? (void *)row16(from) : (void *)row8(from),
+		 length * elem_size);
+  biases[to] = biases[from];
+  if (bounded)
+	refreshBounds(to);
+}
+
+void
+WeightTable::refreshBounds(unsigned row)
+{
+  // suffix sums, from the last block back to the first
+  int32_t *remaining = &bounds[row * (numBlocks + 1)];
+  remaining[numBlocks] = 0;
+  for (unsigned block = numBlocks; block-- > 0; ) {
+	unsigned first = block * boundBlockLength;
+	unsigned end = std::min(first + boundBlockLength, length);
+	int32_t magnitude = 0;
+	for (unsigned i = first; i < end; i++)
+	  magnitude += abs(weight(row, i));
+	remaining[block] = remaining[block + 1] + magnitude;
+  }
+}
+
+void
+WeightTable::adjustBias(unsigned row, bool inc)
+{
+  biases[row] = saturate(biases[row] + (inc ? 1 : -1));
+}
+
+unsigned
+WeightTable::saturated(unsigned row, unsigned first, unsigned length) const
+{
+  unsigned count = 0;
+  for (unsigned i = first; i < first + length; i++) {
+	int32_t value = weight(row, i);
+	count += (value == minWeight) | (value == maxWeight);
+  }
+  return count;
+}
+
+size_t
+WeightTable::footprint() const
+{
+  size_t elem_size = wide ? sizeof(int16_t) : sizeof(int8_t);
+  return rows * stride * elem_size + biases.size() * sizeof(int16_t) +
+	bounds.size() * sizeof(int32_t);
+}
+
+void
+WeightTable::save(const std::string &path) const
+{
+  FILE *file = fopen(path.c_str(), "wb");
+  if (!file)
+	fatal("Can't open weight dump %s for writing!\n", path.c_str());
+
+  uint8_t header[dumpHeaderBytes];
+  memcpy(header, dumpMagic, sizeof(dumpMagic));
+  putLE(header + 4, dumpVersion, 4);
+  putLE(header + 8, rows, 4);
+  putLE(header + 12, length, 4);
+  putLE(header + 16, bits, 4);
+  putLE(header + 20, 0, 4);
+
+  // The biases and 16-bit weights go through a buffer so the dump
+  // reads the same whatever the byte order of the host writing it.
+  std::vector<uint8_t> buffer(2 * std::max(rows, length));
+  for (unsigned row = 0; row < rows; row++)
+	putLE(&buffer[2 * row], (uint16_t)biases[row], 2);
+  bool ok = fwrite(header, sizeof(header), 1, file) == 1 &&
+	fwrite(buffer.data(), 2, rows, file) == rows;
+
+  unsigned elem_size = wide ? 2 : 1;
+  for (unsigned row = 0; ok && row < rows; row++) {
+	for (unsigned i = 0; i < length; i++)
+	  putLE(&buffer[elem_size * i], (uint16_t)weight(row, i), elem_size);
+	ok = fwrite(buffer.data(), elem_size, length, file) == length;
+  }
+
+  if (fclose(file) != 0 || !ok)
+	fatal("Error writing weight dump %s!\n", path.c_str());
+}
+
+void
+WeightTable::load(const std::string &path)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+	fatal("Can't open weight dump %s!\n", path.c_str());
+
+  uint8_t header[dumpHeaderBytes];
+  if (fread(header, sizeof(header), 1, file) != 1 ||
+	  memcmp(header, dumpMagic, sizeof(dumpMagic)) != 0 ||
+	  getLE(header + 4, 4) != dumpVersion)
+	fatal("%s is not a weight dump!\n", path.c_str());
+
+  unsigned dump_rows = getLE(header + 8, 4);
+  unsigned dump_length = getLE(header + 12, 4);
+  unsigned dump_bits = getLE(header + 16, 4);
+  if (dump_rows != rows || dump_length != length || dump_bits != bits) {
+	fatal("Weight dump %s holds %u rows of %u %u-bit weights, the "
+		  "predictor %u rows of %u %u-bit weights!\n", path.c_str(),
+		  dump_rows, dump_length, dump_bits, rows, length, bits);
+  }
+
+  std::vector<uint8_t> buffer(2 * std::max(rows, length));
+  bool ok = fread(buffer.data(), 2, rows, file) == rows;
+  for (unsigned row = 0; ok && row < rows; row++)
+	biases[row] = (int16_t)getLE(&buffer[2 * row], 2);
+
+  unsigned elem_size = wide ? 2 : 1;
+  for (unsigned row = 0; ok && row < rows; row++) {
+	ok = fread(buffer.data(), elem_size, length, file) == length;
+	for (unsigned i = 0; ok && i < length; i++) {
+	  uint32_t value = getLE(&buffer[elem_size * i], elem_size);
+	  if (wide)
+		row16(row)[i] = (int16_t)value;
+	  else
+		row8(row)[i] = (int8_t)value;
+	}
+  }
+  fclose(file);
+
+  if (!ok)
+	fatal("Weight dump %s is truncated!\n", path.c_str());
+
+  for (unsigned row = 0; bounded && row < rows; row++)
+	refreshBounds(row);
+}
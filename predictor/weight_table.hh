@@ -0,0 +1,329 @@
+/*****************************************************************
+ * File: weight_table.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Flat, cache-aligned storage for the perceptron
+ * weights of the neural branch predictors: header file. Every
+ * row lives in one 64-byte aligned arena with 8 or 16 bits per
+ * weight, saturating at the range given by the weight width.
+ ****************************************************************/
+
+#ifndef __CPU_PRED_WEIGHT_TABLE_HH__
+#define __CPU_PRED_WEIGHT_TABLE_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "cpu/pred/cache_line.hh"
+#include "cpu/pred/perceptron_kernel.hh"
+
+class WeightTable
+{
+public:
+  /** Size in bytes every row is aligned and padded to. */
+  static const size_t rowAlignment = 64;
+
+  /** Weights summed between two checks of boundedDotRow(), the bits
+   *  of one history word. */
+  static const unsigned boundBlockLength = 64;
+
+  WeightTable();
+  ~WeightTable();
+
+  /**
+   * Allocates a zeroed table, discarding any previous contents.
+   * @param num_rows Number of perceptrons.
+   * @param row_length Number of non-bias weights per perceptron.
+   * @param weight_bits Bits per weight (2-16); rows are stored as
+   * int8_t up to 8 bits and as int16_t above.
+   * @param specialize Whether whole rows may use the kernels compiled
+   * for the row length, when it is one of the fixedRowLengths.
+   * @param bounded Whether to keep the magnitude bounds of every row
+   * boundedDotRow() needs, refreshed whenever a row is trained.
+   */
+  void init(unsigned num_rows, unsigned row_length, unsigned weight_bits,
+			bool specialize = true, bool bounded = false);
+
+  /**
+   * Signed sum of the first length weights of a row against history.
+   * @param row Perceptron to evaluate.
+   * @param history Bit array, bit i paired with weight i.
+   * @param length Number of weights to accumulate.
+   * @return The weighted sum, bias excluded.
+   */
+  inline int32_t
+  dot(unsigned row, const uint64_t *history, unsigned length) const
+  {
+	if (wide)
+	  return PerceptronKernel::dot(row16(row), history, length);
+	return PerceptronKernel::dot(row8(row), history, length);
+  }
+
+  /**
+   * Trains the first length weights of a row towards the outcome,
+   * saturating at the range of the weight width.
+   * @param row Perceptron to train.
+   * @param history Bit array, bit i paired with weight i.
+   * @param length Number of weights to train.
+   * @param taken The resolved direction of the branch.
+   */
+  inline void
+  train(unsigned row, const uint64_t *history, unsigned length, bool taken)
+  {
+	if (wide)
+	  PerceptronKernel::train(row16(row), history, length, taken,
+							  minWeight, maxWeight);
+	else
+	  PerceptronKernel::train(row8(row), history, length, taken,
+							  minWeight, maxWeight);
+	if (bounded)
+	  refreshBounds(row);
+  }
+
+  /**
+   * Signed sum of a whole row against history, through the kernels
+   * selected for the row length.
+   * @param row Perceptron to evaluate.
+   * @param history Bit array holding at least rowLength() bits.
+   * @return The weighted sum, bias excluded.
+   */
+  inline int32_t
+  dotRow(unsigned row, const uint64_t *history) const
+  {
+	if (wide)
+	  return rowKernels16.dot(row16(row), history, length);
+	return rowKernels8.dot(row8(row), history, length);
+  }
+
+  /**
+   * Trains a whole row towards the outcome, through the kernels
+   * selected for the row length.
+   * @param row Perceptron to train.
+   * @param history Bit array holding at least rowLength() bits.
+   * @param taken The resolved direction of the branch.
+   */
+  inline void
+  trainRow(unsigned row, const uint64_t *history, bool taken)
+  {
+	if (wide)
+	  rowKernels16.train(row16(row), history, length, taken,
+						 minWeight, maxWeight);
+	else
+	  rowKernels8.train(row8(row), history, length, taken,
+						minWeight, maxWeight);
+	if (bounded)
+	  refreshBounds(row);
+  }
+
+  /**
+   * Adds a whole row against history to start, boundBlockLength
+   * weights at a time, and stops as soon as the weights left could
+   * neither flip the sign of the sum nor bring its magnitude down to
+   * threshold: the result then has the sign and, past threshold, the
+   * magnitude class of the full sum. The table must be bounded.
+   * @param row Perceptron to evaluate.
+   * @param history Bit array holding at least rowLength() bits.
+   * @param start Value to add the row to, typically its bias.
+   * @param threshold Magnitude the full sum is compared against.
+   * @param weights_read Set to the number of weights summed.
+   * @return The sum, exact unless weights_read < rowLength().
+   */
+  inline int32_t
+  boundedDotRow(unsigned row, const uint64_t *history, int32_t start,
+				int32_t threshold, unsigned &weights_read) const
+  {
+	assert(bounded);
+	weights_read = length;
+	// nothing to skip in a single block, which has kernels of its own
+	if (numBlocks == 1)
+	  return start + dotRow(row, history);
+
+	const int32_t *remaining = &bounds[row * (numBlocks + 1)];
+	int32_t sum = start;
+	for (unsigned block = 0; block < numBlocks; block++) {
+	  unsigned first = block * boundBlockLength;
+	  if (abs(sum) - remaining[block] > threshold) {
+		weights_read = first;
+		return sum;
+	  }
+	  unsigned count = std::min(boundBlockLength, length - first);
+	  if (wide)
+		sum += PerceptronKernel::dot(row16(row) + first, history + first / 64,
+									 count);
+	  else
+		sum += PerceptronKernel::dot(row8(row) + first, history + first / 64,
+									 count);
+	}
+	return sum;
+  }
+
+  /**
+   * Adds a run of weights of a row into running sums, negated when the
+   * branch is not taken: sums[i] += +/-weight(row, first + i).
+   * @param row Perceptron providing the weights.
+   * @param first First weight (0-based, bias excluded) to add.
+   * @param length Number of weights/sums.
+   * @param sums Running sums to add into.
+   * @param taken Direction deciding the sign of the weights.
+   */
+  inline void
+  accumulate(unsigned row, unsigned first, unsigned length, int32_t *sums,
+			 bool taken) const
+  {
+	if (wide)
+	  PerceptronKernel::accumulate(sums, row16(row) + first, length, taken);
+	else
+	  PerceptronKernel::accumulate(sums, row8(row) + first, length, taken);
+  }
+
+  /** Reads weight i (0-based, bias excluded) of a row. */
+  inline int32_t
+  weight(unsigned row, unsigned i) const
+  {
+	return wide ? row16(row)[i] : row8(row)[i];
+  }
+
+  /** Saturating increment/decrement of weight i of a row; in a
+   *  bounded table only the bounds up to its block are moved. */
+  void adjust(unsigned row, unsigned i, bool inc);
+
+  /** Reads the bias weight of a row. */
+  inline int32_t bias(unsigned row) const { return biases[row]; }
+
+  /** Saturating increment/decrement of the bias weight of a row. */
+  void adjustBias(unsigned row, bool inc);
+
+  /**
+   * Adds accumulated training steps to a row, saturating each weight
+   * once at the end rather than at every step.
+   * @param row Perceptron to update.
+   * @param deltas Change of every weight (0-based, bias excluded).
+   * @param bias_delta Change of the bias weight.
+   */
+  void addDeltas(unsigned row, const int32_t *deltas, int32_t bias_delta);
+
+  /** Overwrites every weight of a row, bias included, with those of
+   *  another, e.g. when the row is handed to another branch. */
+  void copyRow(unsigned from, unsigned to);
+
+  /**
+   * Counts the weights of a run of a row sitting at either limit of
+   * the weight range.
+   * @param row Perceptron to inspect.
+   * @param first First weight (0-based, bias excluded) to check.
+   * @param length Number of weights to check.
+   * @return The number of saturated weights.
+   */
+  unsigned saturated(unsigned row, unsigned first, unsigned length) const;
+
+  /** Whether the bias weight of a row sits at a limit of the range. */
+  inline bool
+  biasSaturated(unsigned row) const
+  {
+	return biases[row] == minWeight || biases[row] == maxWeight;
+  }
+
+  unsigned numRows() const { return rows; }
+  unsigned rowLength() const { return length; }
+  unsigned weightBits() const { return bits; }
+  int32_t minValue() const { return minWeight; }
+  int32_t maxValue() const { return maxWeight; }
+
+  /** Whether whole rows use kernels compiled for their length. */
+  bool fixedLength() const { return rowKernels8.fixedLength; }
+
+  /** Bytes held by the weights, padding and biases included. */
+  size_t footprint() const;
+
+  /**
+   * Writes the weights into a standalone dump: a 24-byte header
+   * ("NPWT", version, rows, row length, weight bits, reserved, all
+   * 32-bit little-endian), the 16-bit biases, then every row packed
+   * back to back in its storage width without the alignment padding,
+   * little-endian too, so a dump loads on a host of either byte order.
+   * @param path File to write, replaced if it exists.
+   */
+  void save(const std::string &path) const;
+
+  /**
+   * Reads a dump written by save() by a table of the same shape
+   * (rows, row length and weight bits), replacing every weight.
+   * @param path File to read.
+   */
+  void load(const std::string &path);
+
+private:
+  WeightTable(const WeightTable &) = delete;
+  WeightTable &operator=(const WeightTable &) = delete;
+
+  inline int8_t *
+  row8(unsigned row) const
+  {
+	return static_cast<int8_t *>(arena) + row * stride;
+  }
+
+  inline int16_t *
+  row16(unsigned row) const
+  {
+	return static_cast<int16_t *>(arena) + row * stride;
+  }
+
+  /** Recomputes the magnitude bounds of a row after it changed. */
+  void refreshBounds(unsigned row);
+
+  /** Saturates value to [minWeight, maxWeight]. */
+  inline int32_t
+  saturate(int32_t value) const
+  {
+	return value < minWeight ? minWeight :
+	  (value > maxWeight ? maxWeight : value);
+  }
+
+  /** Number of perceptron rows */
+  unsigned rows;
+
+  /** Non-bias weights per row */
+  unsigned length;
+
+  /** Bits per weight */
+  unsigned bits;
+
+  /** Set when rows are stored as int16_t rather than int8_t */
+  bool wide;
+
+  /** Distance between consecutive rows, in weights */
+  size_t stride;
+
+  /** Saturated value of the minimum weight */
+  int32_t minWeight;
+
+  /** Saturated value of the maximum weight */
+  int32_t maxWeight;
+
+  /** Kernels dotRow() and trainRow() use for each storage width */
+  PerceptronKernel::RowKernels<int8_t> rowKernels8;
+  PerceptronKernel::RowKernels<int16_t> rowKernels16;
+
+  /** Aligned allocation holding every row back to back */
+  void *arena;
+
+  /** Set when the magnitude bounds below are kept */
+  bool bounded;
+
+  /** Blocks of boundBlockLength weights per row */
+  unsigned numBlocks;
+
+  /** Per row, numBlocks + 1 sums of the weight magnitudes from the
+   *  start of each block to the end of the row, then a 0 */
+  std::vector<int32_t> bounds;
+
+  /** Bias weight of every row, kept apart so the rows stay aligned */
+  std::vector<int16_t, CacheLineAllocator<int16_t>> biases;
+};
+
+#endif // __CPU_PRED_WEIGHT_TABLE_HH__
@@ -12,9 +12,11 @@ from predictors.static  import StaticPredictor
 from predictors.bimodal import BimodalPredictor
 from predictors.gshare  import GSharePredictor
 from predictors.neural  import NeuralPredictor
+from predictors import native
 
 from visualization.dynamic import visualize_test
 import settings as s
+import trace_format
 
 def preprocess(filename):
     """
@@ -23,7 +25,12 @@ def preprocess(filename):
     (in the format specified for the offline dump versions):
     1) Reads the flags register (that is, conditionRegister == 'R'), and
     2) Is either taken or not taken (that is, TNnotBranch != '-').
+    Binary traces (.npbt, see trace_format.py) are memory mapped rather
+    than parsed, and their conditional branches returned as a view.
     """
+    if filename.endswith(".npbt"):
+        return trace_format.BranchTraceFile(filename).conditional()
+
     cleaned = []
     with open(filename, "r") as f:
         for line in f:
@@ -37,27 +44,62 @@ def evaluate(predictor, data):
     """
     Given a predictor, as defined in the predictor directory (either the
     static predictor, dynamic, or neural) calculates the accuracy through
-    the dump provided and outputs accuracy (as percent)
+    the dump provided and outputs accuracy (as percent); columnar
+    predictors (the native ones of predictors/native.py and the quantized
+    neural one) go through the whole dump in one call
     """
+    if getattr(predictor, "columnar", False):
+        return predictor.run(native.Columns(data))/len(data)
     correct = 0
     for inst in data:
         correct += int(inst[s.BRANCH] == predictor.predict(inst))
     return correct/len(data)
 
+def evaluate_batch(predictors, data, block=4096):
+    """
+    Accuracies of several predictors (e.g. the points of a sweep) over
+    the same dump in a single pass: the dump is walked in blocks and each
+    block is fed to every predictor in turn while it is still in cache,
+    rather than the dump being walked once per predictor. Each predictor
+    sees the branches in the same order as with evaluate.
+    """
+    correct = [0] * len(predictors)
+    columns = None
+    if any(getattr(p, "columnar", False) for p in predictors):
+        columns = native.Columns(data)
+    for first in range(0, len(data), block):
+        chunk = data[first:first + block]
+        for p, predictor in enumerate(predictors):
+            if getattr(predictor, "columnar", False):
+                correct[p] += predictor.run(columns, first, len(chunk))
+                continue
+            hits = 0
+            for inst in chunk:
+                hits += int(inst[s.BRANCH] == predictor.predict(inst))
+            correct[p] += hits
+    return [c/len(data) for c in correct]
+
 def main(filename):
     memdump = preprocess(filename)
     # part of the dump corresponding to static training "history"
     # data that is not seen live by user
-    split = np.array_split(memdump, 5)
-    traindump = split[0]
-    testdump  = np.concatenate(split[1:])
+    # (first fifth, rounded up as np.array_split does); slicing keeps
+    # this working on the views of binary traces
+    split = -(-len(memdump) // 5)
+    traindump = memdump[:split]
+    testdump  = memdump[split:]
 
+    # the C++ versions of the baselines when built (make -C native)
     tests = {
-        "static"  : StaticPredictor(),
-        "bimodal" : BimodalPredictor(n=10),
-        "gshare"  : GSharePredictor(n=10),
+        "static"  : native.select(native.NativeStatic, StaticPredictor)(),
+        "bimodal" : native.select(native.NativeBimodal,
+                                  BimodalPredictor)(n=10),
+        "gshare"  : native.select(native.NativeGShare,
+                                  GSharePredictor)(n=10),
         "neural"  : NeuralPredictor(traindump)
     }
+    if native.available():
+        tests["perceptron"] = native.NativePerceptron(n=10, history=32)
 
     for predictor in tests:
         print("{} predictor had {} accuracy".format(
@@ -0,0 +1,112 @@
+/*****************************************************************
+ * File: baselines.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Native versions of the baseline predictors of
+ * static/predictors (static, bimodal and gshare) plus a global
+ * history perceptron.
+ ****************************************************************/
+
+#include "baselines.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Baselines
+{
+
+namespace
+{
+  /**
+   * Predicts from a two-bit counter and trains it the way taken.py is
+   * used by bimodal.py and gshare.py: the counter moves towards taken
+   * whenever the prediction was right, and towards not taken whenever
+   * it was wrong, which keeps the accuracies of both versions equal.
+   */
+  inline bool
+  predictCounter(uint8_t &counter, bool taken)
+  {
+	bool prediction = counter >= 2;
+	if (prediction == taken)
+	  counter += counter < 3;
+	else
+	  counter -= counter > 0;
+	return prediction;
+  }
+
+  void
+  checkRange(unsigned value, unsigned low, unsigned high, const char *what)
+  {
+	if (value < low || value > high)
+	  throw std::invalid_argument(what);
+  }
+}
+
+BimodalPredictor::BimodalPredictor(unsigned n)
+{
+  checkRange(n, 1, 30, "bimodal predictor size must be 1 to 30 bits");
+  // every counter starts strongly not taken
+  counters.assign(size_t(1) << n, 0);
+  mask = (uint64_t(1) << n) - 1;
+}
+
+bool
+BimodalPredictor::predict(uint64_t pc, bool taken)
+{
+  return predictCounter(counters[pc & mask], taken);
+}
+
+GSharePredictor::GSharePredictor(unsigned n)
+  : history(0)
+{
+  checkRange(n, 1, 30, "gshare predictor size must be 1 to 30 bits");
+  counters.assign(size_t(1) << n, 0);
+  mask = (uint64_t(1) << n) - 1;
+}
+
+bool
+GSharePredictor::predict(uint64_t pc, bool taken)
+{
+  uint8_t &counter = counters[(pc ^ history) & mask];
+  history = ((history << 1) | taken) & mask;
+  return predictCounter(counter, taken);
+}
+
+PerceptronPredictor::PerceptronPredictor(unsigned n,
+										 unsigned history_length)
+  : historyLength(history_length), history(0)
+{
+  checkRange(n, 1, 20, "perceptron table size must be 1 to 20 bits");
+  checkRange(history_length, 1, 64,
+			 "perceptron history must be 1 to 64 bits");
+  weights.assign((size_t(1) << n) * (history_length + 1), 0);
+  mask = (uint64_t(1) << n) - 1;
+  theta = 1.93 * history_length + 14;
+}
+
+bool
+PerceptronPredictor::predict(uint64_t pc, bool taken)
+{
+  int8_t *row = &weights[(pc & mask) * (historyLength + 1)];
+
+  int y_out = row[0];
+  for (unsigned i = 0; i < historyLength; i++)
+	y_out += ((history >> i) & 1) ? row[i + 1] : -row[i + 1];
+  bool prediction = y_out >= 0;
+
+  if (prediction != taken || (y_out < 0 ? -y_out : y_out) <= theta) {
+	int step = taken ? 1 : -1;
+	row[0] = std::max(-128, std::min(127, row[0] + step));
+	for (unsigned i = 0; i < historyLength; i++) {
+	  int agree = ((history >> i) & 1) == taken ? 1 : -1;
+	  row[i + 1] = std::max(-128, std::min(127, row[i + 1] + agree));
+	}
+  }
+
+  history = (history << 1) | taken;
+  if (historyLength < 64)
+	history &= (uint64_t(1) << historyLength) - 1;
+  return prediction;
+}
+
+} // namespace Baselines
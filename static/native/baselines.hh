@@ -0,0 +1,121 @@
+/*****************************************************************
+ * File: baselines.hh
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: Native versions of the baseline predictors of
+ * static/predictors (static, bimodal and gshare) plus a global
+ * history perceptron, behind the predict-then-train interface of
+ * predictor.py: header file.
+ ****************************************************************/
+
+#ifndef __STATIC_NATIVE_BASELINES_HH__
+#define __STATIC_NATIVE_BASELINES_HH__
+
+#include <stdint.h>
+#include <vector>
+
+namespace Baselines
+{
+
+class Predictor
+{
+public:
+  virtual ~Predictor() { }
+
+  /**
+   * Predicts a branch, then trains on its outcome, as predict(inst)
+   * does for the Python predictors.
+   * @param pc Address of the branch.
+   * @param taken The resolved direction of the branch.
+   * @return The predicted direction.
+   */
+  virtual bool predict(uint64_t pc, bool taken) = 0;
+};
+
+/** Always predicts taken, as predictors/static.py. */
+class StaticPredictor : public Predictor
+{
+public:
+  bool predict(uint64_t pc, bool taken) { return true; }
+};
+
+/**
+ * 2^n two-bit counters indexed by the low n PC bits, trained the way
+ * predictors/bimodal.py trains them (see SaturatingCounters).
+ */
+class BimodalPredictor : public Predictor
+{
+public:
+  /** @param n Log2 of the number of counters, 1 to 30. */
+  BimodalPredictor(unsigned n);
+
+  bool predict(uint64_t pc, bool taken);
+
+private:
+  /** Counters, 0 (strongly not taken) to 3 (strongly taken) */
+  std::vector<uint8_t> counters;
+
+  /** Mask selecting the index bits of the PC */
+  uint64_t mask;
+};
+
+/**
+ * 2^n two-bit counters indexed by the low n PC bits xor the last n
+ * outcomes, as predictors/gshare.py.
+ */
+class GSharePredictor : public Predictor
+{
+public:
+  /** @param n Log2 of the number of counters and history bits, 1 to 30. */
+  GSharePredictor(unsigned n);
+
+  bool predict(uint64_t pc, bool taken);
+
+private:
+  /** Counters, 0 (strongly not taken) to 3 (strongly taken) */
+  std::vector<uint8_t> counters;
+
+  /** Mask selecting the index bits of the PC and history */
+  uint64_t mask;
+
+  /** Last n outcomes, the newest in bit 0 */
+  uint64_t history;
+};
+
+/**
+ * Global history perceptron of the original neural predictor paper:
+ * 2^n rows of 8-bit weights indexed by the PC, summed over the last
+ * historyLength outcomes and trained on mispredictions and on sums
+ * within the 1.93 * historyLength + 14 threshold.
+ */
+class PerceptronPredictor : public Predictor
+{
+public:
+  /**
+   * @param n Log2 of the number of perceptrons, 1 to 20.
+   * @param history_length Outcomes (and weights) per perceptron, 1 to 64.
+   */
+  PerceptronPredictor(unsigned n, unsigned history_length);
+
+  bool predict(uint64_t pc, bool taken);
+
+private:
+  /** Rows of historyLength + 1 weights, the bias first */
+  std::vector<int8_t> weights;
+
+  /** Mask selecting the row bits of the PC */
+  uint64_t mask;
+
+  /** Outcomes (and non-bias weights) per perceptron */
+  unsigned historyLength;
+
+  /** Training threshold */
+  int theta;
+
+  /** Last historyLength outcomes, the newest in bit 0 */
+  uint64_t history;
+};
+
+} // namespace Baselines
+
+#endif // __STATIC_NATIVE_BASELINES_HH__
@@ -0,0 +1,70 @@
+/*****************************************************************
+ * File: baselines_api.cc
+ * Created on: 14-Oct-2026
+ * Author: Yash Patel
+ * Description: C entry points of libbaselines.so, the interface
+ * predictors/native.py binds to through ctypes.
+ ****************************************************************/
+
+#include <stdexcept>
+#include <string.h>
+
+#include "baselines.hh"
+
+using namespace Baselines;
+
+extern "C" {
+
+/**
+ * Builds a baseline predictor.
+ * @param kind "static", "bimodal", "gshare" or "perceptron".
+ * @param n Log2 of the table size (ignored by "static").
+ * @param history_length Outcomes per perceptron ("perceptron" only).
+ * @return The predictor, or NULL if the kind or sizes are invalid.
+ */
+Predictor *
+baseline_create(const char *kind, unsigned n, unsigned history_length)
+{
+  try {
+	if (!strcmp(kind, "static"))
+	  return new StaticPredictor();
+	if (!strcmp(kind, "bimodal"))
+	  return new BimodalPredictor(n);
+	if (!strcmp(kind, "gshare"))
+	  return new GSharePredictor(n);
+	if (!strcmp(kind, "perceptron"))
+	  return new PerceptronPredictor(n, history_length);
+  } catch (const std::invalid_argument &) {
+  }
+  return NULL;
+}
+
+void
+baseline_destroy(Predictor *predictor)
+{
+  delete predictor;
+}
+
+/**
+ * Predicts and trains on a run of branches in trace order.
+ * @param pcs Address of every branch.
+ * @param taken Outcome of every branch, 0 or 1.
+ * @param count Number of branches.
+ * @param predictions Receives every prediction (0 or 1) unless NULL.
+ * @return The number of branches predicted correctly.
+ */
+uint64_t
+baseline_run(Predictor *predictor, const uint64_t *pcs,
+			 const uint8_t *taken, uint64_t count, uint8_t *predictions)
+{
+  uint64_t correct = 0;
+  for (uint64_t i = 0; i < count; i++) {
+	bool prediction = predictor->predict(pcs[i], taken[i]);
+	correct += prediction == (bool)taken[i];
+	if (predictions)
+	  predictions[i] = prediction;
+  }
+  return correct;
+}
+
+}
@@ -0,0 +1,113 @@
+"""
+__name__ = native.py
+__author__ = Yash Patel
+__description__ = Thin ctypes binding to the C++ versions of the
+baseline predictors in native/ (built with make -C native); the
+scripts use them in place of the pure Python predictors whenever
+the library is built
+"""
+
+import ctypes
+import os
+
+import settings as s
+from predictors.predictor import Predictor
+
+LIBRARY = os.path.join(os.path.dirname(os.path.dirname(
+    os.path.abspath(__file__))), "native", "libbaselines.so")
+
+def _load():
+    try:
+        lib = ctypes.CDLL(LIBRARY)
+    except OSError:
+        return None
+    lib.baseline_create.restype  = ctypes.c_void_p
+    lib.baseline_create.argtypes = [ctypes.c_char_p, ctypes.c_uint,
+                                    ctypes.c_uint]
+    lib.baseline_destroy.restype  = None
+    lib.baseline_destroy.argtypes = [ctypes.c_void_p]
+    lib.baseline_run.restype  = ctypes.c_uint64
+    lib.baseline_run.argtypes = [ctypes.c_void_p,
+        ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint8),
+        ctypes.c_uint64, ctypes.POINTER(ctypes.c_uint8)]
+    return lib
+
+_lib = _load()
+
+def available():
+    """Whether the native library is built"""
+    return _lib is not None
+
+def select(native_class, python_class):
+    """The native predictor class if the library is built, else the
+    Python one taking the same arguments"""
+    return native_class if available() else python_class
+
+class Columns:
+    """
+    PCs and outcomes of a dump in the arrays the native predictors
+    run over, converted once and shared by every predictor
+    """
+    def __init__(self, data):
+        self.count = len(data)
+        self.pcs   = (ctypes.c_uint64 * self.count)()
+        self.taken = (ctypes.c_uint8 * self.count)()
+        for i, inst in enumerate(data):
+            self.pcs[i]   = int(inst[s.PC], 16)
+            self.taken[i] = inst[s.BRANCH] == 'T'
+
+class NativePredictor(Predictor):
+    native = True
+    # evaluated through run() over Columns
+    columnar = True
+
+    def __init__(self, kind, n=0, history=0):
+        if _lib is None:
+            raise RuntimeError("native predictors are not built, "
+                               "run make -C native")
+        self.handle = _lib.baseline_create(kind.encode(), n, history)
+        if not self.handle:
+            raise ValueError("invalid {} predictor (n={}, history={})"
+                             .format(kind, n, history))
+
+    def __del__(self):
+        if getattr(self, "handle", None):
+            _lib.baseline_destroy(self.handle)
+
+    def predict(self, inst):
+        pc    = ctypes.c_uint64(int(inst[s.PC], 16))
+        taken = ctypes.c_uint8(inst[s.BRANCH] == 'T')
+        prediction = ctypes.c_uint8()
+        _lib.baseline_run(self.handle, ctypes.byref(pc),
+                          ctypes.byref(taken), 1, ctypes.byref(prediction))
+        return 'T' if prediction.value else 'N'
+
+    def run(self, columns, first=0, count=None):
+        """
+        Predicts (and trains on) count branches of columns starting at
+        first in a single native call, returning how many were right
+        """
+        if count is None:
+            count = columns.count - first
+        return _lib.baseline_run(self.handle,
+            ctypes.cast(ctypes.byref(columns.pcs, 8 * first),
+                        ctypes.POINTER(ctypes.c_uint64)),
+            ctypes.cast(ctypes.byref(columns.taken, first),
+                        ctypes.POINTER(ctypes.c_uint8)),
+            count, None)
+
+class NativeStatic(NativePredictor):
+    def __init__(self):
+        NativePredictor.__init__(self, "static")
+
+class NativeBimodal(NativePredictor):
+    def __init__(self, n):
+        NativePredictor.__init__(self, "bimodal", n)
+
+class NativeGShare(NativePredictor):
+    def __init__(self, n):
+        NativePredictor.__init__(self, "gshare", n)
+
+class NativePerceptron(NativePredictor):
+    def __init__(self, n=10, history=32):
+        NativePredictor.__init__(self, "perceptron", n, history)
@@ -4,41 +4,167 @@ __author__ = Yash Patel
 __description__ = Neural branch predictor, which was of original
 interest and to be compared to these other class benchmarks. Here
 it is only presented as a simply preceptron unit, though we expand
-into networks and reinforcement learning as well
+into networks and reinforcement learning as well. The network is
+trained with Keras on the PC bits and global history of the training
+part of the dump, then exported to int8 fixed point (as the weights
+of the C++ perceptron are) and run over whole blocks of the dump at
+a time with numpy rather than a Keras call per branch
 """
 
 import numpy as np
+from numpy.lib.stride_tricks import sliding_window_view
 from keras.models import Sequential
-from keras.layers import Dense, Activation
+from keras.layers import Dense
 
 import settings as s
 from predictors.predictor import Predictor
+from predictors import native
+
+# bits of the fixed-point multiplier rescaling the hidden layer
+REQUANT_SHIFT = 16
+
+def features(pcs, taken, first, count, pc_bits, history):
+    """
+    Inputs of the network for count branches of a dump starting at
+    first: the low pc_bits bits of the PC, then the outcomes of the
+    history branches before (oldest first, not taken before the dump),
+    as +1/-1 int8
+    @param pcs PCs of the whole dump (uint64 array)
+    @param taken Outcomes of the whole dump (uint8 array of 0/1)
+    """
+    shifts = np.arange(pc_bits, dtype=np.uint64)
+    pc = (pcs[first:first + count, None] >> shifts) & np.uint64(1)
+    inputs = [pc.astype(np.int8)]
+    if history:
+        start = max(first - history, 0)
+        window = np.concatenate([
+            np.zeros(history - (first - start), dtype=np.uint8),
+            taken[start:first + count]])
+        inputs.append(sliding_window_view(window, history)[:count]
+                      .astype(np.int8))
+    return np.hstack(inputs) * np.int8(2) - np.int8(1)
+
+def arrays(columns):
+    """The PCs and outcomes of native.Columns as numpy arrays"""
+    if not columns.count:
+        return np.zeros(0, np.uint64), np.zeros(0, np.uint8)
+    return (np.frombuffer(columns.pcs, dtype=np.uint64),
+            np.frombuffer(columns.taken, dtype=np.uint8))
+
+class QuantizedNetwork:
+    """
+    int8 fixed-point version of the trained network: int8 weights with
+    one scale per layer, int32 biases and accumulators, and the hidden
+    activations requantized to int8 through an integer multiplier and
+    shift. The output layer is only compared against 0, which is where
+    its sigmoid crosses 1/2, so its scale never matters.
+    """
+    def __init__(self, w1, b1, w2, b2, calibration):
+        """
+        @param w1, b1, w2, b2 Float weights and biases of the two Dense
+        layers, as Keras returns them
+        @param calibration Inputs (+1/-1) the range of the hidden
+        activations is measured over, e.g. the training inputs
+        """
+        scale1 = max(np.abs(w1).max(), 1e-8) / 127
+        scale2 = max(np.abs(w2).max(), 1e-8) / 127
+        hidden = np.maximum(calibration.astype(np.float32) @ w1 + b1, 0)
+        activation = max(float(hidden.max()), 1e-8) / 127
+
+        self.w1 = np.round(w1 / scale1).astype(np.int8)
+        self.b1 = np.round(b1 / scale1).astype(np.int32)
+        self.w2 = np.round(w2 / scale2).astype(np.int8)
+        self.b2 = np.round(b2 / (activation * scale2)).astype(np.int32)
+        # inputs are exact at scale 1: accumulators of the hidden layer
+        # are at scale1, its int8 outputs at activation
+        self.multiplier = int(round(scale1 / activation *
+                                    (1 << REQUANT_SHIFT)))
+
+    def save(self, path):
+        """Writes the integer weights, for use outside of Python"""
+        np.savez(path, w1=self.w1, b1=self.b1, w2=self.w2, b2=self.b2,
+                 multiplier=self.multiplier, shift=REQUANT_SHIFT)
+
+    def predict(self, inputs):
+        """Whether each row of inputs (int8 +1/-1) is predicted taken"""
+        acc = inputs.astype(np.int32) @ self.w1.astype(np.int32) + self.b1
+        hidden = (np.maximum(acc, 0).astype(np.int64) * self.multiplier +
+                  (1 << (REQUANT_SHIFT - 1))) >> REQUANT_SHIFT
+        hidden = np.minimum(hidden, 127).astype(np.int32)
+        out = hidden @ self.w2.astype(np.int32) + self.b2
+        return out[:, 0] > 0
 
 class NeuralPredictor(Predictor):
-    def __init__(self, data):
-        self.model = Sequential()
-        self.model.add(Dense(32, activation='relu', input_dim=1))
-        self.model.add(Dense(1, activation='sigmoid'))
-        self.model.compile(optimizer='rmsprop',
+    # evaluated through run() over native.Columns, as native predictors
+    columnar = True
+
+    def __init__(self, data, pc_bits=16, history=32, block=65536,
+                 epochs=10, batch_size=10):
+        """
+        Trains the network on data (branches of the dump) and exports it
+        @param pc_bits Low bits of the PC fed to the network
+        @param history Global history outcomes fed to the network
+        @param block Branches run through the network at a time
+        """
+        self.pc_bits = pc_bits
+        self.history_length = history
+        self.block = block
+        self.history = [0] * history
+
+        pcs, taken = arrays(native.Columns(data))
+        inp = features(pcs, taken, 0, len(pcs), pc_bits, history)
+        model = Sequential()
+        model.add(Dense(32, activation='relu', input_dim=inp.shape[1]))
+        model.add(Dense(1, activation='sigmoid'))
+        model.compile(optimizer='rmsprop',
                       loss='binary_crossentropy',
                       metrics=['accuracy'])
+        model.fit(inp.astype(np.float32), taken.astype(np.float32),
+                  epochs=epochs, batch_size=batch_size)
+
+        (w1, b1), (w2, b2) = [layer.get_weights() for layer in model.layers]
+        self.network = QuantizedNetwork(w1, b1, w2, b2, inp)
 
-        inp = np.array([np.array([
-            int(d[s.PC], 16)
-            #int(d[s.FALLTHROUGH], 16),
-            #int(d[s.TARGET], 16)
-            ]) for d in data])
-        out = np.array([np.array([
-            int(d[s.BRANCH] == 'T')
-        ]) for d in data])
-        self.model.fit(inp, out, epochs=10, batch_size=10)    
-        
     def predict(self, inst):
-        boxed_inst = np.array([
-            int(inst[s.PC], 16)
-            #int(inst[s.FALLTHROUGH], 16),
-            #int(inst[s.TARGET], 16)
-        ])
-        if int(self.model.predict(boxed_inst)):
-            return 'T'
-        return 'N'
+        pc = np.array([int(inst[s.PC], 16)], dtype=np.uint64)
+        history = np.array(self.history, dtype=np.uint8)
+        # the branch is placed after its history, as run() sees it
+        taken = np.concatenate([history, [0]]).astype(np.uint8)
+        pcs = np.concatenate([np.zeros(len(history), np.uint64), pc])
+        inputs = features(pcs, taken, len(history), 1, self.pc_bits,
+                          self.history_length)
+        prediction = self.network.predict(inputs)[0]
+        self._record(np.array([inst[s.BRANCH] == 'T'], dtype=np.uint8))
+        return 'T' if prediction else 'N'
+
+    def run(self, columns, first=0, count=None):
+        """
+        Predicts count branches of columns starting at first, block by
+        block, returning how many were right; the history of each branch
+        is the outcomes before it in columns
+        """
+        if count is None:
+            count = columns.count - first
+        pcs, taken = arrays(columns)
+        correct = 0
+        for start in range(first, first + count, self.block):
+            n = min(self.block, first + count - start)
+            inputs = features(pcs, taken, start, n, self.pc_bits,
+                              self.history_length)
+            predictions = self.network.predict(inputs)
+            correct += int(np.count_nonzero(
+                predictions == taken[start:start + n].astype(bool)))
+        if count:
+            self._record(taken[max(first + count - self.history_length,
+                                   0):first + count])
+        return correct
+
+    def export(self, path):
+        """Writes the quantized weights (see QuantizedNetwork.save)"""
+        self.network.save(path)
+
+    def _record(self, outcomes):
+        """Shifts outcomes (oldest first) into the history of predict"""
+        if self.history_length:
+            self.history = (self.history +
+                [int(o) for o in outcomes])[-self.history_length:]
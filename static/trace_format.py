@@ -0,0 +1,266 @@
+"""
+__name__ = trace_format.py
+__author__ = Yash Patel
+__description__ = Compact columnar binary branch trace format (.npbt)
+with a one-shot converter from the text dumps and an mmap-based reader.
+Only branch records are kept, one column per field, optionally zlib
+compressed per block; the C++ replay driver reads the same files
+(predictor/replay/trace_format.hh mirrors the layout below).
+
+Layout (all little-endian):
+    header   magic "NPBT", version, flags, block_records, branches,
+             instructions, index_offset, num_blocks (48 bytes)
+    blocks   8-byte aligned, each holding for n records the columns
+             pc u64[n], target u64[n], fallthrough u64[n],
+             inst_delta u32[n], flags u8[n], kind u8[n]
+             (zlib compressed when the header has FLAG_ZLIB)
+    index    num_blocks entries of offset u64, stored size u64,
+             records u32 (24 bytes each) at index_offset
+"""
+
+import argparse
+import mmap
+import struct
+import sys
+import zlib
+
+import settings as s
+
+MAGIC   = b"NPBT"
+VERSION = 1
+
+# header flags
+FLAG_ZLIB = 1
+
+# per-record flags
+TAKEN = 1
+
+# branch kinds, numbered as BranchKind in the C++ replay driver
+COND, DIRECT_JUMP, DIRECT_CALL, INDIRECT_JUMP, INDIRECT_CALL, RETURN = \
+    range(6)
+
+HEADER = struct.Struct("<4sIIIQQQI4x")
+INDEX_ENTRY = struct.Struct("<QQI4x")
+
+# bytes per record of an uncompressed block
+RECORD_BYTES = 8 + 8 + 8 + 4 + 1 + 1
+
+# records per block when compressing
+DEFAULT_BLOCK_RECORDS = 65536
+
+def classify(inst):
+    """
+    Returns the kind of a branch line of the text dump, from its flags,
+    macro op and micro op fields
+    """
+    if inst[s.FLAGS] == 'R':
+        return COND
+    indirect = inst[s.MICRO] == "JMP_REG"
+    if inst[s.MACRO] == "RET":
+        return RETURN
+    if inst[s.MACRO] == "CALL":
+        return INDIRECT_CALL if indirect else DIRECT_CALL
+    return INDIRECT_JUMP if indirect else DIRECT_JUMP
+
+def _pack_block(records):
+    """Lays out a list of (pc, target, fallthrough, delta, flags, kind)
+    records as the columns of one uncompressed block"""
+    n = len(records)
+    columns = list(zip(*records))
+    return b"".join([
+        struct.pack("<%dQ" % n, *columns[0]),
+        struct.pack("<%dQ" % n, *columns[1]),
+        struct.pack("<%dQ" % n, *columns[2]),
+        struct.pack("<%dI" % n, *columns[3]),
+        bytes(columns[4]),
+        bytes(columns[5])])
+
+def convert(text_filename, binary_filename, compress=False,
+            block_records=None):
+    """
+    Converts a text dump into the binary format in one pass. Without
+    compression the whole trace is a single block, so readers can map
+    each column directly; compressed traces are split in blocks of
+    block_records records. Returns the number of branches written
+    """
+    if block_records is None:
+        block_records = DEFAULT_BLOCK_RECORDS if compress else 0
+    flags = FLAG_ZLIB if compress else 0
+
+    index = []
+    branches = instructions = 0
+    with open(text_filename, "r") as src, \
+         open(binary_filename, "wb") as dst:
+        dst.write(b"\0" * HEADER.size)
+
+        def flush(records):
+            raw = _pack_block(records)
+            data = zlib.compress(raw) if compress else raw
+            index.append((dst.tell(), len(data), len(records)))
+            dst.write(data)
+            dst.write(b"\0" * (-dst.tell() % 8))
+
+        records = []
+        insts = 0
+        for line in src:
+            inst = line.split()
+            if len(inst) <= s.MICRO:
+                continue
+            # a uop number of 1 starts a new macro instruction
+            if inst[s.UOP] == '1':
+                insts += 1
+            if inst[s.BRANCH] == '-':
+                continue
+            records.append((int(inst[s.PC], 16), int(inst[s.TARGET], 16),
+                int(inst[s.FALLTHROUGH], 16), insts,
+                TAKEN if inst[s.BRANCH] == 'T' else 0, classify(inst)))
+            instructions += insts
+            insts = 0
+            if block_records and len(records) == block_records:
+                branches += len(records)
+                flush(records)
+                records = []
+        # instructions after the last branch still count towards the trace
+        instructions += insts
+        if records or not index:
+            branches += len(records)
+            flush(records)
+
+        index_offset = dst.tell()
+        for entry in index:
+            dst.write(INDEX_ENTRY.pack(*entry))
+        dst.seek(0)
+        dst.write(HEADER.pack(MAGIC, VERSION, flags, block_records,
+            branches, instructions, index_offset, len(index)))
+    return branches
+
+class Block:
+    """
+    Columns of one block as memoryviews; for uncompressed traces these
+    are views straight into the mapped file
+    """
+    def __init__(self, data, records):
+        n = records
+        view = memoryview(data)
+        self.records     = n
+        self.pc          = view[0:8*n].cast("Q")
+        self.target      = view[8*n:16*n].cast("Q")
+        self.fallthrough = view[16*n:24*n].cast("Q")
+        self.inst_delta  = view[24*n:28*n].cast("I")
+        self.flags       = view[28*n:29*n]
+        self.kind        = view[29*n:30*n]
+
+class Branch:
+    """
+    A branch record of a mapped trace, indexable with the field numbers
+    of settings.py like a split line of the text dump (only the fields
+    the format keeps)
+    """
+    __slots__ = ("block", "i")
+
+    def __init__(self, block, i):
+        self.block = block
+        self.i = i
+
+    def __getitem__(self, field):
+        b, i = self.block, self.i
+        if field == s.PC:
+            return "%x" % b.pc[i]
+        if field == s.BRANCH:
+            return 'T' if b.flags[i] & TAKEN else 'N'
+        if field == s.FLAGS:
+            return 'R' if b.kind[i] == COND else '-'
+        if field == s.TARGET:
+            return "%x" % b.target[i]
+        if field == s.FALLTHROUGH:
+            return "%x" % b.fallthrough[i]
+        raise IndexError("field %d is not stored in binary traces" % field)
+
+    @property
+    def kind(self):
+        return self.block.kind[self.i]
+
+    @property
+    def taken(self):
+        return bool(self.block.flags[self.i] & TAKEN)
+
+class BranchView:
+    """
+    Sequence of branch records of a trace, sliceable like the arrays
+    returned by branch.preprocess
+    """
+    def __init__(self, records):
+        self.records = records
+
+    def __len__(self):
+        return len(self.records)
+
+    def __iter__(self):
+        return iter(self.records)
+
+    def __getitem__(self, key):
+        if isinstance(key, slice):
+            return BranchView(self.records[key])
+        return self.records[key]
+
+class BranchTraceFile:
+    """Memory-mapped binary trace"""
+    def __init__(self, filename):
+        self.file = open(filename, "rb")
+        self.map  = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+        (magic, version, self.flags, self.block_records, self.branches,
+         self.instructions, index_offset, num_blocks) = \
+            HEADER.unpack_from(self.map, 0)
+        if magic != MAGIC or version != VERSION:
+            raise ValueError("%s is not a version %d branch trace" %
+                (filename, VERSION))
+        self.index = [INDEX_ENTRY.unpack_from(self.map,
+            index_offset + b * INDEX_ENTRY.size) for b in range(num_blocks)]
+
+    def close(self):
+        self.map.close()
+        self.file.close()
+
+    def __len__(self):
+        return self.branches
+
+    def block(self, b):
+        """Columns of block b, decompressed if needed"""
+        offset, size, records = self.index[b]
+        if self.flags & FLAG_ZLIB:
+            data = zlib.decompress(self.map[offset:offset + size])
+        else:
+            data = memoryview(self.map)[offset:offset + size]
+        return Block(data, records)
+
+    def blocks(self):
+        for b in range(len(self.index)):
+            yield self.block(b)
+
+    def __iter__(self):
+        for block in self.blocks():
+            for i in range(block.records):
+                yield Branch(block, i)
+
+    def conditional(self):
+        """The conditional branches, as branch.preprocess selects them"""
+        return BranchView([branch for branch in self
+                           if branch.kind == COND])
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Convert a text branch dump to the binary format")
+    parser.add_argument("input", help="text trace, e.g. data/gcc-1K.trace")
+    parser.add_argument("output", help="binary trace to write (.npbt)")
+    parser.add_argument("--compress", action="store_true",
+        help="zlib compress the trace in blocks")
+    parser.add_argument("--block-records", type=int, default=None,
+        help="records per block (default: one block uncompressed, "
+             "%d compressed)" % DEFAULT_BLOCK_RECORDS)
+    args = parser.parse_args()
+    branches = convert(args.input, args.output, args.compress,
+        args.block_records)
+    print("{} branches written to {}".format(branches, args.output))
+
+if __name__ == "__main__":
+    main()
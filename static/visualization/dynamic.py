@@ -11,13 +11,20 @@ from plotly.offline import plot
 
 from predictors.bimodal import BimodalPredictor
 from predictors.gshare  import GSharePredictor
+from predictors import native
 import visualization.settings as s
 
 def visualize_test(data):
-    from branch import evaluate
+    from branch import evaluate_batch
     ns = list(range(1, s.MAX_N))
-    accuracies_bimodal = [evaluate(BimodalPredictor(n=n), data) for n in ns]
-    accuracies_gshare  = [evaluate(GSharePredictor(n=n), data) for n in ns]
+    # every size of both predictors is evaluated in one pass over the
+    # dump, natively when the C++ baselines are built
+    bimodal = native.select(native.NativeBimodal, BimodalPredictor)
+    gshare  = native.select(native.NativeGShare, GSharePredictor)
+    accuracies = evaluate_batch(
+        [bimodal(n=n) for n in ns] + [gshare(n=n) for n in ns], data)
+    accuracies_bimodal = accuracies[:len(ns)]
+    accuracies_gshare  = accuracies[len(ns):]
     plot([
             Scatter(x=ns, y=accuracies_bimodal),
             Scatter(x=ns, y=accuracies_gshare)